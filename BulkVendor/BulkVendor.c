@@ -4,48 +4,315 @@
 #include "LufaUtil.h"
 #include "BulkVendor.h"
 #include "global.h"
-#ifdef MY_DEBUG
-#include "uart.h"
-#include "rprintf.h"
+
+#if defined(VENDOR_FRAMED_ECHO) && defined(INTERRUPT_DATA_ENDPOINT)
+	#error VENDOR_FRAMED_ECHO echoes from the main loop and cannot be used with INTERRUPT_DATA_ENDPOINT
 #endif
 
 USB_EPInfo_Device_t BulkVendor_EPs=
 {
 	.DataINEPAddress = VENDOR_IN_EPADDR,
-	.DataOUTEPAddress = VENDOR_OUT_EPADDR
+	.DataOUTEPAddress = VENDOR_OUT_EPADDR,
+	.DataEPSize = VENDOR_IO_EPSIZE
 };
 
-// Main program entry point. This routine configures the hardware required by
-// the application, then enters a loop to run the application tasks in sequnece.
+#ifdef INTERRUPT_DATA_ENDPOINT
+// Ring buffers between the USB endpoint interrupt, which services the data
+// endpoints, and the main loop. The length rings hold the length of each
+// packet in the data rings, so that the echo keeps the packet boundaries.
+static RingBuffer_t VendorRxBuffer;
+static uint8_t VendorRxBufferData[VENDOR_RING_SIZE];
+static RingBuffer_t VendorRxLengths;
+static uint8_t VendorRxLengthsData[VENDOR_RING_PACKETS];
+static RingBuffer_t VendorTxBuffer;
+static uint8_t VendorTxBufferData[VENDOR_RING_SIZE];
+static RingBuffer_t VendorTxLengths;
+static uint8_t VendorTxLengthsData[VENDOR_RING_PACKETS];
+#endif
 
-static FILE USBBulkStream;
+// Data path state changed by the vendor control requests.
+static volatile uint8_t VendorMode = VENDOR_MODE_Echo;
+static volatile bool VendorFlushPending;
 
-int main(void)
+// Next byte sent in VENDOR_MODE_Source, the IN data is a running 8-bit count.
+static uint8_t VendorSourceByte;
+
+#ifdef INTERRUPT_DATA_ENDPOINT
+// Initializes the data and length rings, empty.
+static void Vendor_InitRings(void)
+{
+	RingBuffer_InitBuffer(&VendorRxBuffer, VendorRxBufferData, sizeof(VendorRxBufferData));
+	RingBuffer_InitBuffer(&VendorRxLengths, VendorRxLengthsData, sizeof(VendorRxLengthsData));
+	RingBuffer_InitBuffer(&VendorTxBuffer, VendorTxBufferData, sizeof(VendorTxBufferData));
+	RingBuffer_InitBuffer(&VendorTxLengths, VendorTxLengthsData, sizeof(VendorTxLengthsData));
+}
+
+// True if a packet of Length bytes fits into the transmit ring.
+static bool Vendor_TxHasRoom(const uint8_t Length)
 {
-	#ifdef MY_DEBUG
-	uartInit();
-	uartSetBaudRate(9600);
-	rprintfInit(uartSendByte);
-	rprintf("test start....\n");
+	return (RingBuffer_GetFreeCount(&VendorTxBuffer) >= Length) && !RingBuffer_IsFull(&VendorTxLengths);
+}
+
+// Moves every received OUT packet into the receive ring and every packet of
+// the transmit ring into an IN packet of the same length while banks are
+// available, then arms the interrupts of what is left (EndpointInterrupt.h):
+// RXOUTE unless a packet waits for room in the receive ring, TXINE while the
+// transmit ring waits for a free bank. Runs from the endpoint interrupt, and
+// from the main loop with the interrupts disabled after it changed a ring.
+static void Vendor_ServiceEndpoints(void)
+{
+	Endpoint_SelectEndpoint(VENDOR_OUT_EPADDR);
+	while (Endpoint_IsOUTReceived() && !RingBuffer_IsFull(&VendorRxLengths) &&
+		   (RingBuffer_GetFreeCount(&VendorRxBuffer) >= Endpoint_BytesInEndpoint()))
+	{
+		uint8_t Length = Endpoint_BytesInEndpoint();
+
+		PERF_COUNT(OUTPackets);
+		PERF_ADD(OUTBytes, Length);
+
+		for (uint8_t i = Length; i > 0; i--)
+			RingBuffer_Insert(&VendorRxBuffer, Endpoint_Read_8());
+		RingBuffer_Insert(&VendorRxLengths, Length);
+		Endpoint_ClearOUT();
+	}
+
+	if (Endpoint_IsOUTReceived())
+		UEIENX &= ~(1 << RXOUTE);
+	else
+		UEIENX |= (1 << RXOUTE);
+
+	Endpoint_SelectEndpoint(VENDOR_IN_EPADDR);
+	while (Endpoint_IsINReady() && !RingBuffer_IsEmpty(&VendorTxLengths))
+	{
+		uint8_t Count = RingBuffer_Remove(&VendorTxLengths);
+
+		PERF_COUNT(INPackets);
+		CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+		PERF_ADD(INBytes, Count);
+
+		while (Count--)
+			Endpoint_Write_8(RingBuffer_Remove(&VendorTxBuffer));
+		Endpoint_ClearIN();
+	}
+
+	if (RingBuffer_IsEmpty(&VendorTxLengths))
+		UEIENX &= ~(1 << TXINE);
+	else
+		UEIENX |= (1 << TXINE);
+}
+
+// Vendor_ServiceEndpoints for the main loop.
+static void Vendor_KickEndpoints(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+	Vendor_ServiceEndpoints();
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+#else
+static void Vendor_FillSource(uint8_t* const Buffer, const uint16_t Length)
+{
+	for (uint16_t i = 0; i < Length; i++)
+		Buffer[i] = VendorSourceByte++;
+}
+#endif
+
+// Discards everything received and not yet sent. Runs from the main loop, which
+// owns the data path, with interrupts disabled so that the endpoint interrupt
+// of the interrupt driven build sees the endpoints and rings either before or
+// after the flush.
+static void Vendor_Flush(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	Endpoint_ResetEndpoint(VENDOR_OUT_EPADDR);
+	Endpoint_ResetEndpoint(VENDOR_IN_EPADDR);
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	Vendor_InitRings();
+	Vendor_KickEndpoints();
 	#endif
+	VendorFlushPending = false;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+// Idle check of the main loop, run by PowerSave_IdleTask with the interrupts
+// disabled: true if the next pass has data to move. Otherwise arms the
+// interrupts of the endpoints the data path waits on.
+static bool Vendor_IsWorkPending(void)
+{
+	if (VendorFlushPending)
+		return true;
+
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	// The endpoint interrupt moves the packets and ends the sleep.
+	if (VendorMode == VENDOR_MODE_Source)
+		return Vendor_TxHasRoom(VENDOR_IO_EPSIZE);
+
+	return (!RingBuffer_IsEmpty(&VendorRxLengths) &&
+			((VendorMode != VENDOR_MODE_Echo) || Vendor_TxHasRoom(RingBuffer_Peek(&VendorRxLengths))));
+	#else
+	// The ping-pong echo reads a packet only once an IN bank is free for its
+	// echo, the other data paths read every packet at once.
+	#if (VENDOR_EP_BANKS > 1) && !defined(VENDOR_FRAMED_ECHO)
+	const bool ReadWaitsForIN = (VendorMode == VENDOR_MODE_Echo);
+	#else
+	const bool ReadWaitsForIN = false;
+	#endif
+
+	bool INReady = Device_IsINReady(&BulkVendor_EPs);
+	Endpoint_SelectEndpoint(VENDOR_OUT_EPADDR);
+	bool OUTReceived = Endpoint_IsOUTReceived();
+
+	if ((OUTReceived && (INReady || !ReadWaitsForIN)) ||
+		((VendorMode == VENDOR_MODE_Source) && INReady))
+	{
+		return true;
+	}
+
+	if (OUTReceived || (VendorMode == VENDOR_MODE_Source))
+		PowerSave_WakeOnEndpoint(VENDOR_IN_EPADDR);
+	if (!OUTReceived)
+		PowerSave_WakeOnEndpoint(VENDOR_OUT_EPADDR);
+
+	return false;
+	#endif
+}
+
+static void Vendor_GetMode(void);
+static void Vendor_SetMode(void);
+static void Vendor_RequestFlush(void);
+static void Vendor_GetMSOSDescriptor(void);
+
+// Vendor request dispatch table, searched by EVENT_USB_Device_ControlRequest.
+typedef struct
+{
+	uint8_t bmRequestType;
+	uint8_t bRequest;
+	void (*Handler)(void);
+} Vendor_Command_t;
+
+static const Vendor_Command_t VendorCommands[] PROGMEM =
+{
+	{REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE, VENDOR_REQ_GetMode, Vendor_GetMode},
+	{REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE, VENDOR_REQ_SetMode, Vendor_SetMode},
+	{REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE, VENDOR_REQ_GetStatistics, PerfCounters_GetCounters},
+	{REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE, VENDOR_REQ_ResetStatistics, PerfCounters_ResetCounters},
+	{REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE, VENDOR_REQ_Flush, Vendor_RequestFlush},
+	{REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE, VENDOR_REQ_GetMSOSDescriptor, Vendor_GetMSOSDescriptor},
+	#ifdef CYCLE_PROBES
+	{REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE, CYCLE_REQ_GetProbe, CycleProbe_GetProbe},
+	{REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE, CYCLE_REQ_ResetProbes, CycleProbe_ResetProbes},
+	#endif
+};
+
+// Main program entry point. This routine configures the hardware required by
+// the application, then enters a loop to run the application tasks in sequnece.
+int main(void)
+{
+	EventLog_Init();
+	LOG_INFO(USB, Start, MCUSR, 0);
 
 	SetupHardware();
 
-	Device_CreateStream(&BulkVendor_EPs, &USBBulkStream);
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	Vendor_InitRings();
+	#endif
 
 	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
 	GlobalInterruptEnable();
 
-	#ifdef MY_DEBUG
-	rprintf("loop start...\n");
-	#endif
+	LOG_INFO(USB, LoopStart, 0, 0);
 	for (;;)
 	{
+		PERF_COUNT(MainLoopPasses);
+		PowerSave_Task(false);
+
+		#ifdef INTERRUPT_DATA_ENDPOINT
+		if (VendorFlushPending)
+			Vendor_Flush();
+
+		// Control requests and the data endpoints are handled from the USB
+		// endpoint interrupt, only move the received packets to the transmit
+		// ring here. A packet's length is added to the transmit ring after
+		// its bytes, the endpoint interrupt never sees a partial packet.
+		uint16_t Moved = 0;
+		uint8_t Packets = 0;
+		while (!RingBuffer_IsEmpty(&VendorRxLengths))
+		{
+			uint8_t Length = RingBuffer_Peek(&VendorRxLengths);
+			if ((VendorMode == VENDOR_MODE_Echo) && !Vendor_TxHasRoom(Length))
+				break;
+
+			for (uint8_t i = Length; i > 0; i--)
+			{
+				uint8_t ReceivedByte = RingBuffer_Remove(&VendorRxBuffer);
+				if (VendorMode == VENDOR_MODE_Echo)
+					RingBuffer_Insert(&VendorTxBuffer, ReceivedByte);
+			}
+			RingBuffer_Remove(&VendorRxLengths);
+			if (VendorMode == VENDOR_MODE_Echo)
+				RingBuffer_Insert(&VendorTxLengths, Length);
+
+			Moved += Length;
+			Packets++;
+		}
+		if (Packets)
+			LOG_DEBUG(DATA, EchoBytes, Moved, Packets);
+
+		if (VendorMode == VENDOR_MODE_Source)
+		{
+			while (Vendor_TxHasRoom(VENDOR_IO_EPSIZE))
+			{
+				for (uint8_t i = 0; i < VENDOR_IO_EPSIZE; i++)
+					RingBuffer_Insert(&VendorTxBuffer, VendorSourceByte++);
+				RingBuffer_Insert(&VendorTxLengths, VENDOR_IO_EPSIZE);
+				Packets++;
+			}
+		}
+
+		// The interrupts only fire for a new packet or a bank the host took:
+		// send the new packets and take the packet the receive ring had no
+		// room for now.
+		if (Packets)
+			Vendor_KickEndpoints();
+		#elif defined(VENDOR_FRAMED_ECHO)
 		USB_USBTask();
 
-		int count = 0;
+		if (VendorFlushPending)
+			Vendor_Flush();
+
+		// Echo whole messages, the echo of a message that is a multiple of
+		// VENDOR_IO_EPSIZE long is ended with a zero length packet.
+		static uint8_t Message[VENDOR_MESSAGE_SIZE];
+		uint16_t MessageLength;
+		uint8_t ErrorCode = Device_Read_Message(&BulkVendor_EPs, Message, sizeof(Message), &MessageLength);
+
+		if ((ErrorCode == DEVICE_MESSAGE_NoError) || (ErrorCode == DEVICE_MESSAGE_Truncated))
+		{
+			LOG_DEBUG(DATA, EchoMessage, MessageLength, (ErrorCode == DEVICE_MESSAGE_Truncated));
+			if (VendorMode == VENDOR_MODE_Echo)
+				Device_Write_Message(&BulkVendor_EPs, Message, MessageLength);
+		}
+
+		if ((VendorMode == VENDOR_MODE_Source) && Device_IsINReady(&BulkVendor_EPs))
+		{
+			Vendor_FillSource(Message, sizeof(Message));
+			Device_Write_Message(&BulkVendor_EPs, Message, sizeof(Message));
+		}
+		#else
+		USB_USBTask();
+
+		if (VendorFlushPending)
+			Vendor_Flush();
+
+		uint16_t count = 0;
 		uint8_t ReceivedData[VENDOR_IO_EPSIZE];
-		memset(ReceivedData, 0x00, sizeof(ReceivedData));
 
 		#if 0
 		Endpoint_SelectEndpoint(VENDOR_OUT_EPADDR);
@@ -54,25 +321,41 @@ int main(void)
 			Endpoint_Read_Stream_LE(ReceivedData, VENDOR_IO_EPSIZE, NULL);
 			Endpoint_ClearOUT();
 
-			#ifdef MY_DEBUG
-			rprintfStr((char*)ReceivedData); rprintfCRLF();
-			#endif
-
 			Endpoint_SelectEndpoint(VENDOR_IN_EPADDR);
 			Endpoint_Write_Stream_LE(ReceivedData, VENDOR_IO_EPSIZE, NULL);
 			Endpoint_ClearIN();
 		}
 		#endif
-		if ((count = fread(&ReceivedData, 1, VENDOR_IO_EPSIZE, &USBBulkStream)) > 0) {
-			#ifdef MY_DEBUG
-			for(uint8_t i=0; i<count; i++)
-				rprintfChar(ReceivedData[i]);
-			rprintfCRLF();
-			#endif
-			fwrite(&ReceivedData, 1, count, &USBBulkStream);
-			Endpoint_ClearIN();
+		// Move a whole packet per call, the endpoint is selected and the device
+		// state is checked once per packet instead of once per byte as with
+		// the fread/fwrite stream.
+		#if (VENDOR_EP_BANKS > 1)
+		// Ping-pong: echo up to one packet per bank as long as a filled OUT bank
+		// and a free IN bank are available. Device_Read_Block releases the OUT
+		// bank before the IN bank is written, so the controller receives the
+		// next packet and sends the previous one while this one is copied.
+		for (uint8_t bank = 0; bank < VENDOR_EP_BANKS &&
+			 ((VendorMode != VENDOR_MODE_Echo) || Device_IsINReady(&BulkVendor_EPs)) &&
+			 (count = Device_Read_Block(&BulkVendor_EPs, ReceivedData, VENDOR_IO_EPSIZE)) > 0; bank++)
+		#else
+		if ((count = Device_Read_Block(&BulkVendor_EPs, ReceivedData, VENDOR_IO_EPSIZE)) > 0)
+		#endif
+		{
+			LOG_DEBUG(DATA, EchoPacket, count, ReceivedData[0]);
+			if (VendorMode == VENDOR_MODE_Echo)
+				Device_Write_Block(&BulkVendor_EPs, ReceivedData, count);
 		}
 
+		// Source: fill every free IN bank with a full packet.
+		for (uint8_t bank = 0; bank < VENDOR_EP_BANKS && (VendorMode == VENDOR_MODE_Source) &&
+			 Device_IsINReady(&BulkVendor_EPs); bank++)
+		{
+			Vendor_FillSource(ReceivedData, VENDOR_IO_EPSIZE);
+			Device_Write_Block(&BulkVendor_EPs, ReceivedData, VENDOR_IO_EPSIZE);
+		}
+		#endif
+
+		PowerSave_IdleTask(Vendor_IsWorkPending);
 	}
 }
 
@@ -88,22 +371,17 @@ void SetupHardware(void)
 
 	// Hardware Initialization
 	LEDs_Init();
-	#ifdef MY_DEBUG
-	rprintf("before USB_Init...\n");
-	#endif
+	CycleProbe_Init();
+	SerialNumber_Init();
 	USB_Init();
-	#ifdef MY_DEBUG
-	rprintf("after USB_Init...\n");
-	#endif
+	LOG_INFO(USB, USBInit, 0, 0);
 }
 
 // Event handler for the USB_Connect event. This indicates that the device is
 // enuerating via the status LEDs.
 void EVENT_USB_Device_Connect(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB connect...\n");
-	#endif
+	LOG_INFO(USB, Connect, 0, 0);
 	// Indicate USB enumerating
 	LEDs_SetAllLEDs(LEDMASK_USB_ENUMERATING);
 }
@@ -112,26 +390,44 @@ void EVENT_USB_Device_Connect(void)
 // no longer connected to a host via the status LEDs.
 void EVENT_USB_Device_Disconnect(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB disconnect...\n");
-	#endif
+	LOG_INFO(USB, Disconnect, 0, 0);
 	// Indicate USB not ready
 	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
 }
 
+// Event handler for the USB_Suspend event. The host suspended the bus, the
+// main loop sleeps until it resumes.
+void EVENT_USB_Device_Suspend(void)
+{
+	PowerSave_Suspend();
+}
+
+// Event handler for the USB_WakeUp event. The bus resumed, the library turned
+// the USB clock and the PLL back on.
+void EVENT_USB_Device_WakeUp(void)
+{
+	PowerSave_WakeUp();
+}
+
 // Event handler for the USB_ConfigurationChanged event. This is fired when
 // the host set the current configuration of the USB device after enumeration
 // - the device endpoints are configured.
 void EVENT_USB_Device_ConfigurationChanged(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB configuration...\n");
-	#endif
 	bool ConfigSuccess = true;
 
 	// Setup Vendor Data Endpoints
-	ConfigSuccess &= Endpoint_ConfigureEndpoint(VENDOR_IN_EPADDR, EP_TYPE_BULK, VENDOR_IO_EPSIZE, 1);
-	ConfigSuccess &= Endpoint_ConfigureEndpoint(VENDOR_OUT_EPADDR, EP_TYPE_BULK, VENDOR_IO_EPSIZE, 1);
+	ConfigSuccess &= Endpoint_ConfigureEndpoint(VENDOR_IN_EPADDR, EP_TYPE_BULK, VENDOR_IO_EPSIZE, VENDOR_EP_BANKS);
+	ConfigSuccess &= Endpoint_ConfigureEndpoint(VENDOR_OUT_EPADDR, EP_TYPE_BULK, VENDOR_IO_EPSIZE, VENDOR_EP_BANKS);
+
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	Vendor_KickEndpoints();
+	#endif
+
+	// Every configuration starts out echoing.
+	VendorMode = VENDOR_MODE_Echo;
+
+	LOG_INFO(USB, ConfigurationChanged, ConfigSuccess, 0);
 
 	// Indicate endpoint configuration success or failure
 	LEDs_SetAllLEDs(ConfigSuccess ? LEDMASK_USB_READY : LEDMASK_USB_ERROR);
@@ -142,9 +438,78 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 // along unhandled control requests to the library for processing internally.
 void EVENT_USB_Device_ControlRequest(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB control request...0x%x, 0x%x\n", USB_ControlRequest.bRequest,
-	USB_ControlRequest.bmRequestType);
-	#endif
-	// Process vendor specific control requests here
+	LOG_DEBUG(USB, ControlRequest, USB_ControlRequest.bRequest, USB_ControlRequest.bmRequestType);
+	SerialNumber_ProcessControlRequest(STRING_ID_Serial);
+
+	for (uint8_t i = 0; i < (sizeof(VendorCommands) / sizeof(VendorCommands[0])); i++)
+	{
+		if ((pgm_read_byte(&VendorCommands[i].bmRequestType) == USB_ControlRequest.bmRequestType) &&
+			(pgm_read_byte(&VendorCommands[i].bRequest) == USB_ControlRequest.bRequest))
+		{
+			void (*Handler)(void) = (void (*)(void))pgm_read_ptr(&VendorCommands[i].Handler);
+			Handler();
+			return;
+		}
+	}
+}
+
+// Vendor request handlers, called with the request in USB_ControlRequest. A
+// handler rejects a request by returning without clearing the SETUP packet,
+// the library then stalls it.
+static void Vendor_GetMode(void)
+{
+	uint8_t Mode = VendorMode;
+
+	Endpoint_ClearSETUP();
+	Endpoint_Write_Control_Stream_LE(&Mode, sizeof(Mode));
+	Endpoint_ClearOUT();
+}
+
+static void Vendor_SetMode(void)
+{
+	if (USB_ControlRequest.wValue > VENDOR_MODE_Source)
+		return;
+
+	Endpoint_ClearSETUP();
+	Endpoint_ClearStatusStage();
+
+	VendorMode = USB_ControlRequest.wValue;
+	LOG_INFO(USB, VendorMode, USB_ControlRequest.wValue, 0);
 }
+
+static void Vendor_RequestFlush(void)
+{
+	Endpoint_ClearSETUP();
+	Endpoint_ClearStatusStage();
+
+	// The control request may interrupt the data path, leave the flush to the
+	// main loop.
+	VendorFlushPending = true;
+}
+
+// Sends the MS OS 2.0 descriptor set from flash, the only descriptor of the
+// request; Windows asks for it after reading the BOS descriptor.
+static void Vendor_GetMSOSDescriptor(void)
+{
+	if (USB_ControlRequest.wIndex != MS_OS_20_DESCRIPTOR_INDEX)
+		return;
+
+	Endpoint_ClearSETUP();
+	Endpoint_Write_Control_PStream_LE(&MSOS20DescriptorSet, sizeof(MSOS20DescriptorSet));
+	Endpoint_ClearOUT();
+}
+
+#ifdef INTERRUPT_DATA_ENDPOINT
+// Event handler for the USB_Reset event. The bus reset disarmed the endpoint
+// interrupts, the control requests are handled from it again.
+void EVENT_USB_Device_Reset(void)
+{
+	EndpointInterrupt_Reset();
+}
+
+// Event handler of the USB endpoint interrupt (EndpointInterrupt.h).
+void EVENT_EndpointInterrupt_Data(void)
+{
+	Vendor_ServiceEndpoints();
+}
+#endif
@@ -6,12 +6,20 @@
 #include <avr/wdt.h>
 #include <avr/power.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 
 #include "Descriptors.h"
+#include "PerfCounters.h"
+#include "PowerSave.h"
+#include "SerialNumber.h"
+#include "CycleProbe.h"
+#include "EventLog.h"
+#include "EndpointInterrupt.h"
 
 #include <LUFA/Drivers/USB/USB.h>
 #include <LUFA/Drivers/Board/LEDs.h>
 #include <LUFA/Platform/Platform.h>
+#include <LUFA/Drivers/Misc/RingBuffer.h>
 
 // Macros:
 // LED mask for the library LED driver, to indicate that the USB interface is not ready
@@ -29,12 +37,51 @@
 // LED mask for the library LED driver, to indicate that the USB interface is busy.
 #define LEDMASK_USB_BUSY	LEDS_LED2
 
+// Size in bytes of each of the receive and transmit rings used when the data
+// endpoints are serviced from the USB endpoint interrupt.
+#define VENDOR_RING_SIZE	128
+
+// Number of packets each of those rings holds, zero length packets included.
+#define VENDOR_RING_PACKETS	8
+
+// Largest message echoed by the VENDOR_FRAMED_ECHO build, longer messages are
+// truncated.
+#ifndef VENDOR_MESSAGE_SIZE
+	#define VENDOR_MESSAGE_SIZE	512
+#endif
+
+// Type Defines:
+// Vendor specific control requests (REQTYPE_VENDOR | REQREC_DEVICE) on the
+// control endpoint. They keep the out-of-band operations out of the bulk data
+// stream, which carries nothing but payload.
+enum Vendor_Requests_t
+{
+	VENDOR_REQ_GetMode = 0x01, // Device to host, 1 byte: the current Vendor_Modes_t
+	VENDOR_REQ_SetMode = 0x02, // Host to device, wValue: the new Vendor_Modes_t
+	VENDOR_REQ_GetStatistics = PERF_REQ_GetCounters, // Device to host: PerfCounters_t
+	VENDOR_REQ_ResetStatistics = PERF_REQ_ResetCounters, // Host to device
+	VENDOR_REQ_Flush = 0x05, // Host to device: discard received and unsent data
+	// CYCLE_REQ_GetProbe and CYCLE_REQ_ResetProbes (0x06, 0x07) in the CYCLE_PROBES build
+	VENDOR_REQ_GetMSOSDescriptor = MS_OS_20_VENDOR_CODE, // Device to host, wIndex MS_OS_20_DESCRIPTOR_INDEX: the MS OS 2.0 descriptor set
+};
+
+// What the firmware does with the bulk data endpoints.
+enum Vendor_Modes_t
+{
+	VENDOR_MODE_Echo = 0, // Send back everything received, the default
+	VENDOR_MODE_Sink = 1, // Discard everything received
+	VENDOR_MODE_Source = 2, // Discard everything received and keep the IN endpoint full
+};
+
 // Function Prototypes:
 void SetupHardware(void);
 
 void EVENT_USB_Device_Connect(void);
 void EVENT_USB_Device_Disconnect(void);
+void EVENT_USB_Device_Suspend(void);
+void EVENT_USB_Device_WakeUp(void);
 void EVENT_USB_Device_ConfigurationChanged(void);
 void EVENT_USB_Device_ControlRequest(void);
+void EVENT_USB_Device_Reset(void);
 
 #endif
@@ -4,16 +4,18 @@
 
 #include "Descriptors.h"
 #include "global.h"
-#include "rprintf.h"
+#include "DescriptorTable.h"
 
 // Device descriptor structure. This descriptor, located in FLASH memory,
 // describes the overall device characteristics, including the supported USB
 // version, control endpoint size and the number of device configurations.
 // The descriptor is read out by the USB host when the enumeration process begins.
+// USB 2.01 tells the host that the device has a BOS descriptor; the device
+// still runs at full speed.
 const USB_Descriptor_Device_t PROGMEM DeviceDescriptor =
 {
 	.Header				= {.Size = sizeof(USB_Descriptor_Device_t), .Type =DTYPE_Device},
-	.USBSpecification	= VERSION_BCD(1,1,0),
+	.USBSpecification	= VERSION_BCD(2,0,1),
 	.Class				= USB_CSCP_NoDeviceClass,
 	.SubClass			= USB_CSCP_NoDeviceSubclass,
 	.Protocol			= USB_CSCP_NoDeviceProtocol,
@@ -26,7 +28,7 @@ const USB_Descriptor_Device_t PROGMEM DeviceDescriptor =
 
 	.ManufacturerStrIndex = STRING_ID_Manufacturer,
 	.ProductStrIndex	= STRING_ID_Product,
-	.SerialNumStrIndex	= USE_INTERNAL_SERIAL,
+	.SerialNumStrIndex	= STRING_ID_Serial,
 
 	.NumberOfConfigurations = FIXED_NUM_CONFIGURATIONS
 };
@@ -90,6 +92,69 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 		}
 };
 
+// BOS descriptor structure, located in FLASH memory. Its only capability is
+// the Microsoft OS 2.0 platform capability, which gives Windows the vendor
+// request code and the length of the MS OS 2.0 descriptor set.
+const USB_Descriptor_BOS_t PROGMEM BOSDescriptor =
+{
+	.BOS =
+		{
+			.Header = {.Size = sizeof(BOSDescriptor.BOS), .Type = DTYPE_BOS},
+
+			.TotalLength = sizeof(USB_Descriptor_BOS_t),
+			.NumDeviceCaps = 1
+		},
+
+	.MSOS20Platform =
+		{
+			.Header = {.Size = sizeof(BOSDescriptor.MSOS20Platform), .Type = DTYPE_DeviceCapability},
+
+			.DevCapabilityType = DCTYPE_Platform,
+			.Reserved = 0,
+			// {D8DD60DF-4589-4CC7-9CD2-659D9E648A9F}, little endian fields first
+			.PlatformCapabilityUUID = {0xDF, 0x60, 0xDD, 0xD8, 0x89, 0x45, 0xC7, 0x4C,
+									   0x9C, 0xD2, 0x65, 0x9D, 0x9E, 0x64, 0x8A, 0x9F},
+			.WindowsVersion = MS_OS_20_WINDOWS_VERSION,
+			.DescriptorSetTotalLength = sizeof(USB_MSOS20_DescriptorSet_t),
+			.VendorCode = MS_OS_20_VENDOR_CODE,
+			.AltEnumCode = 0
+		}
+};
+
+// Microsoft OS 2.0 descriptor set, located in FLASH memory and returned by the
+// MS_OS_20_VENDOR_CODE vendor request. The device as a whole is WinUSB
+// compatible and its interface GUID is MS_OS_20_DEVICE_INTERFACE_GUID.
+const USB_MSOS20_DescriptorSet_t PROGMEM MSOS20DescriptorSet =
+{
+	.Header =
+		{
+			.Length = sizeof(MSOS20DescriptorSet.Header),
+			.DescriptorType = MS_OS_20_SET_HEADER_DESCRIPTOR,
+			.WindowsVersion = MS_OS_20_WINDOWS_VERSION,
+			.TotalLength = sizeof(USB_MSOS20_DescriptorSet_t)
+		},
+
+	.CompatibleID =
+		{
+			.Length = sizeof(MSOS20DescriptorSet.CompatibleID),
+			.DescriptorType = MS_OS_20_FEATURE_COMPATIBLE_ID,
+			.CompatibleID = "WINUSB",
+			.SubCompatibleID = ""
+		},
+
+	.DeviceInterfaceGUIDs =
+		{
+			.Length = sizeof(MSOS20DescriptorSet.DeviceInterfaceGUIDs),
+			.DescriptorType = MS_OS_20_FEATURE_REG_PROPERTY,
+			.PropertyDataType = MS_OS_20_REG_MULTI_SZ,
+			.PropertyNameLength = sizeof(MSOS20DescriptorSet.DeviceInterfaceGUIDs.PropertyName),
+			.PropertyName = L"DeviceInterfaceGUIDs",
+			.PropertyDataLength = sizeof(MSOS20DescriptorSet.DeviceInterfaceGUIDs.PropertyData),
+			// REG_MULTI_SZ: the GUID string, then an empty string ending the list
+			.PropertyData = MS_OS_20_DEVICE_INTERFACE_GUID L"\0"
+		}
+};
+
 // Language descriptor structure. This descriptor, located in FLASH memory, 
 // is returned when the host requests the string descriptor with index 0
 // (the first index). It is actually an array of 16-bit integers, which indicate
@@ -108,6 +173,26 @@ const USB_Descriptor_String_t PROGMEM ManufacturerString = USB_STRING_DESCRIPTOR
 // when the appropriate string ID is requested, listed in the Device Descriptor.
 const USB_Descriptor_String_t PROGMEM ProductString = USB_STRING_DESCRIPTOR(L"LUFA Bulk Vendor Demo");
 
+// Descriptor table searched by CALLBACK_USB_GetDescriptor (DescriptorTable.h),
+// each entry array indexed by the descriptor index of its type.
+static const DescriptorTable_Entry_t PROGMEM DeviceDescriptors[] = {DESCRIPTOR_ENTRY(DeviceDescriptor)};
+static const DescriptorTable_Entry_t PROGMEM ConfigurationDescriptors[] = {DESCRIPTOR_ENTRY(ConfigurationDescriptor)};
+static const DescriptorTable_Entry_t PROGMEM StringDescriptors[] =
+{
+	[STRING_ID_Language] = DESCRIPTOR_STRING_ENTRY(LanguageString),
+	[STRING_ID_Manufacturer] = DESCRIPTOR_STRING_ENTRY(ManufacturerString),
+	[STRING_ID_Product] = DESCRIPTOR_STRING_ENTRY(ProductString),
+};
+static const DescriptorTable_Entry_t PROGMEM BOSDescriptors[] = {DESCRIPTOR_ENTRY(BOSDescriptor)};
+
+static const DescriptorTable_Row_t PROGMEM Descriptors[] =
+{
+	DESCRIPTOR_ROW(DTYPE_Device, DESCRIPTOR_ANY_INTERFACE, DeviceDescriptors),
+	DESCRIPTOR_ROW(DTYPE_Configuration, DESCRIPTOR_ANY_INTERFACE, ConfigurationDescriptors),
+	DESCRIPTOR_ROW(DTYPE_String, DESCRIPTOR_ANY_INTERFACE, StringDescriptors),
+	DESCRIPTOR_ROW(DTYPE_BOS, DESCRIPTOR_ANY_INTERFACE, BOSDescriptors),
+};
+
 // This function is called by the library when device mode, and must be overriden
 // (see library "USB Descriptors" documentation) by the application code so that
 // the address and size of a requested descriptor can be given to the USB library.
@@ -118,45 +203,5 @@ uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
 									const uint8_t wIndex,
 									const void** const DescriptorAddress)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB getdescriptor...0x%x, 0x%x\n", wValue, wIndex);
-	#endif
-	const uint8_t DescriptorType = (wValue >> 8);
-	const uint8_t DescriptorNumber = (wValue & 0xFF);
-
-	const void* Address = NULL;
-	uint16_t Size = NO_DESCRIPTOR;
-
-	switch (DescriptorType)
-	{
-		case DTYPE_Device:
-			Address = &DeviceDescriptor;
-			Size = sizeof(USB_Descriptor_Device_t);
-			break;
-		case DTYPE_Configuration:
-			Address = &ConfigurationDescriptor;
-			Size = sizeof(USB_Descriptor_Configuration_t);
-			break;
-		case DTYPE_String:
-			switch (DescriptorNumber)
-			{
-				case STRING_ID_Language:
-					Address = &LanguageString;
-					Size = pgm_read_byte(&LanguageString.Header.Size);
-					break;
-				case STRING_ID_Manufacturer:
-					Address = &ManufacturerString;
-					Size = pgm_read_byte(&ManufacturerString.Header.Size);
-					break;
-				case STRING_ID_Product:
-					Address = &ProductString;
-					Size = pgm_read_byte(&ProductString.Header.Size);
-					break;
-			}
-			break;
-	}
-
-	*DescriptorAddress = Address;
-	return Size;
+	return DESCRIPTOR_TABLE_LOOKUP(Descriptors, wValue, wIndex, DescriptorAddress);
 }
-
@@ -15,6 +15,38 @@
 // Size in bytes of the Bulk Vendor data endpoints.
 #define VENDOR_IO_EPSIZE	64
 
+// Number of banks of the Bulk Vendor data endpoints, set in CMakeLists.txt.
+#ifndef VENDOR_EP_BANKS
+	#define VENDOR_EP_BANKS	1
+#endif
+
+// Descriptor types of the Binary device Object Store (USB 2.0 LPM ECN), not in
+// the LUFA descriptor type list.
+#define DTYPE_BOS					0x0F
+#define DTYPE_DeviceCapability		0x10
+
+// Device capability type of a platform capability descriptor.
+#define DCTYPE_Platform				0x05
+
+// Microsoft OS 2.0 descriptors. Windows 8.1 and later read the BOS descriptor
+// of a bcdUSB 2.01 device, find the MS OS 2.0 platform capability and fetch the
+// descriptor set with the vendor request MS_OS_20_VENDOR_CODE, wIndex
+// MS_OS_20_DESCRIPTOR_INDEX. The set binds WinUSB to the device and registers
+// MS_OS_20_DEVICE_INTERFACE_GUID, so no INF or driver setup is needed.
+#define MS_OS_20_WINDOWS_VERSION		0x06030000 // Windows 8.1
+#define MS_OS_20_DESCRIPTOR_INDEX		0x07
+#define MS_OS_20_SET_HEADER_DESCRIPTOR	0x00
+#define MS_OS_20_FEATURE_COMPATIBLE_ID	0x03
+#define MS_OS_20_FEATURE_REG_PROPERTY	0x04
+#define MS_OS_20_REG_MULTI_SZ			0x07
+
+// bRequest of the vendor request that returns the MS OS 2.0 descriptor set,
+// announced in the platform capability. Clear of the Vendor_Requests_t codes.
+#define MS_OS_20_VENDOR_CODE			0x20
+
+// DeviceInterfaceGUIDs of the device, the GUID host programs open it by.
+#define MS_OS_20_DEVICE_INTERFACE_GUID	L"{A9EC2079-A272-48AC-B428-0518A4A0821E}"
+
 // Type Defines:
 // Type define for the device configuration descriptor structure. This must be
 // defined in the application code, as the configuration descriptor contains
@@ -30,6 +62,61 @@ typedef struct
 	USB_Descriptor_Endpoint_t Vendor_DataOutEndpoint;
 } USB_Descriptor_Configuration_t;
 
+// BOS descriptor with the MS OS 2.0 platform capability.
+typedef struct
+{
+	struct
+	{
+		USB_Descriptor_Header_t Header;
+		uint16_t TotalLength;
+		uint8_t NumDeviceCaps;
+	} ATTR_PACKED BOS;
+
+	struct
+	{
+		USB_Descriptor_Header_t Header;
+		uint8_t DevCapabilityType;
+		uint8_t Reserved;
+		uint8_t PlatformCapabilityUUID[16];
+		uint32_t WindowsVersion;
+		uint16_t DescriptorSetTotalLength;
+		uint8_t VendorCode;
+		uint8_t AltEnumCode;
+	} ATTR_PACKED MSOS20Platform;
+} ATTR_PACKED USB_Descriptor_BOS_t;
+
+// MS OS 2.0 descriptor set, returned by the MS_OS_20_VENDOR_CODE request.
+// Every descriptor of the set starts with its 16-bit length and type.
+typedef struct
+{
+	struct
+	{
+		uint16_t Length;
+		uint16_t DescriptorType;
+		uint32_t WindowsVersion;
+		uint16_t TotalLength;
+	} ATTR_PACKED Header;
+
+	struct
+	{
+		uint16_t Length;
+		uint16_t DescriptorType;
+		uint8_t CompatibleID[8];
+		uint8_t SubCompatibleID[8];
+	} ATTR_PACKED CompatibleID;
+
+	struct
+	{
+		uint16_t Length;
+		uint16_t DescriptorType;
+		uint16_t PropertyDataType;
+		uint16_t PropertyNameLength;
+		wchar_t PropertyName[21];
+		uint16_t PropertyDataLength;
+		wchar_t PropertyData[40];
+	} ATTR_PACKED DeviceInterfaceGUIDs;
+} ATTR_PACKED USB_MSOS20_DescriptorSet_t;
+
 // Enum for the device interface descriptor IDs whithin the device. Each
 // interface descriptor should have a unique ID index associated with it,
 // which can be used to refer to the interface from other descriptors.
@@ -46,8 +133,12 @@ enum StringDescriptors_t
 	STRING_ID_Language = 0, // Supported Languages string descriptor ID (must be zero)
 	STRING_ID_Manufacturer =1, // Manufacturer string ID
 	STRING_ID_Product = 2, // Product string ID
+	STRING_ID_Serial = 3, // Serial number string ID, answered from SRAM (Common/SerialNumber.h)
 };
 
+// Global Variables:
+extern const USB_MSOS20_DescriptorSet_t MSOS20DescriptorSet;
+
 // Function Prototypes:
 uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
 									const uint8_t wIndex,
@@ -1,8 +1,94 @@
 #include "LufaUtil.h"
+#include "PerfCounters.h"
+#include "CycleProbe.h"
+#include "EventLog.h"
+
+// Counts and logs the error of a wait for the selected endpoint.
+static uint8_t Device_WaitResult(const uint8_t ErrorCode)
+{
+	if (ErrorCode == ENDPOINT_READYWAIT_Timeout)
+		PERF_COUNT(WaitTimeouts);
+	else if (ErrorCode != ENDPOINT_READYWAIT_NoError)
+		PERF_COUNT(DisconnectedErrors);
+
+	if (ErrorCode != ENDPOINT_READYWAIT_NoError)
+		LOG_ERROR(DATA, EndpointWaitError, ErrorCode, Endpoint_GetCurrentEndpoint());
+
+	return ErrorCode;
+}
+
+// Endpoint_WaitUntilReady on the selected endpoint, counting the calls that
+// find it not Ready yet and the errors.
+static uint8_t Device_WaitUntilReady(const bool Ready)
+{
+	if (!(Ready))
+		PERF_COUNT(EndpointWaits);
+
+	return Device_WaitResult(Endpoint_WaitUntilReady());
+}
+
+// Waits like Device_WaitUntilReady for the next packet of a message on the
+// endpoint at Address, a free bank on an IN endpoint or a received packet on
+// an OUT endpoint, but runs USB_USBTask while it waits: a polled control
+// endpoint keeps answering requests while the host takes up to the stream
+// timeout to send or read the rest of the message. Leaves the endpoint
+// selected.
+static uint8_t Device_WaitForMessagePacket(const uint8_t Address)
+{
+	uint8_t TimeoutMSRem = USB_STREAM_TIMEOUT_MS;
+	uint16_t PreviousFrameNumber = USB_Device_GetFrameNumber();
+
+	for (bool Waited = false; ; Waited = true)
+	{
+		Endpoint_SelectEndpoint(Address);
+
+		if ((Address & ENDPOINT_DIR_MASK) == ENDPOINT_DIR_IN)
+		{
+			if (Endpoint_IsINReady())
+				return ENDPOINT_READYWAIT_NoError;
+		}
+		else if (Endpoint_IsOUTReceived())
+		{
+			return ENDPOINT_READYWAIT_NoError;
+		}
+
+		if (!(Waited))
+			PERF_COUNT(EndpointWaits);
+
+		uint8_t DeviceState = USB_DeviceState;
+
+		if (DeviceState == DEVICE_STATE_Unattached)
+			return Device_WaitResult(ENDPOINT_READYWAIT_DeviceDisconnected);
+		else if (DeviceState == DEVICE_STATE_Suspended)
+			return Device_WaitResult(ENDPOINT_READYWAIT_BusSuspended);
+		else if (DeviceState != DEVICE_STATE_Configured)
+			return Device_WaitResult(ENDPOINT_READYWAIT_DeviceDisconnected);
+		else if (Endpoint_IsStalled())
+			return Device_WaitResult(ENDPOINT_READYWAIT_EndpointStalled);
+
+		uint16_t CurrentFrameNumber = USB_Device_GetFrameNumber();
+
+		if (CurrentFrameNumber != PreviousFrameNumber)
+		{
+			PreviousFrameNumber = CurrentFrameNumber;
+
+			if (!(TimeoutMSRem--))
+				return Device_WaitResult(ENDPOINT_READYWAIT_Timeout);
+		}
+
+		USB_USBTask();
+	}
+}
 
 uint8_t Device_SendByte(USB_EPInfo_Device_t* EPInfo, const uint8_t Data)
 {
-	if (USB_DeviceState != DEVICE_STATE_Configured) return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	CYCLE_PROBE(CYCLE_PROBE_DeviceSendByte);
+
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+	{
+		PERF_COUNT(DisconnectedErrors);
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
 	// USB_DeviceState 
 	// USBTask.h
 	// Indicates the current device state machine state. When in device mode, 
@@ -31,13 +117,16 @@ uint8_t Device_SendByte(USB_EPInfo_Device_t* EPInfo, const uint8_t Data)
 	// empty packet) has been received, or if the endpoint is an IN direction 
 	// and the endpoint bank is full.
 	{
+		PERF_COUNT(INPackets);
+		CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+		PERF_ADD(INBytes, Endpoint_BytesInEndpoint());
 		Endpoint_ClearIN();
 		// Endpoint_AVR8.h
 		// Sends an IN packet to the host on the currently selected endpoint, freeing up the endpoint for the next packet and switching to the alternative endpoint bank if double banked
 		
 		uint8_t ErrorCode;
 
-		if ((ErrorCode = Endpoint_WaitUntilReady()) != ENDPOINT_READYWAIT_NoError)
+		if ((ErrorCode = Device_WaitUntilReady(Endpoint_IsINReady())) != ENDPOINT_READYWAIT_NoError)
 		// Endpoint_WaitUntilReady
 		// Endpoint_AVR8.h
 		// Spin-loops until the currently selected non-control endpoint is 
@@ -57,6 +146,8 @@ uint8_t Device_SendByte(USB_EPInfo_Device_t* EPInfo, const uint8_t Data)
 
 int16_t Device_ReceiveByte(USB_EPInfo_Device_t* const EPInfo)
 {
+	CYCLE_PROBE(CYCLE_PROBE_DeviceReceiveByte);
+
 	if (USB_DeviceState != DEVICE_STATE_Configured)
 		return -1;
 
@@ -73,22 +164,200 @@ int16_t Device_ReceiveByte(USB_EPInfo_Device_t* const EPInfo)
 		// Endpoint_AVR8.h
 		// Indicates the number of bytes currently stored in the current 
 		// endpoint's selected bank.
+		{
 			ReceivedByte = Endpoint_Read_8();
 			// Endpoint_AVR8.h
 			// Reads one byte from the currently selected endpoint's bank, 
 			// for OUT direction endpoints.
+			PERF_COUNT(OUTBytes);
+		}
 		if (!(Endpoint_BytesInEndpoint()))
+		{
+			PERF_COUNT(OUTPackets);
 			Endpoint_ClearOUT();
 			// Endpoint_AVR8.h
 			// Acknowledges an OUT packet to the host on the currently selected
 			// endpoint, freeing up the endpoint for the next packet and 
 			// switching to the alternative endpoint bank if double banked.
+		}
 	}
 
 	return ReceivedByte;
 
 }
 
+uint8_t Device_Write_Block(USB_EPInfo_Device_t* const EPInfo, const void* const Buffer, const uint16_t Length)
+{
+	CYCLE_PROBE(CYCLE_PROBE_DeviceWriteBlock);
+
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+	{
+		PERF_COUNT(DisconnectedErrors);
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
+
+	Endpoint_SelectEndpoint(EPInfo->DataINEPAddress);
+
+	// One packet per call, the bytes past DataEPSize would not fit into the
+	// bank.
+	uint16_t Count = Length;
+	if (Count > EPInfo->DataEPSize)
+		Count = EPInfo->DataEPSize;
+
+	uint8_t ErrorCode;
+
+	// Wait once for a free IN bank instead of checking for every byte.
+	if ((ErrorCode = Device_WaitUntilReady(Endpoint_IsINReady())) != ENDPOINT_READYWAIT_NoError)
+		return ErrorCode;
+
+	const uint8_t* Data = (const uint8_t*)Buffer;
+	for (uint16_t i = 0; i < Count; i++)
+		Endpoint_Write_8(*Data++);
+
+	PERF_COUNT(INPackets);
+	CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+	PERF_ADD(INBytes, Count);
+	// Send the packet right away, a short packet also terminates the transfer
+	// on the host side.
+	Endpoint_ClearIN();
+	return ENDPOINT_READYWAIT_NoError;
+}
+
+uint16_t Device_Read_Block(USB_EPInfo_Device_t* const EPInfo, void* const Buffer, const uint16_t Length)
+{
+	CYCLE_PROBE(CYCLE_PROBE_DeviceReadBlock);
+
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+		return 0;
+
+	Endpoint_SelectEndpoint(EPInfo->DataOUTEPAddress);
+
+	if (!(Endpoint_IsOUTReceived()))
+		return 0;
+
+	uint16_t Count = Endpoint_BytesInEndpoint();
+	if (Count > Length)
+		Count = Length;
+
+	uint8_t* Data = (uint8_t*)Buffer;
+	for (uint16_t i = 0; i < Count; i++)
+		*Data++ = Endpoint_Read_8();
+
+	PERF_ADD(OUTBytes, Count);
+	// Release the bank only when it has been read completely, a smaller
+	// Length leaves the rest of the packet for the next call. A zero length
+	// packet is released here and returns 0 like no packet at all.
+	if (!(Endpoint_BytesInEndpoint()))
+	{
+		PERF_COUNT(OUTPackets);
+		Endpoint_ClearOUT();
+	}
+
+	return Count;
+}
+
+static uint8_t Device_MessageError(const uint8_t ReadyWaitError)
+{
+	return (ReadyWaitError == ENDPOINT_READYWAIT_Timeout) ? DEVICE_MESSAGE_Timeout : DEVICE_MESSAGE_DeviceDisconnected;
+}
+
+uint8_t Device_Write_Message(USB_EPInfo_Device_t* const EPInfo, const void* const Buffer, const uint16_t Length)
+{
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+	{
+		PERF_COUNT(DisconnectedErrors);
+		return DEVICE_MESSAGE_DeviceDisconnected;
+	}
+
+	const uint8_t* Data = (const uint8_t*)Buffer;
+	uint16_t Remaining = Length;
+
+	for (;;)
+	{
+		uint8_t ErrorCode;
+
+		if ((ErrorCode = Device_WaitForMessagePacket(EPInfo->DataINEPAddress)) != ENDPOINT_READYWAIT_NoError)
+			return Device_MessageError(ErrorCode);
+
+		uint16_t Count = (Remaining < EPInfo->DataEPSize) ? Remaining : EPInfo->DataEPSize;
+		for (uint16_t i = 0; i < Count; i++)
+			Endpoint_Write_8(*Data++);
+
+		PERF_COUNT(INPackets);
+		CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+		PERF_ADD(INBytes, Count);
+		Endpoint_ClearIN();
+		Remaining -= Count;
+
+		if (Count < EPInfo->DataEPSize)
+			return DEVICE_MESSAGE_NoError;
+		// A full packet, even the last one: the message is only ended by the
+		// next, shorter packet, a zero length packet if nothing remains.
+	}
+}
+
+uint8_t Device_Read_Message(USB_EPInfo_Device_t* const EPInfo, void* const Buffer, const uint16_t Length, uint16_t* const MessageLength)
+{
+	*MessageLength = 0;
+
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+	{
+		PERF_COUNT(DisconnectedErrors);
+		return DEVICE_MESSAGE_DeviceDisconnected;
+	}
+
+	Endpoint_SelectEndpoint(EPInfo->DataOUTEPAddress);
+
+	if (!(Endpoint_IsOUTReceived()))
+		return DEVICE_MESSAGE_NoMessage;
+
+	uint8_t* Data = (uint8_t*)Buffer;
+	bool Truncated = false;
+
+	for (;;)
+	{
+		uint16_t Count = Endpoint_BytesInEndpoint();
+		uint16_t Copy = (Length - *MessageLength);
+
+		if (Copy > Count)
+			Copy = Count;
+
+		for (uint16_t i = 0; i < Copy; i++)
+			*Data++ = Endpoint_Read_8();
+
+		*MessageLength += Copy;
+		if (Copy < Count)
+			Truncated = true;
+
+		PERF_COUNT(OUTPackets);
+		PERF_ADD(OUTBytes, Count);
+		Endpoint_ClearOUT();
+		// Releasing the bank discards the bytes that did not fit.
+
+		if (Count < EPInfo->DataEPSize)
+			return (Truncated ? DEVICE_MESSAGE_Truncated : DEVICE_MESSAGE_NoError);
+
+		// The message goes on, wait for its next packet.
+		uint8_t ErrorCode;
+
+		if ((ErrorCode = Device_WaitForMessagePacket(EPInfo->DataOUTEPAddress)) != ENDPOINT_READYWAIT_NoError)
+			return Device_MessageError(ErrorCode);
+	}
+}
+
+bool Device_IsINReady(USB_EPInfo_Device_t* const EPInfo)
+{
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+		return false;
+
+	Endpoint_SelectEndpoint(EPInfo->DataINEPAddress);
+
+	return Endpoint_IsINReady();
+	// Endpoint_AVR8.h
+	// Determines if the selected IN endpoint is ready for a new packet to be
+	// sent to the host, i.e. at least one of its banks is free.
+}
+
 void Device_CreateStream(USB_EPInfo_Device_t* const EPInfo, FILE* const Stream)
 {
 	*Stream = (FILE)FDEV_SETUP_STREAM(Device_putchar, Device_getchar, _FDEV_SETUP_RW);
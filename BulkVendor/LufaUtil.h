@@ -8,10 +8,34 @@ typedef struct
 {
 	uint8_t DataINEPAddress; // Data IN endpoint address;
 	uint8_t DataOUTEPAddress; // Data OUT endpoint address;
+	uint16_t DataEPSize; // Size of the data endpoints, a shorter packet ends a message
 } USB_EPInfo_Device_t;
 
+// Return codes of Device_Read_Message and Device_Write_Message.
+enum Device_Message_ErrorCodes_t
+{
+	DEVICE_MESSAGE_NoError = 0, // A whole message was transferred.
+	DEVICE_MESSAGE_NoMessage = 1, // No message is waiting on the OUT endpoint.
+	DEVICE_MESSAGE_Truncated = 2, // The message did not fit into the buffer, the rest was discarded.
+	DEVICE_MESSAGE_Timeout = 3, // The host stopped in the middle of the message.
+	DEVICE_MESSAGE_DeviceDisconnected = 4, // The device is not configured, or the endpoint stalled or was suspended.
+};
+
 uint8_t Device_SendByte(USB_EPInfo_Device_t* EPInfo, const uint8_t Data) ATTR_NON_NULL_PTR_ARG(1);
 int16_t Device_ReceiveByte(USB_EPInfo_Device_t* const EPInfo) ATTR_NON_NULL_PTR_ARG(1);
+bool Device_IsINReady(USB_EPInfo_Device_t* const EPInfo) ATTR_NON_NULL_PTR_ARG(1);
+// Block transfers, one packet per call. Device_Write_Block sends the first
+// Length bytes of Buffer, at most DataEPSize, as one IN packet.
+// Device_Read_Block returns the number of bytes it read, 0 both when no packet
+// is waiting and for a zero length packet; callers that need to tell them
+// apart use the framed messages below.
+uint8_t Device_Write_Block(USB_EPInfo_Device_t* const EPInfo, const void* const Buffer, const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+uint16_t Device_Read_Block(USB_EPInfo_Device_t* const EPInfo, void* const Buffer, const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+// Framed messages: a message is a run of full packets ended by a short packet,
+// or by a zero length packet when its length is a multiple of DataEPSize, so
+// the host can read a whole message with one large bulk transfer.
+uint8_t Device_Write_Message(USB_EPInfo_Device_t* const EPInfo, const void* const Buffer, const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+uint8_t Device_Read_Message(USB_EPInfo_Device_t* const EPInfo, void* const Buffer, const uint16_t Length, uint16_t* const MessageLength) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2) ATTR_NON_NULL_PTR_ARG(4);
 void Device_CreateStream(USB_EPInfo_Device_t* const EPInfo, FILE* const Stream) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
 int Device_putchar(char c, FILE* Stream) ATTR_NON_NULL_PTR_ARG(2);
 int Device_getchar(FILE* Stream) ATTR_NON_NULL_PTR_ARG(1);
@@ -0,0 +1,152 @@
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "CycleProbe.h"
+
+#ifdef CYCLE_PROBES
+volatile uint8_t CycleProbeSpan = CYCLE_PROBE_COUNT;
+
+static CycleProbe_Stats_t CycleProbes[CYCLE_PROBE_COUNT];
+
+// Cycles between the two TCNT1 reads of an empty probe, subtracted from every
+// measurement.
+static uint16_t CycleProbeOverhead;
+
+// Start of the open span, and the Timer1 overflows since, saturating.
+static uint16_t CycleProbeSpanStart;
+static volatile uint8_t CycleProbeSpanOverflows;
+
+// Only enabled while a span is open.
+ISR(TIMER1_OVF_vect)
+{
+	if (CycleProbeSpanOverflows != 0xFF)
+		CycleProbeSpanOverflows++;
+}
+
+void CycleProbe_Init(void)
+{
+	// Normal mode, no prescaler
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+
+	uint16_t Start = TCNT1;
+	uint16_t End = TCNT1;
+	CycleProbeOverhead = End - Start;
+
+	for (uint8_t i = 0; i < CYCLE_PROBE_COUNT; i++)
+		CycleProbes[i].MinCycles = 0xFFFF;
+}
+
+void CycleProbe_Record(const uint8_t Probe, const uint16_t Cycles)
+{
+	CycleProbe_Stats_t* Stats = &CycleProbes[Probe];
+	uint16_t Measured = (Cycles > CycleProbeOverhead) ? (Cycles - CycleProbeOverhead) : 0;
+
+	uint8_t Bucket = 0;
+	for (uint16_t Limit = 16; (Bucket < (CYCLE_PROBE_BUCKETS - 1)) && (Measured >= Limit); Limit <<= 1)
+		Bucket++;
+
+	// A probe may record from the main loop or the control request interrupt,
+	// which re-enables interrupts, and from the endpoint interrupt.
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Stats->Count++;
+		Stats->TotalCycles += Measured;
+
+		if (Measured < Stats->MinCycles)
+			Stats->MinCycles = Measured;
+		if (Measured > Stats->MaxCycles)
+			Stats->MaxCycles = Measured;
+
+		if (Stats->Buckets[Bucket] != 0xFFFF)
+			Stats->Buckets[Bucket]++;
+	}
+}
+
+void CycleProbe_StartSpan(const uint8_t Probe)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	CycleProbeSpan = Probe;
+	CycleProbeSpanOverflows = 0;
+	TIFR1 = (1 << TOV1);
+	TIMSK1 |= (1 << TOIE1);
+	CycleProbeSpanStart = TCNT1;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+void CycleProbe_RecordSpan(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint16_t End = TCNT1;
+	uint8_t Overflows = CycleProbeSpanOverflows;
+	uint8_t Probe = CycleProbeSpan;
+
+	// An overflow not yet counted by the disabled interrupt happened before
+	// End if End is small.
+	if ((TIFR1 & (1 << TOV1)) && (End < 0x8000))
+		Overflows++;
+
+	TIMSK1 &= ~(1 << TOIE1);
+	CycleProbeSpan = CYCLE_PROBE_COUNT;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	if ((Overflows > 1) || ((Overflows == 1) && (End >= CycleProbeSpanStart)))
+		CycleProbe_Record(Probe, 0xFFFF);
+	else
+		CycleProbe_Record(Probe, End - CycleProbeSpanStart);
+}
+
+void CycleProbe_ProcessControlRequest(void)
+{
+	if ((USB_ControlRequest.bmRequestType & CONTROL_REQTYPE_TYPE) != REQTYPE_VENDOR)
+		return;
+
+	if ((USB_ControlRequest.bRequest == CYCLE_REQ_GetProbe) &&
+		(USB_ControlRequest.bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE)))
+	{
+		CycleProbe_GetProbe();
+	}
+	else if ((USB_ControlRequest.bRequest == CYCLE_REQ_ResetProbes) &&
+			 (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE)))
+	{
+		CycleProbe_ResetProbes();
+	}
+}
+
+void CycleProbe_GetProbe(void)
+{
+	if (USB_ControlRequest.wIndex >= CYCLE_PROBE_COUNT)
+		return;
+
+	CycleProbe_Stats_t Stats;
+
+	// Probes in the interrupt driven builds record from the endpoint
+	// interrupt, which may preempt this one.
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+	Stats = CycleProbes[USB_ControlRequest.wIndex];
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	Endpoint_ClearSETUP();
+	Endpoint_Write_Control_Stream_LE(&Stats, sizeof(Stats));
+	Endpoint_ClearOUT();
+}
+
+void CycleProbe_ResetProbes(void)
+{
+	Endpoint_ClearSETUP();
+	Endpoint_ClearStatusStage();
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+	memset(CycleProbes, 0, sizeof(CycleProbes));
+	for (uint8_t i = 0; i < CYCLE_PROBE_COUNT; i++)
+		CycleProbes[i].MinCycles = 0xFFFF;
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+#endif
@@ -0,0 +1,114 @@
+// Cycle-accurate timing of the firmware hot paths with Timer1, built only when
+// CYCLE_PROBES is defined (CMake option of the same name).
+//
+// Timer1 runs free at the CPU clock. CYCLE_PROBE(Probe) at the top of a
+// function reads TCNT1, and the cycles until the function returns, by any
+// path, are added to the statistics of Probe: count, total for the mean, min,
+// max and a histogram of power of two buckets. The 16-bit timer limits a
+// single measurement to 65535 cycles, 4ms at 16MHz. The host reads the
+// statistics of each probe with CYCLE_REQ_GetProbe
+// (Host/tools/cycle_probes.py).
+//
+// A span times the cycles from one event to another instead of a function,
+// e.g. from the USB wakeup interrupt to the first packet sent after it:
+// CycleProbe_StartSpan opens the span of a probe, the next CycleProbe_EndSpan
+// of the same probe records it. One span is open at a time. Timer1 overflows
+// are counted while it is open, a span of more than 65535 cycles is recorded
+// as 65535.
+//
+// Without CYCLE_PROBES the macros and functions below compile to nothing and
+// Timer1 is left alone, so the probes can stay in production sources.
+#ifndef CYCLEPROBE_H
+#define CYCLEPROBE_H
+
+// Includes:
+#include <avr/io.h>
+#include <LUFA/Drivers/USB/USB.h>
+
+// Macros:
+// Vendor specific control requests (REQTYPE_VENDOR | REQREC_DEVICE).
+#define CYCLE_REQ_GetProbe			0x06 // Device to host, wIndex: probe: CycleProbe_Stats_t
+#define CYCLE_REQ_ResetProbes		0x07 // Host to device
+
+// Number of histogram buckets, bucket i counts the measurements below
+// (16 << i) cycles that did not fit a lower bucket, the last one the rest.
+#define CYCLE_PROBE_BUCKETS			8
+
+// Type Defines:
+enum CycleProbe_Probes_t
+{
+	CYCLE_PROBE_DeviceSendByte = 0, // LufaUtil.c
+	CYCLE_PROBE_DeviceReceiveByte = 1,
+	CYCLE_PROBE_DeviceWriteBlock = 2,
+	CYCLE_PROBE_DeviceReadBlock = 3,
+	CYCLE_PROBE_MainTask = 4, // VirtualSerial.c
+	CYCLE_PROBE_CreateHIDReport = 5, // GenericHID.c
+	CYCLE_PROBE_ResumeToFirstPacket = 6, // Span, PowerSave.c to the data paths
+	CYCLE_PROBE_IdleSleep = 7, // PowerSave.c
+	CYCLE_PROBE_IdleWakeup = 8,
+	CYCLE_PROBE_COUNT
+};
+
+// Statistics of one probe returned by CYCLE_REQ_GetProbe, little endian.
+typedef struct
+{
+	uint32_t Count;
+	uint64_t TotalCycles;
+	uint16_t MinCycles;
+	uint16_t MaxCycles;
+	uint16_t Buckets[CYCLE_PROBE_BUCKETS]; // Saturate at 0xFFFF
+} ATTR_PACKED CycleProbe_Stats_t;
+
+#ifdef CYCLE_PROBES
+typedef struct
+{
+	uint16_t Start;
+	uint8_t Probe;
+} CycleProbe_Scope_t;
+
+// Global Variables:
+// Probe of the open span, CYCLE_PROBE_COUNT when none is open.
+extern volatile uint8_t CycleProbeSpan;
+
+// Function Prototypes:
+void CycleProbe_Init(void);
+void CycleProbe_Record(const uint8_t Probe, const uint16_t Cycles);
+void CycleProbe_StartSpan(const uint8_t Probe);
+void CycleProbe_RecordSpan(void);
+// Handles CYCLE_REQ_GetProbe and CYCLE_REQ_ResetProbes, call from
+// EVENT_USB_Device_ControlRequest. Other requests are left alone.
+void CycleProbe_ProcessControlRequest(void);
+// Request handlers for a firmware that dispatches its vendor requests itself.
+void CycleProbe_GetProbe(void);
+void CycleProbe_ResetProbes(void);
+
+// Inline Functions:
+// Cleanup of the CYCLE_PROBE scope variable, runs as the function returns.
+static inline void CycleProbe_Leave(CycleProbe_Scope_t* const Scope) ATTR_ALWAYS_INLINE;
+static inline void CycleProbe_Leave(CycleProbe_Scope_t* const Scope)
+{
+	uint16_t End = TCNT1;
+
+	CycleProbe_Record(Scope->Probe, End - Scope->Start);
+}
+
+#define CYCLE_PROBE(Probe)	CycleProbe_Scope_t CycleProbeScope __attribute__ ((cleanup (CycleProbe_Leave))) = {TCNT1, (Probe)}
+
+// Called on every packet of the data paths, so only a compare unless the span
+// of Probe is open.
+static inline void CycleProbe_EndSpan(const uint8_t Probe) ATTR_ALWAYS_INLINE;
+static inline void CycleProbe_EndSpan(const uint8_t Probe)
+{
+	if (CycleProbeSpan == Probe)
+		CycleProbe_RecordSpan();
+}
+#else
+#define CYCLE_PROBE(Probe)
+
+static inline void CycleProbe_Init(void) {}
+static inline void CycleProbe_ProcessControlRequest(void) {}
+static inline void CycleProbe_StartSpan(const uint8_t Probe) { (void)Probe; }
+static inline void CycleProbe_EndSpan(const uint8_t Probe) { (void)Probe; }
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+#include "DescriptorTable.h"
+#include "EventLog.h"
+
+uint16_t DescriptorTable_Lookup(const DescriptorTable_Row_t* const Table,
+								const uint8_t Rows,
+								const uint16_t wValue,
+								const uint8_t wIndex,
+								const void** const DescriptorAddress)
+{
+	LOG_DEBUG(USB, GetDescriptor, wValue, wIndex);
+	const uint8_t DescriptorType = (wValue >> 8);
+	const uint8_t DescriptorNumber = (wValue & 0xFF);
+
+	*DescriptorAddress = NULL;
+
+	for (uint8_t i = 0; i < Rows; i++)
+	{
+		if (pgm_read_byte(&Table[i].Type) != DescriptorType)
+			continue;
+
+		uint8_t Interface = pgm_read_byte(&Table[i].Interface);
+		if ((Interface != DESCRIPTOR_ANY_INTERFACE) && (Interface != wIndex))
+			continue;
+
+		if (DescriptorNumber >= pgm_read_byte(&Table[i].Count))
+			break;
+
+		const DescriptorTable_Entry_t* Entries = (const DescriptorTable_Entry_t*)pgm_read_ptr(&Table[i].Entries);
+		const void* Address = pgm_read_ptr(&Entries[DescriptorNumber].Address);
+		uint16_t Size = pgm_read_word(&Entries[DescriptorNumber].Size);
+
+		// Gap in a sparse array, e.g. an unused string index
+		if (Address == NULL)
+			break;
+
+		// bLength, the first byte of every descriptor with a header
+		if (Size == DESCRIPTOR_SIZE_FROM_HEADER)
+			Size = pgm_read_byte(Address);
+
+		*DescriptorAddress = Address;
+		return Size;
+	}
+
+	return NO_DESCRIPTOR;
+}
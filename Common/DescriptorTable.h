@@ -0,0 +1,69 @@
+// Descriptor lookup for CALLBACK_USB_GetDescriptor, shared by the projects.
+//
+// A project lists its descriptors as data in a PROGMEM table: one row per
+// descriptor type, and in each row an array of the descriptors of that type
+// indexed by the descriptor index of the request. A lookup finds the row of
+// the requested type among the few rows of the table and then indexes the
+// array, so its time does not depend on the number of strings or reports,
+// and a new descriptor is one more entry instead of another case of a switch.
+#ifndef DESCRIPTORTABLE_H
+#define DESCRIPTORTABLE_H
+
+// Includes:
+#include <avr/pgmspace.h>
+#include <LUFA/Drivers/USB/USB.h>
+
+// Macros:
+// Entry size of the descriptors whose size is the bLength of their own
+// header: the string descriptors, of which sizeof misses the string.
+#define DESCRIPTOR_SIZE_FROM_HEADER		0
+
+// Interface of a row that serves the requests for any wIndex. The class
+// descriptors of an interface (HID) give its interface number instead.
+#define DESCRIPTOR_ANY_INTERFACE		0xFF
+
+// Entry of a descriptor of fixed size, and of a string descriptor.
+#define DESCRIPTOR_ENTRY(Descriptor)		{.Address = &(Descriptor), .Size = sizeof(Descriptor)}
+#define DESCRIPTOR_STRING_ENTRY(Descriptor)	{.Address = &(Descriptor), .Size = DESCRIPTOR_SIZE_FROM_HEADER}
+
+// Row of the descriptors of type DescriptorType in the entry array EntryArray.
+#define DESCRIPTOR_ROW(DescriptorType, InterfaceNumber, EntryArray)						\
+	{																					\
+		.Type = (DescriptorType),														\
+		.Interface = (InterfaceNumber),													\
+		.Count = (sizeof(EntryArray) / sizeof(EntryArray[0])),							\
+		.Entries = (EntryArray),														\
+	}
+
+// Looks the request up in Table, an array of DescriptorTable_Row_t.
+#define DESCRIPTOR_TABLE_LOOKUP(Table, wValue, wIndex, DescriptorAddress)				\
+	DescriptorTable_Lookup((Table), (sizeof(Table) / sizeof(Table[0])), (wValue), (wIndex), (DescriptorAddress))
+
+// Type Defines:
+typedef struct
+{
+	const void* Address; // Descriptor in flash
+	uint16_t Size; // Size in bytes, or DESCRIPTOR_SIZE_FROM_HEADER
+} DescriptorTable_Entry_t;
+
+typedef struct
+{
+	uint8_t Type; // Descriptor type, the high byte of wValue
+	uint8_t Interface; // wIndex of the requests served, or DESCRIPTOR_ANY_INTERFACE
+	uint8_t Count; // Number of entries, the descriptor indexes 0 to Count - 1
+	const DescriptorTable_Entry_t* Entries; // Entry array in flash
+} DescriptorTable_Row_t;
+
+// Function Prototypes:
+// Sets DescriptorAddress to the descriptor of the GET_DESCRIPTOR request given
+// by wValue and wIndex and returns its size, or returns NO_DESCRIPTOR if the
+// table has none or its entry is left empty (NULL address). The table and the
+// entries are read from flash.
+uint16_t DescriptorTable_Lookup(const DescriptorTable_Row_t* const Table,
+								const uint8_t Rows,
+								const uint16_t wValue,
+								const uint8_t wIndex,
+								const void** const DescriptorAddress)
+								ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(5);
+
+#endif
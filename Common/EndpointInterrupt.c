@@ -0,0 +1,32 @@
+#include "EndpointInterrupt.h"
+
+#ifdef INTERRUPT_DATA_ENDPOINT
+ISR(USB_COM_vect)
+{
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+
+	EVENT_EndpointInterrupt_Data();
+
+	// A data interrupt during a control request finds RXSTPE off and leaves
+	// the SETUP to the running handler.
+	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+	if ((UEIENX & (1 << RXSTPE)) && Endpoint_IsSETUPReceived())
+	{
+		UEIENX &= ~(1 << RXSTPE);
+		GlobalInterruptEnable();
+		USB_Device_ProcessControlRequest();
+		GlobalInterruptDisable();
+
+		Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+		UEIENX |= (1 << RXSTPE);
+	}
+
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+}
+
+void EndpointInterrupt_Reset(void)
+{
+	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+	UEIENX |= (1 << RXSTPE);
+}
+#endif
@@ -0,0 +1,44 @@
+// USB endpoint interrupt of the INTERRUPT_DATA_ENDPOINT builds, shared by the
+// firmwares.
+//
+// The firmware owns USB_COM_vect instead of LUFA, so these builds leave out
+// INTERRUPT_CONTROL_ENDPOINT. The handler runs for every armed endpoint
+// interrupt. It first calls EVENT_EndpointInterrupt_Data of the firmware,
+// which moves the packets received on its OUT endpoints (RXOUTI) and fills
+// the free banks of its IN endpoints (TXINI) right away, instead of on the
+// next Start Of Frame up to 1ms later and at most once per frame. A SETUP
+// packet on the control endpoint (RXSTPI) is then handled as the LUFA
+// handler does, with USB_Device_ProcessControlRequest: the interrupts are
+// enabled again while the request runs, so a long control transfer does not
+// hold up the data endpoints, and the SETUP interrupt stays off until it is
+// done.
+//
+// RXOUTI and TXINI stay set as long as their bank is there, so the firmware
+// only arms the interrupts it waits on: RXOUTE while no packet waits in the
+// OUT bank, TXINE while there is data to send and no IN bank is free. A
+// packet left in the OUT bank for want of room, or data to send with a bank
+// free, is then the main loop's to move: after it changed its buffers it
+// runs the same service routine with the interrupts disabled.
+#ifndef ENDPOINTINTERRUPT_H
+#define ENDPOINTINTERRUPT_H
+
+// Includes:
+#include <avr/interrupt.h>
+#include <LUFA/Drivers/USB/USB.h>
+
+// Macros:
+#if defined(INTERRUPT_DATA_ENDPOINT) && defined(INTERRUPT_CONTROL_ENDPOINT)
+	#error INTERRUPT_DATA_ENDPOINT handles the control endpoint in its own USB_COM_vect, leave out INTERRUPT_CONTROL_ENDPOINT
+#endif
+
+// Function Prototypes:
+// Arms the SETUP interrupt of the control endpoint, which the bus reset
+// clears. Call from EVENT_USB_Device_Reset.
+void EndpointInterrupt_Reset(void);
+
+// Event handler of the firmware, called from USB_COM_vect with the
+// interrupts disabled. Services the data endpoints and arms or disarms their
+// interrupts, may leave any endpoint selected.
+void EVENT_EndpointInterrupt_Data(void);
+
+#endif
@@ -0,0 +1,90 @@
+#include "EventLog.h"
+#include "global.h"
+
+#ifdef EVENT_LOG_ENABLED
+#if !SPSC_RING_BUFFER_SIZE_VALID(EVENT_LOG_RING_SIZE)
+	#error EVENT_LOG_RING_SIZE must be a power of two of at most 128 bytes
+#endif
+
+// Record ring between the logging contexts and the USART1 interrupt. Every
+// writer disables interrupts for the few bytes of a record, which makes them
+// a single producer, the interrupt is the only consumer. Initialized
+// statically so that records can be logged before EventLog_Init.
+static uint8_t EventLogBufferData[EVENT_LOG_RING_SIZE];
+static SPSCRingBuffer_t EventLogBuffer =
+{
+	.Mask = EVENT_LOG_RING_SIZE - 1,
+	.Data = EventLogBufferData,
+};
+
+// Records dropped since the last EVENT_Dropped record, saturates at 0xFFFF.
+static uint16_t EventLogDropped;
+
+void EventLog_Init(void)
+{
+	// Double speed, 8N1, transmitter only
+	UBRR1 = (F_CPU / (8UL * EVENT_LOG_BAUD)) - 1;
+	UCSR1A = (1 << U2X1);
+	UCSR1C = (1 << UCSZ11) | (1 << UCSZ10);
+	UCSR1B = (1 << TXEN1) | (1 << UDRIE1);
+}
+
+static inline void EventLog_Insert(const uint8_t Event, const uint16_t Arg0, const uint16_t Arg1)
+{
+	SPSCRingBuffer_Insert(&EventLogBuffer, EVENT_LOG_SYNC);
+	SPSCRingBuffer_Insert(&EventLogBuffer, Event);
+	SPSCRingBuffer_Insert(&EventLogBuffer, (Arg0 & 0xFF));
+	SPSCRingBuffer_Insert(&EventLogBuffer, (Arg0 >> 8));
+	SPSCRingBuffer_Insert(&EventLogBuffer, (Arg1 & 0xFF));
+	SPSCRingBuffer_Insert(&EventLogBuffer, (Arg1 >> 8));
+}
+
+void EventLog_Write(const uint8_t Event, const uint16_t Arg0, const uint16_t Arg1)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint8_t FreeCount = SPSCRingBuffer_GetFreeCount(&EventLogBuffer);
+
+	// The drop count goes out before the next record, and only together with
+	// it, so the decoded log shows the gap where it happened.
+	if (EventLogDropped)
+	{
+		if (FreeCount >= (2 * EVENT_LOG_RECORD_SIZE))
+		{
+			EventLog_Insert(EVENT_Dropped, EventLogDropped, 0);
+			EventLogDropped = 0;
+			FreeCount -= EVENT_LOG_RECORD_SIZE;
+		}
+		else
+		{
+			FreeCount = 0;
+		}
+	}
+
+	if (FreeCount >= EVENT_LOG_RECORD_SIZE)
+	{
+		EventLog_Insert(Event, Arg0, Arg1);
+
+		// Restart the transmitter, unless EventLog_Init has not run yet
+		if (UCSR1B & (1 << TXEN1))
+			UCSR1B |= (1 << UDRIE1);
+	}
+	else if (EventLogDropped != 0xFFFF)
+	{
+		EventLogDropped++;
+	}
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+// USART1 data register empty: sends the next byte of the ring, and disables
+// itself once the ring is empty until EventLog_Write re-enables it.
+ISR(USART1_UDRE_vect)
+{
+	if (SPSCRingBuffer_IsEmpty(&EventLogBuffer))
+		UCSR1B &= ~(1 << UDRIE1);
+	else
+		UDR1 = SPSCRingBuffer_Remove(&EventLogBuffer);
+}
+#endif
@@ -0,0 +1,105 @@
+// Deferred binary debug log over USART1, with compile-time levels per module.
+//
+// LOG_ERROR, LOG_INFO and LOG_DEBUG(Module, Name, Arg0, Arg1) append a fixed
+// size record, the event ID and two 16-bit arguments, to a ring buffer in a
+// few dozen cycles and return; the USART1 data register empty interrupt sends
+// the ring in the background. No text is formatted on the device, the events
+// and their format strings are listed in EventLogEvents.h and
+// Host/tools/event_log_decode.py turns the records back into text. When the
+// ring is full records are dropped and counted, and an EVENT_Dropped record
+// with the count goes out once there is room again, so the timing of the
+// logging code never depends on the UART.
+//
+// The threshold of each module is LOG_LEVEL_<Module>, by default LOG_LEVEL
+// (CMake options of the same names). A call above the threshold is a constant
+// false condition the compiler removes with its arguments. With every module
+// at LOG_LEVEL_None there is no ring, no interrupt and no UART setup either.
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+// Includes:
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <LUFA/Common/Common.h>
+
+#include "SPSCRingBuffer.h"
+
+// Macros:
+#define LOG_LEVEL_None				0
+#define LOG_LEVEL_Error				1 // Failures
+#define LOG_LEVEL_Info				2 // Device state changes: connect, configuration, modes
+#define LOG_LEVEL_Debug				3 // Every control request and data packet
+
+#ifndef LOG_LEVEL
+	#define LOG_LEVEL				LOG_LEVEL_None
+#endif
+
+// Modules: USB device events and control requests, DATA the data endpoints.
+#ifndef LOG_LEVEL_USB
+	#define LOG_LEVEL_USB			LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_DATA
+	#define LOG_LEVEL_DATA			LOG_LEVEL
+#endif
+
+#if (LOG_LEVEL_USB > LOG_LEVEL_None) || (LOG_LEVEL_DATA > LOG_LEVEL_None)
+	#define EVENT_LOG_ENABLED
+#endif
+
+// True if Module logs at Level.
+#define LOG_ENABLED(Module, Level)	(LOG_LEVEL_##Module >= LOG_LEVEL_##Level)
+
+// UART baud rate, 8N1. 250000 baud is exact at 16MHz and sends about 4000
+// records per second.
+#ifndef EVENT_LOG_BAUD
+	#define EVENT_LOG_BAUD			250000
+#endif
+
+// Size in bytes of the record ring, must satisfy SPSC_RING_BUFFER_SIZE_VALID.
+#ifndef EVENT_LOG_RING_SIZE
+	#define EVENT_LOG_RING_SIZE		128
+#endif
+
+// First byte of every record, lets the decoder find the record boundaries
+// when it starts reading in the middle of the stream.
+#define EVENT_LOG_SYNC				0xA5
+
+// Bytes per record: sync, event ID, two little endian 16-bit arguments.
+#define EVENT_LOG_RECORD_SIZE		6
+
+#ifdef EVENT_LOG_ENABLED
+	#define LOG_EVENT(Module, Level, Name, Arg0, Arg1)					\
+		do																\
+		{																\
+			if (LOG_ENABLED(Module, Level))								\
+				EventLog_Write(EVENT_##Name, (Arg0), (Arg1));			\
+		} while (0)
+#else
+	#define LOG_EVENT(Module, Level, Name, Arg0, Arg1)	do { } while (0)
+#endif
+
+#define LOG_ERROR(Module, Name, Arg0, Arg1)	LOG_EVENT(Module, Error, Name, Arg0, Arg1)
+#define LOG_INFO(Module, Name, Arg0, Arg1)	LOG_EVENT(Module, Info, Name, Arg0, Arg1)
+#define LOG_DEBUG(Module, Name, Arg0, Arg1)	LOG_EVENT(Module, Debug, Name, Arg0, Arg1)
+
+// Type Defines:
+enum EventLog_Events_t
+{
+	#define EVENT_LOG_EVENT(Name, Format)	EVENT_##Name,
+	#include "EventLogEvents.h"
+	#undef EVENT_LOG_EVENT
+	EVENT_COUNT
+};
+
+#ifdef EVENT_LOG_ENABLED
+// Function Prototypes:
+// Sets up USART1 and starts sending the records logged so far.
+void EventLog_Init(void);
+// Appends a record, from any context. Records logged before EventLog_Init are
+// kept until it runs.
+void EventLog_Write(const uint8_t Event, const uint16_t Arg0, const uint16_t Arg1);
+#else
+static inline void EventLog_Init(void) {}
+#endif
+
+#endif
@@ -0,0 +1,26 @@
+// Events of the deferred debug log (EventLog.h), one EVENT_LOG_EVENT(Name,
+// Format) per event. The position in this list is the event ID sent on the
+// UART, so new events are only ever appended. Format is never compiled into
+// the firmware: Host/tools/event_log_decode.py parses this file and formats
+// the two 16-bit arguments of a record with Python str.format, {0} and {1}.
+//
+// No include guard, the file is included once per expansion of EVENT_LOG_EVENT.
+EVENT_LOG_EVENT(Dropped, "{0} records dropped, log full")
+EVENT_LOG_EVENT(Start, "firmware start, MCUSR {0:#04x}")
+EVENT_LOG_EVENT(LoopStart, "main loop start")
+EVENT_LOG_EVENT(USBInit, "USB_Init done")
+EVENT_LOG_EVENT(Connect, "USB connect")
+EVENT_LOG_EVENT(Disconnect, "USB disconnect")
+EVENT_LOG_EVENT(ConfigurationChanged, "USB configuration, success {0}")
+EVENT_LOG_EVENT(ControlRequest, "USB control request bRequest {0:#04x}, bmRequestType {1:#04x}")
+EVENT_LOG_EVENT(GetDescriptor, "USB get descriptor wValue {0:#06x}, wIndex {1:#06x}")
+EVENT_LOG_EVENT(VendorMode, "vendor mode {0}")
+EVENT_LOG_EVENT(EchoPacket, "echo {0} bytes, first byte {1:#04x}")
+EVENT_LOG_EVENT(EchoBytes, "echo {0} bytes in {1} packets from the receive ring")
+EVENT_LOG_EVENT(EchoMessage, "echo message {0} bytes, truncated {1}")
+EVENT_LOG_EVENT(CreateHIDReport, "create HID report ID {0}, LEDs {1:#04x}")
+EVENT_LOG_EVENT(ProcessHIDReport, "process HID report ID {0}, LEDs {1:#04x}")
+EVENT_LOG_EVENT(EndpointWaitError, "endpoint {1:#04x} wait error {0}")
+EVENT_LOG_EVENT(Suspend, "USB suspend")
+EVENT_LOG_EVENT(WakeUp, "USB wakeup")
+EVENT_LOG_EVENT(RemoteWakeup, "USB remote wakeup sent")
@@ -0,0 +1,48 @@
+#include "PerfCounters.h"
+
+PerfCounters_t PerfCounters;
+
+void PerfCounters_ProcessControlRequest(void)
+{
+	if ((USB_ControlRequest.bmRequestType & CONTROL_REQTYPE_TYPE) != REQTYPE_VENDOR)
+		return;
+
+	if ((USB_ControlRequest.bRequest == PERF_REQ_GetCounters) &&
+		(USB_ControlRequest.bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE)))
+	{
+		PerfCounters_GetCounters();
+	}
+	else if ((USB_ControlRequest.bRequest == PERF_REQ_ResetCounters) &&
+			 (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE)))
+	{
+		PerfCounters_ResetCounters();
+	}
+}
+
+void PerfCounters_GetCounters(void)
+{
+	PerfCounters_t Counters;
+
+	// The interrupt driven builds update the counters from the endpoint
+	// interrupt, which may preempt this one.
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+	Counters = PerfCounters;
+	SetGlobalInterruptMask(CurrentGlobalInt);
+	Counters.FrameNumber = USB_Device_GetFrameNumber();
+
+	Endpoint_ClearSETUP();
+	Endpoint_Write_Control_Stream_LE(&Counters, sizeof(Counters));
+	Endpoint_ClearOUT();
+}
+
+void PerfCounters_ResetCounters(void)
+{
+	Endpoint_ClearSETUP();
+	Endpoint_ClearStatusStage();
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+	memset(&PerfCounters, 0, sizeof(PerfCounters));
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
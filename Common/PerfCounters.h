@@ -0,0 +1,58 @@
+// Performance counters of the firmware data paths, read by the host with a
+// vendor control request (Host/tools/perf_counters.py).
+//
+// The counters are a fixed block in SRAM. Each counter is only ever updated
+// from one context, the main loop or the USB interrupt of the interrupt driven
+// builds, so the hot paths update them without disabling interrupts; only the
+// control request copying the block out does. Counters a firmware has no
+// source for stay zero. Define NO_PERF_COUNTERS to compile the updates out.
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+// Includes:
+#include <LUFA/Drivers/USB/USB.h>
+
+// Macros:
+// Vendor specific control requests (REQTYPE_VENDOR | REQREC_DEVICE).
+#define PERF_REQ_GetCounters		0x03 // Device to host: PerfCounters_t
+#define PERF_REQ_ResetCounters		0x04 // Host to device
+
+#ifdef NO_PERF_COUNTERS
+	#define PERF_COUNT(Counter)			do { } while (0)
+	#define PERF_ADD(Counter, Value)	do { } while (0)
+#else
+	#define PERF_COUNT(Counter)			(PerfCounters.Counter++)
+	#define PERF_ADD(Counter, Value)	(PerfCounters.Counter += (Value))
+#endif
+
+// Type Defines:
+// Counter block returned by PERF_REQ_GetCounters, little endian.
+typedef struct
+{
+	uint32_t MainLoopPasses; // Main loop iterations
+	uint32_t OUTPackets; // Packets read from the OUT data endpoint
+	uint32_t OUTBytes;
+	uint32_t INPackets; // Packets sent on the IN data endpoint
+	uint32_t INBytes;
+	uint32_t EndpointWaits; // Endpoint_WaitUntilReady calls that found the endpoint not ready
+	uint32_t WaitTimeouts; // ENDPOINT_READYWAIT_Timeout returned to the caller
+	uint32_t DisconnectedErrors; // Transfers refused or aborted with the device not configured, stalled or suspended
+	uint16_t FrameNumber; // USB frame number when the block was read, 1ms per frame
+	// Appended, hosts reading the shorter block above still get it.
+	uint32_t Suspends; // Bus suspends (Common/PowerSave.h)
+	uint32_t SuspendedSleeps; // Main loop sleeps while suspended, each ended by an interrupt
+	uint32_t IdleSleeps; // Main loop sleeps while configured with no work pending
+} ATTR_PACKED PerfCounters_t;
+
+// Global Variables:
+extern PerfCounters_t PerfCounters;
+
+// Function Prototypes:
+// Handles PERF_REQ_GetCounters and PERF_REQ_ResetCounters, call from
+// EVENT_USB_Device_ControlRequest. Other requests are left alone.
+void PerfCounters_ProcessControlRequest(void);
+// Request handlers for a firmware that dispatches its vendor requests itself.
+void PerfCounters_GetCounters(void);
+void PerfCounters_ResetCounters(void);
+
+#endif
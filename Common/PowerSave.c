@@ -0,0 +1,200 @@
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/delay.h>
+#include <LUFA/Drivers/Board/LEDs.h>
+#include "PowerSave.h"
+#include "PerfCounters.h"
+#include "CycleProbe.h"
+#include "EventLog.h"
+
+// Macros:
+#ifndef SUSPEND_SLEEP_MODE
+	#define SUSPEND_SLEEP_MODE		SLEEP_MODE_PWR_DOWN
+#endif
+
+// The UART only runs in IDLE, power-down would stop it in the middle of a record.
+#ifdef EVENT_LOG_ENABLED
+	#define POWERSAVE_SLEEP_MODE	SLEEP_MODE_IDLE
+#else
+	#define POWERSAVE_SLEEP_MODE	SUSPEND_SLEEP_MODE
+#endif
+
+// Bus idle time a device waits before it signals remote wakeup, 5ms (USB 2.0
+// 7.1.7.7), less the 3ms of idle bus before the suspend interrupt.
+#define REMOTE_WAKEUP_HOLDOFF_MS	2
+
+// Global Variables:
+// LEDs lit when the bus was suspended, lit again on wakeup.
+static uint8_t SuspendedLEDs;
+
+// Set once the remote wakeup was signalled in this suspend, the host then
+// resumes the bus in its own time.
+static volatile bool RemoteWakeupSent;
+
+// The builds with INTERRUPT_DATA_ENDPOINT have their own USB_COM_vect
+// (EndpointInterrupt.h), which ends the idle sleep as well.
+#if defined(IDLE_SLEEP) && !defined(INTERRUPT_CONTROL_ENDPOINT) && !defined(INTERRUPT_DATA_ENDPOINT)
+	#define POWERSAVE_ENDPOINT_WAKEUP
+#endif
+
+#if defined(POWERSAVE_ENDPOINT_WAKEUP) && defined(CYCLE_PROBES)
+// TCNT1 when the endpoint interrupt ended the idle sleep.
+static volatile uint16_t IdleWakeupTime;
+static volatile bool IdleWokenByEndpoint;
+#endif
+
+#ifdef POWERSAVE_ENDPOINT_WAKEUP
+// Armed only while the main loop sleeps idle: ends the sleep and disarms the
+// endpoint interrupts, the main loop handles the endpoints.
+ISR(USB_COM_vect)
+{
+	#ifdef CYCLE_PROBES
+	IdleWakeupTime = TCNT1;
+	IdleWokenByEndpoint = true;
+	#endif
+
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+
+	for (uint8_t Number = 0; Number < ENDPOINT_TOTAL_ENDPOINTS; Number++)
+	{
+		Endpoint_SelectEndpoint(Number);
+		UEIENX = 0;
+	}
+
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+}
+#endif
+
+void PowerSave_Suspend(void)
+{
+	LOG_INFO(USB, Suspend, 0, 0);
+	PERF_COUNT(Suspends);
+
+	RemoteWakeupSent = false;
+	SuspendedLEDs = LEDs_GetLEDs();
+	LEDs_SetAllLEDs(LEDS_NO_LEDS);
+}
+
+void PowerSave_WakeUp(void)
+{
+	LOG_INFO(USB, WakeUp, 0, 0);
+	CycleProbe_StartSpan(CYCLE_PROBE_ResumeToFirstPacket);
+
+	RemoteWakeupSent = false;
+	LEDs_SetAllLEDs(SuspendedLEDs);
+}
+
+void PowerSave_Task(const bool WakeHost)
+{
+	if (USB_DeviceState != DEVICE_STATE_Suspended)
+		return;
+
+	if (WakeHost && USB_Device_RemoteWakeupEnabled && !(RemoteWakeupSent))
+	{
+		RemoteWakeupSent = true;
+
+		// The suspend may have begun just now. A device that was suspended
+		// for longer only resumes the bus 2ms later. Waiting here is fine:
+		// the suspended bus has no Start Of Frame to count the time with,
+		// and the CPU and the bus have nothing else to do until the resume.
+		_delay_ms(REMOTE_WAKEUP_HOLDOFF_MS);
+
+		if (USB_DeviceState == DEVICE_STATE_Suspended)
+		{
+			LOG_INFO(USB, RemoteWakeup, 0, 0);
+			USB_Device_SendRemoteWakeup();
+		}
+		return;
+	}
+
+	#ifndef NO_SUSPEND_SLEEP
+	PERF_COUNT(SuspendedSleeps);
+	set_sleep_mode(POWERSAVE_SLEEP_MODE);
+
+	// The wakeup interrupt may have run since the check above. Check again
+	// with the interrupts disabled: the instruction after SEI, the SLEEP,
+	// always runs before a pending interrupt, so the wakeup is not missed.
+	GlobalInterruptDisable();
+	if (USB_DeviceState == DEVICE_STATE_Suspended)
+	{
+		sleep_enable();
+		GlobalInterruptEnable();
+		sleep_cpu();
+		sleep_disable();
+	}
+	GlobalInterruptEnable();
+	#endif
+}
+
+void PowerSave_IdleTask(bool (*const IsWorkPending)(void))
+{
+	#ifdef IDLE_SLEEP
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+		return;
+
+	// As in PowerSave_Task: an interrupt that makes work pending after the
+	// check either runs before it or ends the SLEEP. The armed endpoint
+	// interrupts fire as soon as they are enabled if their event is already
+	// there.
+	GlobalInterruptDisable();
+	if (IsWorkPending())
+	{
+		GlobalInterruptEnable();
+		return;
+	}
+
+	#ifdef POWERSAVE_ENDPOINT_WAKEUP
+	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+	UEIENX |= (1 << RXSTPE);
+	#endif
+
+	PERF_COUNT(IdleSleeps);
+	set_sleep_mode(SLEEP_MODE_IDLE);
+
+	#ifdef CYCLE_PROBES
+	// Timer1 overflows end the sleep too, see PowerSave.h.
+	TIMSK1 |= (1 << TOIE1);
+	uint16_t SleepStart = TCNT1;
+	#endif
+
+	sleep_enable();
+	GlobalInterruptEnable();
+	sleep_cpu();
+	sleep_disable();
+
+	#ifdef CYCLE_PROBES
+	GlobalInterruptDisable();
+	uint16_t SleepEnd = TCNT1;
+
+	CycleProbe_Record(CYCLE_PROBE_IdleSleep, SleepEnd - SleepStart);
+	#ifdef POWERSAVE_ENDPOINT_WAKEUP
+	if (IdleWokenByEndpoint)
+	{
+		CycleProbe_Record(CYCLE_PROBE_IdleWakeup, SleepEnd - IdleWakeupTime);
+		IdleWokenByEndpoint = false;
+	}
+	#endif
+
+	// An open span keeps counting the overflows.
+	if (CycleProbeSpan == CYCLE_PROBE_COUNT)
+		TIMSK1 &= ~(1 << TOIE1);
+	GlobalInterruptEnable();
+	#endif
+	#else
+	(void)IsWorkPending;
+	#endif
+}
+
+void PowerSave_WakeOnEndpoint(const uint8_t Address)
+{
+	#ifdef POWERSAVE_ENDPOINT_WAKEUP
+	Endpoint_SelectEndpoint(Address);
+
+	if ((Address & ENDPOINT_DIR_MASK) == ENDPOINT_DIR_IN)
+		UEIENX |= (1 << TXINE);
+	else
+		UEIENX |= (1 << RXOUTE);
+	#else
+	(void)Address;
+	#endif
+}
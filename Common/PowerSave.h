@@ -0,0 +1,75 @@
+// Sleep while the USB bus is suspended, shared by the firmwares.
+//
+// With USB_OPT_AUTO_PLL, LUFA freezes the USB clock and turns the PLL off when
+// the host suspends the bus, and turns both back on in the wakeup interrupt
+// before EVENT_USB_Device_WakeUp. The main loop would still spin at full clock
+// in between, so PowerSave_Task, called on every pass of it, puts the CPU to
+// sleep while the device is suspended. The USB wakeup interrupt ends the sleep
+// in every mode, set with the SUSPEND_SLEEP CMake option:
+//	PWR_DOWN = lowest current, the crystal oscillator restarts on wakeup, 16K
+//	clocks (1ms at 16MHz) with the Leonardo fuses.
+//	STANDBY = the oscillator keeps running and the CPU wakes in 6 clocks.
+//	IDLE = only the CPU clock stops.
+// Builds with the event log sleep in IDLE, so that the UART keeps sending the
+// log. Define NO_SUSPEND_SLEEP to keep the main loop running while suspended.
+//
+// A firmware that reports data to the host passes WakeHost to PowerSave_Task
+// when it has a report pending: if the host enabled remote wakeup, the device
+// then resumes the bus itself, once per suspend and only after the bus was
+// idle for the 5ms USB requires, and sleeps until the host resumes it. An
+// interrupt that marks a report pending wakes the CPU, so the report is seen.
+//
+// The LEDs are off while suspended. With CYCLE_PROBES, the
+// CYCLE_PROBE_ResumeToFirstPacket probe times the wakeup, from the wakeup
+// event to the first IN packet written after it.
+//
+// With IDLE_SLEEP defined, PowerSave_IdleTask also sleeps in IDLE while the
+// device is configured and the main loop has nothing to do. The firmware
+// passes its own check for pending work, which runs with the interrupts
+// disabled so that no interrupt is lost between the check and the SLEEP. The
+// check arms the interrupt of each data endpoint the loop waits on: a packet
+// received on an OUT endpoint, or a free bank on an IN endpoint. The SETUP
+// interrupt of the control endpoint is always armed. The USB endpoint
+// interrupt handler here only ends the sleep and disarms the interrupts, and
+// the loop then handles the packet as if it had never slept. The wakeup from
+// IDLE takes a few cycles, far less than one packet on the bus. Builds with
+// INTERRUPT_DATA_ENDPOINT service their data endpoints in their own endpoint
+// interrupt (EndpointInterrupt.h), which ends the sleep, and their check arms
+// nothing. Builds with INTERRUPT_CONTROL_ENDPOINT leave the endpoint
+// interrupt to LUFA and arm nothing either.
+//
+// With CYCLE_PROBES, CYCLE_PROBE_IdleSleep times each idle sleep and
+// CYCLE_PROBE_IdleWakeup the cycles from the endpoint interrupt to the main
+// loop running again, in the builds that poll their endpoints. Timer1
+// overflows then end the sleep too, so a sleep is timed in parts of at most
+// 65535 cycles, and the total of IdleSleep over the time elapsed is the share
+// of the time asleep.
+#ifndef POWERSAVE_H
+#define POWERSAVE_H
+
+// Includes:
+#include <LUFA/Drivers/USB/USB.h>
+
+// Function Prototypes:
+// Event handlers, call from EVENT_USB_Device_Suspend and EVENT_USB_Device_WakeUp.
+void PowerSave_Suspend(void);
+void PowerSave_WakeUp(void);
+
+// Sleeps until the next interrupt while the bus is suspended, or resumes the
+// bus if WakeHost and remote wakeup is enabled. Returns at once otherwise.
+// Main loop only.
+void PowerSave_Task(const bool WakeHost);
+
+// Sleeps in IDLE until the next interrupt if the device is configured and
+// IsWorkPending returns false, returns at once otherwise. IsWorkPending runs
+// with the interrupts disabled and, before it returns false, calls
+// PowerSave_WakeOnEndpoint for the endpoints the main loop waits on. Does
+// nothing without IDLE_SLEEP. Main loop only.
+void PowerSave_IdleTask(bool (*const IsWorkPending)(void));
+
+// Arms the interrupt of the endpoint at Address to end the idle sleep: a
+// packet received on an OUT endpoint, a free bank on an IN endpoint. Only
+// from the IsWorkPending check of PowerSave_IdleTask.
+void PowerSave_WakeOnEndpoint(const uint8_t Address);
+
+#endif
@@ -0,0 +1,94 @@
+// Lock-free single producer / single consumer byte ring buffer.
+//
+// One context (e.g. a USB interrupt) only ever inserts and another (e.g. the
+// main loop) only ever removes, so no interrupts need to be disabled on either
+// side. Each side only writes its own 8-bit index, which the AVR reads and
+// writes atomically, and the indices run freely and are masked on access.
+// Because of this the buffer size must be a power of two of at most 128 bytes.
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+// Includes:
+#include <stdint.h>
+#include <stdbool.h>
+
+// Macros:
+// Evaluates to true if Size can be used as the size of a SPSCRingBuffer_t.
+#define SPSC_RING_BUFFER_SIZE_VALID(Size)	(((Size) >= 2) && ((Size) <= 128) && (((Size) & ((Size) - 1)) == 0))
+
+// Keeps the compiler from moving buffer accesses across an index update.
+#define SPSC_RING_BUFFER_BARRIER()	__asm__ __volatile__ ("" ::: "memory")
+
+// Type Defines:
+typedef struct
+{
+	volatile uint8_t Head; // Insert index, only written by the producer
+	volatile uint8_t Tail; // Remove index, only written by the consumer
+	uint8_t Mask; // Size of the buffer minus one
+	uint8_t* Data; // Buffer storage
+} SPSCRingBuffer_t;
+
+// Inline Functions:
+// Initializes a ring buffer over DataPtr, Size must satisfy SPSC_RING_BUFFER_SIZE_VALID.
+static inline void SPSCRingBuffer_InitBuffer(SPSCRingBuffer_t* const Buffer, uint8_t* const DataPtr, const uint8_t Size)
+{
+	Buffer->Head = 0;
+	Buffer->Tail = 0;
+	Buffer->Mask = Size - 1;
+	Buffer->Data = DataPtr;
+}
+
+// Number of bytes stored in the buffer. Safe to call from either side, the
+// result is a lower bound for the consumer and an upper bound for the producer.
+static inline uint8_t SPSCRingBuffer_GetCount(const SPSCRingBuffer_t* const Buffer)
+{
+	return (uint8_t)(Buffer->Head - Buffer->Tail);
+}
+
+// Number of bytes that can be inserted before the buffer is full.
+static inline uint8_t SPSCRingBuffer_GetFreeCount(const SPSCRingBuffer_t* const Buffer)
+{
+	return (uint8_t)(Buffer->Mask + 1 - SPSCRingBuffer_GetCount(Buffer));
+}
+
+static inline bool SPSCRingBuffer_IsEmpty(const SPSCRingBuffer_t* const Buffer)
+{
+	return (Buffer->Head == Buffer->Tail);
+}
+
+static inline bool SPSCRingBuffer_IsFull(const SPSCRingBuffer_t* const Buffer)
+{
+	return (SPSCRingBuffer_GetCount(Buffer) > Buffer->Mask);
+}
+
+// Inserts a byte, producer side only. The caller must check that the buffer is
+// not full first.
+static inline void SPSCRingBuffer_Insert(SPSCRingBuffer_t* const Buffer, const uint8_t Data)
+{
+	uint8_t Head = Buffer->Head;
+
+	Buffer->Data[Head & Buffer->Mask] = Data;
+	SPSC_RING_BUFFER_BARRIER();
+	Buffer->Head = Head + 1;
+}
+
+// Returns the oldest byte without removing it, consumer side only. The caller
+// must check that the buffer is not empty first.
+static inline uint8_t SPSCRingBuffer_Peek(const SPSCRingBuffer_t* const Buffer)
+{
+	return Buffer->Data[Buffer->Tail & Buffer->Mask];
+}
+
+// Removes and returns the oldest byte, consumer side only. The caller must
+// check that the buffer is not empty first.
+static inline uint8_t SPSCRingBuffer_Remove(SPSCRingBuffer_t* const Buffer)
+{
+	uint8_t Tail = Buffer->Tail;
+	uint8_t Data = Buffer->Data[Tail & Buffer->Mask];
+
+	SPSC_RING_BUFFER_BARRIER();
+	Buffer->Tail = Tail + 1;
+	return Data;
+}
+
+#endif
@@ -0,0 +1,51 @@
+#include <avr/boot.h>
+#include "SerialNumber.h"
+
+// Type Defines:
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	wchar_t UnicodeString[SERIAL_NUMBER_LENGTH];
+} ATTR_PACKED SerialNumber_Descriptor_t;
+
+// Global Variables:
+static SerialNumber_Descriptor_t SerialNumberDescriptor;
+
+void SerialNumber_Init(void)
+{
+	uint8_t SigReadAddress = INTERNAL_SERIAL_START_ADDRESS;
+
+	SerialNumberDescriptor.Header.Size = sizeof(SerialNumberDescriptor);
+	SerialNumberDescriptor.Header.Type = DTYPE_String;
+
+	// Same digits as the LUFA internal serial: low nibble first. Called with
+	// the interrupts still disabled, so no flash write can be in progress.
+	for (uint8_t SerialCharNum = 0; SerialCharNum < SERIAL_NUMBER_LENGTH; SerialCharNum++)
+	{
+		uint8_t SerialByte = boot_signature_byte_get(SigReadAddress);
+
+		if (SerialCharNum & 0x01)
+		{
+			SerialByte >>= 4;
+			SigReadAddress++;
+		}
+
+		SerialByte &= 0x0F;
+		SerialNumberDescriptor.UnicodeString[SerialCharNum] =
+			cpu_to_le16((SerialByte >= 10) ? (('A' - 10) + SerialByte) : ('0' + SerialByte));
+	}
+}
+
+void SerialNumber_ProcessControlRequest(const uint8_t StringIndex)
+{
+	if ((USB_ControlRequest.bmRequestType != (REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE)) ||
+		(USB_ControlRequest.bRequest != REQ_GetDescriptor) ||
+		(USB_ControlRequest.wValue != ((DTYPE_String << 8) | StringIndex)))
+	{
+		return;
+	}
+
+	Endpoint_ClearSETUP();
+	Endpoint_Write_Control_Stream_LE(&SerialNumberDescriptor, sizeof(SerialNumberDescriptor));
+	Endpoint_ClearOUT();
+}
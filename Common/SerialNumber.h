@@ -0,0 +1,30 @@
+// USB serial number string built from the unique ID in the signature row.
+//
+// LUFA's internal serial (USE_INTERNAL_SERIAL) reads the signature row again
+// and converts it to hex on every request for the string. Here the string
+// descriptor is built once by SerialNumber_Init at startup and kept in SRAM,
+// so the request is answered with a copy, and every board keeps the serial it
+// had with the LUFA internal serial. The descriptors are in flash
+// (USE_FLASH_DESCRIPTORS), so CALLBACK_USB_GetDescriptor can not return the
+// SRAM copy: the project gives the serial its own string index in the device
+// descriptor and answers GET_DESCRIPTOR for it from the control request event
+// with SerialNumber_ProcessControlRequest.
+#ifndef SERIALNUMBER_H
+#define SERIALNUMBER_H
+
+// Includes:
+#include <LUFA/Drivers/USB/USB.h>
+
+// Macros:
+// Hex digits of the serial, one per nibble of the unique ID.
+#define SERIAL_NUMBER_LENGTH		(INTERNAL_SERIAL_LENGTH_BITS / 4)
+
+// Function Prototypes:
+// Builds the serial string descriptor, before the USB interrupts are enabled.
+void SerialNumber_Init(void);
+
+// Answers the GET_DESCRIPTOR request of string StringIndex in USB_ControlRequest
+// and leaves any other request unhandled.
+void SerialNumber_ProcessControlRequest(const uint8_t StringIndex);
+
+#endif
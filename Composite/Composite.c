@@ -0,0 +1,445 @@
+// Main source file for the Composite demo: a vendor bulk data pipe, a CDC ACM
+// console and a HID status interface on one device. Every function keeps the
+// transport that suits its traffic: the bulk pipe moves the data at full
+// bandwidth, the console takes interactive commands without a custom host
+// driver, and the HID interrupt endpoint reports status changes within a
+// frame. All three are serviced from one main loop with a single USB_USBTask.
+
+#include "Composite.h"
+#include "global.h"
+
+#if defined(INTERRUPT_DATA_ENDPOINT)
+	#error The composite demo services its endpoints from the main loop only
+#endif
+
+USB_EPInfo_Device_t Composite_Vendor_EPs =
+{
+	.DataINEPAddress = VENDOR_IN_EPADDR,
+	.DataOUTEPAddress = VENDOR_OUT_EPADDR,
+	.DataEPSize = VENDOR_IO_EPSIZE
+};
+
+// LUFA CDC Class driver interface configuration and state information of the
+// console.
+USB_ClassInfo_CDC_Device_t Composite_CDC_Interface =
+{
+	.Config =
+		{
+			.ControlInterfaceNumber = INTERFACE_ID_CDC_CCI,
+			.DataINEndpoint =
+				{
+					.Address = CDC_TX_EPADDR,
+					.Size = CDC_TXRX_EPSIZE,
+					.Banks = 1,
+				},
+			.DataOUTEndpoint =
+				{
+					.Address = CDC_RX_EPADDR,
+					.Size = CDC_TXRX_EPSIZE,
+					.Banks = 1,
+				},
+			.NotificationEndpoint =
+				{
+					.Address = CDC_NOTIFICATION_EPADDR,
+					.Size = CDC_NOTIFICATION_EPSIZE,
+					.Banks = 1,
+				},
+		},
+};
+
+// Last status report sent, the HID class driver sends a new one only when it
+// differs.
+static uint8_t PrevStatusReport[sizeof(Composite_StatusReport_t)];
+
+// LUFA HID Class driver interface configuration and state information of the
+// status interface.
+USB_ClassInfo_HID_Device_t Composite_HID_Interface =
+{
+	.Config =
+		{
+			.InterfaceNumber = INTERFACE_ID_HID,
+			.ReportINEndpoint =
+				{
+					.Address = HID_IN_EPADDR,
+					.Size = COMPOSITE_HID_EPSIZE,
+					.Banks = 1,
+				},
+			.PrevReportINBuffer = PrevStatusReport,
+			.PrevReportINBufferSize = sizeof(PrevStatusReport),
+		},
+};
+
+// Data path state changed by the vendor control requests and the console.
+static volatile uint8_t VendorMode = VENDOR_MODE_Echo;
+
+// Next byte sent in VENDOR_MODE_Source, the IN data is a running 8-bit count.
+static uint8_t VendorSourceByte;
+
+// LED flags last set by the host with the HID OUT report.
+static uint8_t StatusLEDs;
+
+// Console command line being received.
+static char ConsoleLine[CONSOLE_LINE_SIZE];
+static uint8_t ConsoleLineLength;
+
+static void Vendor_GetMode(void);
+static void Vendor_SetMode(void);
+
+// Vendor request dispatch table, searched by EVENT_USB_Device_ControlRequest.
+typedef struct
+{
+	uint8_t bmRequestType;
+	uint8_t bRequest;
+	void (*Handler)(void);
+} Vendor_Command_t;
+
+static const Vendor_Command_t VendorCommands[] PROGMEM =
+{
+	{REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE, VENDOR_REQ_GetMode, Vendor_GetMode},
+	{REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE, VENDOR_REQ_SetMode, Vendor_SetMode},
+};
+
+// Echo, sink or source on the vendor bulk pipe, as in the polled BulkVendor
+// build: up to one packet per bank per pass.
+static void Vendor_Task(void)
+{
+	uint16_t count = 0;
+	uint8_t ReceivedData[VENDOR_IO_EPSIZE];
+
+	for (uint8_t bank = 0; bank < VENDOR_EP_BANKS &&
+		 ((VendorMode != VENDOR_MODE_Echo) || Device_IsINReady(&Composite_Vendor_EPs)) &&
+		 (count = Device_Read_Block(&Composite_Vendor_EPs, ReceivedData, VENDOR_IO_EPSIZE)) > 0; bank++)
+	{
+		LOG_DEBUG(DATA, EchoPacket, count, ReceivedData[0]);
+		if (VendorMode == VENDOR_MODE_Echo)
+			Device_Write_Block(&Composite_Vendor_EPs, ReceivedData, count);
+	}
+
+	for (uint8_t bank = 0; bank < VENDOR_EP_BANKS && (VendorMode == VENDOR_MODE_Source) &&
+		 Device_IsINReady(&Composite_Vendor_EPs); bank++)
+	{
+		for (uint8_t i = 0; i < VENDOR_IO_EPSIZE; i++)
+			ReceivedData[i] = VendorSourceByte++;
+		Device_Write_Block(&Composite_Vendor_EPs, ReceivedData, VENDOR_IO_EPSIZE);
+	}
+}
+
+// Sends a string from flash to the console.
+static void Console_PrintP(const char* String)
+{
+	char c;
+
+	while ((c = pgm_read_byte(String++)))
+		CDC_Device_SendByte(&Composite_CDC_Interface, c);
+}
+
+// Runs a complete console command line:
+//	mode		prints the vendor pipe mode
+//	mode <n>	sets the vendor pipe mode, 0 echo, 1 sink, 2 source
+static void Console_ProcessLine(void)
+{
+	if ((ConsoleLineLength >= 4) && !(memcmp(ConsoleLine, "mode", 4)))
+	{
+		if (ConsoleLineLength == 6 && (ConsoleLine[4] == ' ') &&
+			(ConsoleLine[5] >= '0') && (ConsoleLine[5] <= ('0' + VENDOR_MODE_Source)))
+		{
+			VendorMode = (ConsoleLine[5] - '0');
+			LOG_INFO(USB, VendorMode, VendorMode, 0);
+		}
+		else if (ConsoleLineLength != 4)
+		{
+			Console_PrintP(PSTR("?\r\n"));
+			return;
+		}
+
+		Console_PrintP(PSTR("mode "));
+		CDC_Device_SendByte(&Composite_CDC_Interface, '0' + VendorMode);
+		Console_PrintP(PSTR("\r\n"));
+	}
+	else if (ConsoleLineLength)
+	{
+		Console_PrintP(PSTR("?\r\n"));
+	}
+}
+
+// Echoes the console input and runs each line once its end arrives.
+static void Console_Task(void)
+{
+	int16_t ReceivedByte;
+
+	while ((ReceivedByte = CDC_Device_ReceiveByte(&Composite_CDC_Interface)) >= 0)
+	{
+		if ((ReceivedByte == '\r') || (ReceivedByte == '\n'))
+		{
+			Console_PrintP(PSTR("\r\n"));
+			Console_ProcessLine();
+			ConsoleLineLength = 0;
+		}
+		else
+		{
+			CDC_Device_SendByte(&Composite_CDC_Interface, ReceivedByte);
+			if (ConsoleLineLength < sizeof(ConsoleLine))
+				ConsoleLine[ConsoleLineLength++] = ReceivedByte;
+		}
+	}
+}
+
+// Idle check of the main loop, run by PowerSave_IdleTask with the interrupts
+// disabled: true if the next pass has work for one of the three functions.
+// Otherwise arms the interrupts of the endpoints they wait on.
+static bool Composite_IsWorkPending(void)
+{
+	// Vendor pipe, as in Vendor_Task: the echo reads a packet only once an IN
+	// bank is free for it.
+	bool VendorINReady = Device_IsINReady(&Composite_Vendor_EPs);
+	Endpoint_SelectEndpoint(VENDOR_OUT_EPADDR);
+	bool VendorOUTReceived = Endpoint_IsOUTReceived();
+
+	if ((VendorOUTReceived && (VendorINReady || (VendorMode != VENDOR_MODE_Echo))) ||
+		((VendorMode == VENDOR_MODE_Source) && VendorINReady))
+	{
+		return true;
+	}
+
+	// Console input, and echoed bytes left in the IN bank for
+	// CDC_Device_USBTask. Nothing moves before the host opened the port.
+	bool ConsoleOpen = (Composite_CDC_Interface.State.LineEncoding.BaudRateBPS != 0);
+
+	if (ConsoleOpen)
+	{
+		Endpoint_SelectEndpoint(CDC_RX_EPADDR);
+		if (Endpoint_IsOUTReceived())
+			return true;
+
+		Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+		if (Endpoint_BytesInEndpoint())
+			return true;
+	}
+
+	// Status report, the class driver builds at most one per frame and the
+	// Start Of Frame interrupt ends the sleep for the next.
+	bool ReportDue = (Composite_HID_Interface.State.PrevFrameNum != USB_Device_GetFrameNumber());
+
+	if (ReportDue)
+	{
+		Endpoint_SelectEndpoint(HID_IN_EPADDR);
+		if (Endpoint_IsReadWriteAllowed())
+			return true;
+	}
+
+	if (VendorOUTReceived || (VendorMode == VENDOR_MODE_Source))
+		PowerSave_WakeOnEndpoint(VENDOR_IN_EPADDR);
+	if (!(VendorOUTReceived))
+		PowerSave_WakeOnEndpoint(VENDOR_OUT_EPADDR);
+	if (ConsoleOpen)
+		PowerSave_WakeOnEndpoint(CDC_RX_EPADDR);
+	if (ReportDue)
+		PowerSave_WakeOnEndpoint(HID_IN_EPADDR);
+
+	return false;
+}
+
+// Main program entry point. This routine configures the hardware required by
+// the application, then enters a loop to run the application tasks in sequence.
+int main(void)
+{
+	EventLog_Init();
+	LOG_INFO(USB, Start, MCUSR, 0);
+
+	SetupHardware();
+
+	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
+	GlobalInterruptEnable();
+
+	LOG_INFO(USB, LoopStart, 0, 0);
+	for (;;)
+	{
+		PERF_COUNT(MainLoopPasses);
+		PowerSave_Task(false);
+
+		Vendor_Task();
+		Console_Task();
+		CDC_Device_USBTask(&Composite_CDC_Interface);
+		HID_Device_USBTask(&Composite_HID_Interface);
+		USB_USBTask();
+
+		PowerSave_IdleTask(Composite_IsWorkPending);
+	}
+}
+
+// Configures the board hardware and chip peripherals for the demo's functionality.
+void SetupHardware(void)
+{
+	// Disable watchdog if enabled by bootloader/fuses
+	MCUSR &= ~(1 << WDRF);
+	wdt_disable();
+
+	// Disable clock division
+	clock_prescale_set(clock_div_1);
+
+	// Hardware Initialization
+	LEDs_Init();
+	CycleProbe_Init();
+	SerialNumber_Init();
+	USB_Init();
+	LOG_INFO(USB, USBInit, 0, 0);
+}
+
+// Event handler for the library USB Connection event.
+void EVENT_USB_Device_Connect(void)
+{
+	LOG_INFO(USB, Connect, 0, 0);
+	LEDs_SetAllLEDs(LEDMASK_USB_ENUMERATING);
+}
+
+// Event handler for the library USB Disconnect event.
+void EVENT_USB_Device_Disconnect(void)
+{
+	LOG_INFO(USB, Disconnect, 0, 0);
+	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
+}
+
+// Event handler for the library USB Suspend event.
+void EVENT_USB_Device_Suspend(void)
+{
+	PowerSave_Suspend();
+}
+
+// Event handler for the library USB Wake Up event.
+void EVENT_USB_Device_WakeUp(void)
+{
+	PowerSave_WakeUp();
+}
+
+// Event handler for the library USB Configuration Changed event. The endpoints
+// are configured in ascending number order, see Descriptors.h.
+void EVENT_USB_Device_ConfigurationChanged(void)
+{
+	bool ConfigSuccess = true;
+
+	ConfigSuccess &= Endpoint_ConfigureEndpoint(VENDOR_IN_EPADDR, EP_TYPE_BULK, VENDOR_IO_EPSIZE, VENDOR_EP_BANKS);
+	ConfigSuccess &= Endpoint_ConfigureEndpoint(VENDOR_OUT_EPADDR, EP_TYPE_BULK, VENDOR_IO_EPSIZE, VENDOR_EP_BANKS);
+	ConfigSuccess &= CDC_Device_ConfigureEndpoints(&Composite_CDC_Interface);
+	ConfigSuccess &= HID_Device_ConfigureEndpoints(&Composite_HID_Interface);
+
+	USB_Device_EnableSOFEvents();
+
+	// Every configuration starts out echoing, with an empty console line.
+	VendorMode = VENDOR_MODE_Echo;
+	ConsoleLineLength = 0;
+
+	LOG_INFO(USB, ConfigurationChanged, ConfigSuccess, 0);
+	LEDs_SetAllLEDs(ConfigSuccess ? LEDMASK_USB_READY : LEDMASK_USB_ERROR);
+}
+
+// Event handler for the library USB Control Request reception event. Each
+// class driver only takes the requests addressed to its own interface.
+void EVENT_USB_Device_ControlRequest(void)
+{
+	LOG_DEBUG(USB, ControlRequest, USB_ControlRequest.bRequest, USB_ControlRequest.bmRequestType);
+	PerfCounters_ProcessControlRequest();
+	CycleProbe_ProcessControlRequest();
+	SerialNumber_ProcessControlRequest(STRING_ID_Serial);
+	CDC_Device_ProcessControlRequest(&Composite_CDC_Interface);
+	HID_Device_ProcessControlRequest(&Composite_HID_Interface);
+
+	for (uint8_t i = 0; i < (sizeof(VendorCommands) / sizeof(VendorCommands[0])); i++)
+	{
+		if ((pgm_read_byte(&VendorCommands[i].bmRequestType) == USB_ControlRequest.bmRequestType) &&
+			(pgm_read_byte(&VendorCommands[i].bRequest) == USB_ControlRequest.bRequest))
+		{
+			void (*Handler)(void) = (void (*)(void))pgm_read_ptr(&VendorCommands[i].Handler);
+			Handler();
+			return;
+		}
+	}
+}
+
+// Vendor request handlers, called with the request in USB_ControlRequest. A
+// handler rejects a request by returning without clearing the SETUP packet,
+// the library then stalls it.
+static void Vendor_GetMode(void)
+{
+	uint8_t Mode = VendorMode;
+
+	Endpoint_ClearSETUP();
+	Endpoint_Write_Control_Stream_LE(&Mode, sizeof(Mode));
+	Endpoint_ClearOUT();
+}
+
+static void Vendor_SetMode(void)
+{
+	if (USB_ControlRequest.wValue > VENDOR_MODE_Source)
+		return;
+
+	Endpoint_ClearSETUP();
+	Endpoint_ClearStatusStage();
+
+	VendorMode = USB_ControlRequest.wValue;
+	LOG_INFO(USB, VendorMode, USB_ControlRequest.wValue, 0);
+}
+
+// Event handler for the USB device Start Of Frame event.
+void EVENT_USB_Device_StartOfFrame(void)
+{
+	HID_Device_MillisecondElapsed(&Composite_HID_Interface);
+}
+
+// HID class driver callback function for the creation of HID reports to the
+// host, see GenericHID.c. The status report is rebuilt on every call, the
+// driver compares it with the last one sent.
+bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+										 uint8_t* const ReportID,
+										 const uint8_t ReportType,
+										 void* ReportData,
+										 uint16_t* const ReportSize)
+{
+	Composite_StatusReport_t* Report = (Composite_StatusReport_t*)ReportData;
+
+	if (ReportType != HID_REPORT_ITEM_In)
+	{
+		*ReportSize = 0;
+		return false;
+	}
+
+	memset(Report, 0, sizeof(Composite_StatusReport_t));
+	Report->VendorMode = VendorMode;
+	Report->ConsoleLineState = Composite_CDC_Interface.State.ControlLineStates.HostToDevice;
+	Report->LEDs = StatusLEDs;
+
+	*ReportSize = sizeof(Composite_StatusReport_t);
+	return false;
+}
+
+// HID class driver callback function for the processing of HID reports from
+// the host, see GenericHID.c. The first byte of the OUT report holds the LED
+// flags, bit 0 for LED1 to bit 3 for LED4.
+void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+										  const uint8_t ReportID,
+										  const uint8_t ReportType,
+										  const void* ReportData,
+										  const uint16_t ReportSize)
+{
+	const uint8_t* Data = (const uint8_t*)ReportData;
+	uint8_t NewLEDMask = LEDS_NO_LEDS;
+
+	if ((ReportType != HID_REPORT_ITEM_Out) || !(ReportSize))
+		return;
+
+	StatusLEDs = (Data[0] & 0x0F);
+
+	if (StatusLEDs & (1 << 0))
+		NewLEDMask |= LEDS_LED1;
+
+	if (StatusLEDs & (1 << 1))
+		NewLEDMask |= LEDS_LED2;
+
+	if (StatusLEDs & (1 << 2))
+		NewLEDMask |= LEDS_LED3;
+
+	if (StatusLEDs & (1 << 3))
+		NewLEDMask |= LEDS_LED4;
+
+	LEDs_SetAllLEDs(NewLEDMask);
+	LOG_DEBUG(DATA, ProcessHIDReport, ReportID, NewLEDMask);
+}
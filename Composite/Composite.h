@@ -0,0 +1,91 @@
+#ifndef COMPOSITE_H
+#define COMPOSITE_H
+
+// Includes:
+#include <avr/io.h>
+#include <avr/wdt.h>
+#include <avr/power.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <string.h>
+
+#include "Descriptors.h"
+#include "LufaUtil.h"
+#include "PerfCounters.h"
+#include "PowerSave.h"
+#include "SerialNumber.h"
+#include "CycleProbe.h"
+#include "EventLog.h"
+
+#include <LUFA/Drivers/USB/USB.h>
+#include <LUFA/Drivers/Board/LEDs.h>
+#include <LUFA/Platform/Platform.h>
+
+// Macros:
+// LED mask for the library LED driver, to indicate that the USB interface is not ready
+#define LEDMASK_USB_NOTREADY	LEDS_LED1
+
+// LED mask for the library LED driver, to indicate that the USB interface is enumerating.
+#define LEDMASK_USB_ENUMERATING	(LEDS_LED2 | LEDS_LED3)
+
+// LED mask for the library LED driver, to indicate that the USB interface is ready.
+#define LEDMASK_USB_READY	(LEDS_LED2 | LEDS_LED4)
+
+// LED mask for the library LED driver, to indicate that an error has occurred in the USB interface.
+#define LEDMASK_USB_ERROR	(LEDS_LED1 | LEDS_LED3)
+
+// Longest console command line, longer lines are truncated.
+#define CONSOLE_LINE_SIZE	16
+
+// Type Defines:
+// Vendor specific control requests (REQTYPE_VENDOR | REQREC_DEVICE), the
+// BulkVendor codes so that its host tools work unchanged on the vendor pipe.
+// PERF_REQ_* and CYCLE_REQ_* are served by the common modules.
+enum Vendor_Requests_t
+{
+	VENDOR_REQ_GetMode = 0x01, // Device to host, 1 byte: the current Vendor_Modes_t
+	VENDOR_REQ_SetMode = 0x02, // Host to device, wValue: the new Vendor_Modes_t
+};
+
+// What the firmware does with the vendor bulk endpoints.
+enum Vendor_Modes_t
+{
+	VENDOR_MODE_Echo = 0, // Send back everything received, the default
+	VENDOR_MODE_Sink = 1, // Discard everything received
+	VENDOR_MODE_Source = 2, // Discard everything received and keep the IN endpoint full
+};
+
+// HID status IN report, COMPOSITE_HID_REPORT_SIZE bytes. It is sent whenever
+// one of the fields changes, so the host sees a mode change or the console
+// being opened within a frame without polling the control endpoint.
+typedef struct
+{
+	uint8_t VendorMode; // Vendor_Modes_t of the bulk pipe
+	uint8_t ConsoleLineState; // CDC_CONTROL_LINE_OUT_* set by the host terminal
+	uint8_t LEDs; // LED flags last set with the HID OUT report
+	uint8_t Reserved[COMPOSITE_HID_REPORT_SIZE - 3];
+} ATTR_PACKED Composite_StatusReport_t;
+
+// Function Prototypes:
+void SetupHardware(void);
+
+void EVENT_USB_Device_Connect(void);
+void EVENT_USB_Device_Disconnect(void);
+void EVENT_USB_Device_Suspend(void);
+void EVENT_USB_Device_WakeUp(void);
+void EVENT_USB_Device_ConfigurationChanged(void);
+void EVENT_USB_Device_ControlRequest(void);
+void EVENT_USB_Device_StartOfFrame(void);
+
+bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+										 uint8_t* const ReportID,
+										 const uint8_t ReportType,
+										 void* ReportData,
+										 uint16_t* const ReportSize);
+void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+										  const uint8_t ReportID,
+										  const uint8_t ReportType,
+										  const void* ReportData,
+										  const uint16_t ReportSize);
+
+#endif
@@ -0,0 +1,296 @@
+// USB Device Descriptors, for library use when in USB device mode. Descriptors
+// are special computer-readable structures which the host requests upon device
+// enumeration, to determine the device's capabilities and functions.
+#include "Descriptors.h"
+#include "global.h"
+#include "DescriptorTable.h"
+
+// HID class descriptor of the status interface, a vendor report of
+// COMPOSITE_HID_REPORT_SIZE bytes in each direction: status IN (usage 2),
+// LED flags OUT (usage 3).
+const USB_Descriptor_HIDReport_Datatype_t PROGMEM StatusReport[] =
+{
+	HID_DESCRIPTOR_VENDOR(0x00, 0x01, 0x02, 0x03, COMPOSITE_HID_REPORT_SIZE)
+};
+
+// Device descriptor structure. This descriptor, located in FLASH memory,
+// describes the overall device characteristics, including the supported USB
+// version, control endpoint size and the number of device configurations.
+// The device class tells the host that the configuration contains interface
+// associations, so that it binds the two CDC interfaces as one function.
+const USB_Descriptor_Device_t PROGMEM DeviceDescriptor =
+{
+	.Header = {.Size = sizeof(USB_Descriptor_Device_t), .Type = DTYPE_Device},
+
+	.USBSpecification = VERSION_BCD(1,1,0),
+	.Class = USB_CSCP_IADDeviceClass,
+	.SubClass = USB_CSCP_IADDeviceSubclass,
+	.Protocol = USB_CSCP_IADDeviceProtocol,
+
+	.Endpoint0Size = FIXED_CONTROL_ENDPOINT_SIZE,
+
+	.VendorID = 0x03EB,
+	.ProductID = 0x2070,
+	.ReleaseNumber = VERSION_BCD(0,0,1),
+
+	.ManufacturerStrIndex = STRING_ID_Manufacturer,
+	.ProductStrIndex = STRING_ID_Product,
+	.SerialNumStrIndex = STRING_ID_Serial,
+
+	.NumberOfConfigurations = FIXED_NUM_CONFIGURATIONS
+};
+
+// Configuration descriptor structure. This descriptor, located in FLASH memory,
+// describes the usage of the device in one of its supported configurations,
+// including information about any device interfaces and endpoints. The
+// descriptor is read out by the USB host during the enumeration process when
+// selecting a configuration so that the host may correctly communicate with
+// the USB device.
+const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
+{
+	.Config =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Configuration_Header_t), .Type = DTYPE_Configuration},
+
+			.TotalConfigurationSize = sizeof(USB_Descriptor_Configuration_t),
+			.TotalInterfaces = INTERFACE_COUNT,
+
+			.ConfigurationNumber = 1,
+			.ConfigurationStrIndex = NO_DESCRIPTOR,
+
+			.ConfigAttributes = (USB_CONFIG_ATTR_RESERVED | USB_CONFIG_ATTR_SELFPOWERED),
+			.MaxPowerConsumption = USB_CONFIG_POWER_MA(100)
+		},
+
+	.Vendor_Interface =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber = INTERFACE_ID_Vendor,
+			.AlternateSetting = 0,
+
+			.TotalEndpoints = 2,
+
+			.Class = 0xFF,
+			.SubClass = 0xFF,
+			.Protocol = 0xFF,
+
+			.InterfaceStrIndex = NO_DESCRIPTOR
+		},
+
+	.Vendor_DataInEndpoint =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+			.EndpointAddress = VENDOR_IN_EPADDR,
+			.Attributes = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize = VENDOR_IO_EPSIZE,
+			.PollingIntervalMS = 0x05
+		},
+
+	.Vendor_DataOutEndpoint =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+			.EndpointAddress = VENDOR_OUT_EPADDR,
+			.Attributes = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize = VENDOR_IO_EPSIZE,
+			.PollingIntervalMS = 0x05
+		},
+
+	.CDC_IAD =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Interface_Association_t), .Type = DTYPE_InterfaceAssociation},
+
+			.FirstInterfaceIndex = INTERFACE_ID_CDC_CCI,
+			.TotalInterfaces = 2,
+
+			.Class = CDC_CSCP_CDCClass,
+			.SubClass = CDC_CSCP_ACMSubclass,
+			.Protocol = CDC_CSCP_ATCommandProtocol,
+
+			.IADStrIndex = STRING_ID_Console
+		},
+
+	.CDC_CCI_Interface =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber = INTERFACE_ID_CDC_CCI,
+			.AlternateSetting = 0,
+
+			.TotalEndpoints = 1,
+
+			.Class = CDC_CSCP_CDCClass,
+			.SubClass = CDC_CSCP_ACMSubclass,
+			.Protocol = CDC_CSCP_ATCommandProtocol,
+
+			.InterfaceStrIndex = STRING_ID_Console
+		},
+
+	.CDC_Functional_Header =
+		{
+			.Header = {.Size = sizeof(USB_CDC_Descriptor_FunctionalHeader_t), .Type = DTYPE_CSInterface},
+			.Subtype = CDC_DSUBTYPE_CSInterface_Header,
+
+			.CDCSpecification = VERSION_BCD(1,1,0),
+		},
+
+	.CDC_Functional_ACM =
+		{
+			.Header = {.Size = sizeof(USB_CDC_Descriptor_FunctionalACM_t), .Type = DTYPE_CSInterface},
+			.Subtype = CDC_DSUBTYPE_CSInterface_ACM,
+
+			.Capabilities = 0x06,
+		},
+
+	.CDC_Functional_Union =
+		{
+			.Header = {.Size = sizeof(USB_CDC_Descriptor_FunctionalUnion_t), .Type = DTYPE_CSInterface},
+			.Subtype = CDC_DSUBTYPE_CSInterface_Union,
+
+			.MasterInterfaceNumber = INTERFACE_ID_CDC_CCI,
+			.SlaveInterfaceNumber = INTERFACE_ID_CDC_DCI,
+		},
+
+	.CDC_NotificationEndpoint =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+			.EndpointAddress = CDC_NOTIFICATION_EPADDR,
+			.Attributes = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize = CDC_NOTIFICATION_EPSIZE,
+			.PollingIntervalMS = 0xFF
+		},
+
+	.CDC_DCI_Interface =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber = INTERFACE_ID_CDC_DCI,
+			.AlternateSetting = 0,
+
+			.TotalEndpoints = 2,
+
+			.Class = CDC_CSCP_CDCDataClass,
+			.SubClass = CDC_CSCP_NoDataSubclass,
+			.Protocol = CDC_CSCP_NoDataProtocol,
+
+			.InterfaceStrIndex = NO_DESCRIPTOR
+		},
+
+	.CDC_DataInEndpoint =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+			.EndpointAddress = CDC_TX_EPADDR,
+			.Attributes = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize = CDC_TXRX_EPSIZE,
+			.PollingIntervalMS = 0x05
+		},
+
+	.CDC_DataOutEndpoint =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+			.EndpointAddress = CDC_RX_EPADDR,
+			.Attributes = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize = CDC_TXRX_EPSIZE,
+			.PollingIntervalMS = 0x05
+		},
+
+	.HID_Interface =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber = INTERFACE_ID_HID,
+			.AlternateSetting = 0x00,
+
+			.TotalEndpoints = 1,
+
+			.Class = HID_CSCP_HIDClass,
+			.SubClass = HID_CSCP_NonBootSubclass,
+			.Protocol = HID_CSCP_NonBootProtocol,
+
+			.InterfaceStrIndex = NO_DESCRIPTOR
+		},
+
+	.HID_StatusHID =
+		{
+			.Header = {.Size = sizeof(USB_HID_Descriptor_HID_t), .Type = HID_DTYPE_HID},
+
+			.HIDSpec = VERSION_BCD(1,1,1),
+			.CountryCode = 0x00,
+			.TotalReportDescriptors = 1,
+			.HIDReportType = HID_DTYPE_Report,
+			.HIDReportLength = sizeof(StatusReport)
+		},
+
+	.HID_ReportINEndpoint =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+			.EndpointAddress = HID_IN_EPADDR,
+			.Attributes = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize = COMPOSITE_HID_EPSIZE,
+			.PollingIntervalMS = COMPOSITE_HID_POLLING_INTERVAL_MS
+		},
+};
+
+// Language descriptor structure. This descriptor, located in FLASH memory, is
+// returned when the host requests the string descriptor with index 0 (the first
+// index). It is actually an array of 16-bit integers, which indicate via the
+// language ID table available at USB.org what languages the device supports
+// for its string descriptors.
+const USB_Descriptor_String_t PROGMEM LanguageString = USB_STRING_DESCRIPTOR_ARRAY(LANGUAGE_ID_ENG);
+
+// Manufacturer descriptor string. This is a Unicode string containing the
+// manufacturer's details in human readable form, and is read out upon request
+// by the host when the appropriate string ID is requested, listed in the
+// Device Descriptor.
+const USB_Descriptor_String_t PROGMEM ManufacturerString = USB_STRING_DESCRIPTOR(L"Dean Camera");
+
+// Product descriptor string. This is a Unicode string containing the product's
+// details in human readable form, and is read out upon request by the host
+// when the appropriate string ID is requested, listed in the Device Descriptor.
+const USB_Descriptor_String_t PROGMEM ProductString = USB_STRING_DESCRIPTOR(L"LUFA Composite Demo");
+
+// Name of the CDC console function, shown by the host for the serial port.
+const USB_Descriptor_String_t PROGMEM ConsoleString = USB_STRING_DESCRIPTOR(L"LUFA Composite Console");
+
+// Descriptor table searched by CALLBACK_USB_GetDescriptor (DescriptorTable.h),
+// each entry array indexed by the descriptor index of its type.
+static const DescriptorTable_Entry_t PROGMEM DeviceDescriptors[] = {DESCRIPTOR_ENTRY(DeviceDescriptor)};
+static const DescriptorTable_Entry_t PROGMEM ConfigurationDescriptors[] = {DESCRIPTOR_ENTRY(ConfigurationDescriptor)};
+static const DescriptorTable_Entry_t PROGMEM StringDescriptors[] =
+{
+	[STRING_ID_Language] = DESCRIPTOR_STRING_ENTRY(LanguageString),
+	[STRING_ID_Manufacturer] = DESCRIPTOR_STRING_ENTRY(ManufacturerString),
+	[STRING_ID_Product] = DESCRIPTOR_STRING_ENTRY(ProductString),
+	[STRING_ID_Console] = DESCRIPTOR_STRING_ENTRY(ConsoleString),
+};
+// The HID class descriptors are requested from the HID interface only
+static const DescriptorTable_Entry_t PROGMEM HIDDescriptors[] = {DESCRIPTOR_ENTRY(ConfigurationDescriptor.HID_StatusHID)};
+static const DescriptorTable_Entry_t PROGMEM HIDReportDescriptors[] = {DESCRIPTOR_ENTRY(StatusReport)};
+
+static const DescriptorTable_Row_t PROGMEM Descriptors[] =
+{
+	DESCRIPTOR_ROW(DTYPE_Device, DESCRIPTOR_ANY_INTERFACE, DeviceDescriptors),
+	DESCRIPTOR_ROW(DTYPE_Configuration, DESCRIPTOR_ANY_INTERFACE, ConfigurationDescriptors),
+	DESCRIPTOR_ROW(DTYPE_String, DESCRIPTOR_ANY_INTERFACE, StringDescriptors),
+	DESCRIPTOR_ROW(HID_DTYPE_HID, INTERFACE_ID_HID, HIDDescriptors),
+	DESCRIPTOR_ROW(HID_DTYPE_Report, INTERFACE_ID_HID, HIDReportDescriptors),
+};
+
+// This function is called by the library when in device mode, and must be
+// overridden (see library "USB Descriptors" documentation) by the application
+// code so that the address and size of a requested descriptor can be given
+// to the USB library. When the device receives a Get Descriptor request on the
+// control endpoint, this function is called so that the descriptor details can
+// be passed back and the appropriate descriptor sent back to the USB host.
+uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
+									const uint8_t wIndex,
+									const void** const DescriptorAddress)
+{
+	return DESCRIPTOR_TABLE_LOOKUP(Descriptors, wValue, wIndex, DescriptorAddress);
+}
@@ -0,0 +1,122 @@
+#ifndef DESCRIPTORS_H
+#define DESCRIPTORS_H
+
+// Includes:
+#include <avr/pgmspace.h>
+#include <LUFA/Drivers/USB/USB.h>
+
+// Macros:
+// Endpoint map. The ATmega32U4 has six endpoints besides the control
+// endpoint and the composite device uses all of them, numbered in the order
+// they are configured (the controller allocates the endpoint memory in
+// ascending endpoint number order).
+//	EP1 IN, EP2 OUT: vendor bulk data pipe, double banked
+//	EP3 IN: CDC console notifications
+//	EP4 IN, EP5 OUT: CDC console data
+//	EP6 IN: HID status reports
+#define VENDOR_IN_EPADDR				(ENDPOINT_DIR_IN | 1)
+#define VENDOR_OUT_EPADDR				(ENDPOINT_DIR_OUT | 2)
+#define CDC_NOTIFICATION_EPADDR			(ENDPOINT_DIR_IN | 3)
+#define CDC_TX_EPADDR					(ENDPOINT_DIR_IN | 4)
+#define CDC_RX_EPADDR					(ENDPOINT_DIR_OUT | 5)
+#define HID_IN_EPADDR					(ENDPOINT_DIR_IN | 6)
+
+// Size in bytes and number of banks of the vendor bulk endpoints.
+#define VENDOR_IO_EPSIZE				64
+#ifndef VENDOR_EP_BANKS
+	#define VENDOR_EP_BANKS				2
+#endif
+
+// Size in bytes of the CDC notification endpoint, and of the CDC data
+// endpoints. The console is interactive, single banked packets of 16 bytes
+// are plenty and leave the endpoint memory to the bulk pipe.
+#define CDC_NOTIFICATION_EPSIZE			8
+#define CDC_TXRX_EPSIZE					16
+
+// Size in bytes of the HID status endpoint and its report, and its polling
+// interval. The host polls it every frame, a status change reaches the host
+// within one millisecond.
+#define COMPOSITE_HID_EPSIZE			8
+#define COMPOSITE_HID_REPORT_SIZE		8
+#define COMPOSITE_HID_POLLING_INTERVAL_MS	1
+
+// Endpoint memory (DPRAM) of the ATmega32U4 in bytes, shared by the control
+// endpoint and every bank of every data endpoint.
+#define COMPOSITE_DPRAM_SIZE			832
+#define COMPOSITE_DPRAM_USED			(FIXED_CONTROL_ENDPOINT_SIZE +					\
+										 (2 * VENDOR_IO_EPSIZE * VENDOR_EP_BANKS) +		\
+										 CDC_NOTIFICATION_EPSIZE +						\
+										 (2 * CDC_TXRX_EPSIZE) +							\
+										 COMPOSITE_HID_EPSIZE)
+
+#if (COMPOSITE_DPRAM_USED > COMPOSITE_DPRAM_SIZE)
+	#error The composite device endpoints do not fit into the endpoint memory
+#endif
+
+#if (COMPOSITE_HID_REPORT_SIZE > COMPOSITE_HID_EPSIZE)
+	#error COMPOSITE_HID_REPORT_SIZE must fit into one HID endpoint packet
+#endif
+
+// Type Defines:
+// Type define for the device configuration descriptor structure. This must be
+// defined in the application code, as the configuration descriptor contains
+// several sub-descriptors which vary between devices, and which describe the
+// device's usage to the host.
+typedef struct
+{
+	USB_Descriptor_Configuration_Header_t Config;
+
+	// Vendor Bulk Interface
+	USB_Descriptor_Interface_t Vendor_Interface;
+	USB_Descriptor_Endpoint_t Vendor_DataInEndpoint;
+	USB_Descriptor_Endpoint_t Vendor_DataOutEndpoint;
+
+	// CDC Console, the association groups the two CDC interfaces into one
+	// function for the host
+	USB_Descriptor_Interface_Association_t CDC_IAD;
+	USB_Descriptor_Interface_t CDC_CCI_Interface;
+	USB_CDC_Descriptor_FunctionalHeader_t CDC_Functional_Header;
+	USB_CDC_Descriptor_FunctionalACM_t CDC_Functional_ACM;
+	USB_CDC_Descriptor_FunctionalUnion_t CDC_Functional_Union;
+	USB_Descriptor_Endpoint_t CDC_NotificationEndpoint;
+	USB_Descriptor_Interface_t CDC_DCI_Interface;
+	USB_Descriptor_Endpoint_t CDC_DataInEndpoint;
+	USB_Descriptor_Endpoint_t CDC_DataOutEndpoint;
+
+	// HID Status Interface
+	USB_Descriptor_Interface_t HID_Interface;
+	USB_HID_Descriptor_HID_t HID_StatusHID;
+	USB_Descriptor_Endpoint_t HID_ReportINEndpoint;
+} USB_Descriptor_Configuration_t;
+
+// Enum for the device interface descriptor IDs within the device. Each interface
+// descriptor should have a unique ID index associated with it, which can be
+// used to refer to the interface from other descriptors.
+enum InterfaceDescriptors_t
+{
+	INTERFACE_ID_Vendor = 0, // Vendor bulk interface descriptor ID
+	INTERFACE_ID_CDC_CCI = 1, // CDC CCI interface descriptor ID
+	INTERFACE_ID_CDC_DCI = 2, // CDC DCI interface descriptor ID
+	INTERFACE_ID_HID = 3, // HID status interface descriptor ID
+	INTERFACE_COUNT
+};
+
+// Enum for the device string descriptor IDs within the device. Each string
+// descriptor should have a unique ID index associated with it, which can be
+// used to refer to the string from other descriptors.
+enum StringDescriptors_t
+{
+	STRING_ID_Language = 0, // Supported Languages string descriptor ID (must be zero)
+	STRING_ID_Manufacturer = 1, // Manufacturer string ID
+	STRING_ID_Product = 2, // Product string ID
+	STRING_ID_Console = 3, // CDC console function string ID
+	STRING_ID_Serial = 4, // Serial number string ID, answered from SRAM (Common/SerialNumber.h)
+};
+
+// Function Prototypes:
+uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
+									const uint8_t wIndex,
+									const void** const DescriptorAddress)
+									ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(3);
+
+#endif
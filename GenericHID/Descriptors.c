@@ -3,7 +3,7 @@
 // enumeration, to determine the device's capabilities and functions.
 #include "Descriptors.h"
 #include "global.h"
-#include "rprintf.h"
+#include "DescriptorTable.h"
 
 // HID class descriptor. This is a special descriptor constructed with values
 // from the USBIF HID class specification to describe the reports and capabilities
@@ -13,13 +13,68 @@
 // for more details on HID report descriptors.
 const USB_Descriptor_HIDReport_Datatype_t PROGMEM GenericReport[] =
 {
-	// Use the HID class driver's standard Vendor HID report.
+	#ifdef GENERIC_REPORT_IDS
+	// Vendor report with one report ID per block of data, so that each block
+	// is only sent when it changes. Usages 2 to 6 are the status IN, status
+	// OUT, sensor, counters and configuration data.
+	HID_RI_USAGE_PAGE(16, 0xFF00),
+	HID_RI_USAGE(8, 0x01),
+	HID_RI_COLLECTION(8, 0x01),
+		HID_RI_LOGICAL_MINIMUM(8, 0x00),
+		HID_RI_LOGICAL_MAXIMUM(8, 0xFF),
+		HID_RI_REPORT_SIZE(8, 0x08),
+
+		HID_RI_REPORT_ID(8, GENERIC_REPORT_ID_Status),
+		HID_RI_USAGE(8, 0x02),
+		HID_RI_REPORT_COUNT(8, GENERIC_STATUS_REPORT_SIZE),
+		HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+		HID_RI_USAGE(8, 0x03),
+		HID_RI_REPORT_COUNT(8, GENERIC_STATUS_REPORT_SIZE),
+		HID_RI_OUTPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE | HID_IOF_NON_VOLATILE),
+
+		HID_RI_REPORT_ID(8, GENERIC_REPORT_ID_Sensor),
+		HID_RI_USAGE(8, 0x04),
+		HID_RI_REPORT_COUNT(8, GENERIC_SENSOR_REPORT_SIZE),
+		HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+
+		HID_RI_REPORT_ID(8, GENERIC_REPORT_ID_Counters),
+		HID_RI_USAGE(8, 0x05),
+		HID_RI_REPORT_COUNT(8, GENERIC_COUNTERS_REPORT_SIZE),
+		HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+
+		HID_RI_REPORT_ID(8, GENERIC_REPORT_ID_Config),
+		HID_RI_USAGE(8, 0x06),
+		HID_RI_REPORT_COUNT(8, GENERIC_CONFIG_REPORT_SIZE),
+		HID_RI_FEATURE(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE | HID_IOF_NON_VOLATILE),
+	HID_RI_END_COLLECTION(0)
+	#else
+	// The HID class driver's standard Vendor HID report, plus a feature report
+	// for the configuration block.
 	// Vendor Usage Page: 0
 	// Vendor Collection Usage: 1
 	// Vendor Report IN Usage: 2
 	// Vendor Report OUT Usage: 3
+	// Vendor Report Feature Usage: 6
 	// Vendor Report Size: GENERIC_REPORT_SIZE
-	HID_DESCRIPTOR_VENDOR(0x00, 0x01, 0x02, 0x03, GENERIC_REPORT_SIZE)
+	HID_RI_USAGE_PAGE(16, 0xFF00),
+	HID_RI_USAGE(8, 0x01),
+	HID_RI_COLLECTION(8, 0x01),
+		HID_RI_LOGICAL_MINIMUM(8, 0x00),
+		HID_RI_LOGICAL_MAXIMUM(8, 0xFF),
+		HID_RI_REPORT_SIZE(8, 0x08),
+
+		HID_RI_USAGE(8, 0x02),
+		HID_RI_REPORT_COUNT(8, GENERIC_REPORT_SIZE),
+		HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+		HID_RI_USAGE(8, 0x03),
+		HID_RI_REPORT_COUNT(8, GENERIC_REPORT_SIZE),
+		HID_RI_OUTPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE | HID_IOF_NON_VOLATILE),
+
+		HID_RI_USAGE(8, 0x06),
+		HID_RI_REPORT_COUNT(8, GENERIC_CONFIG_REPORT_SIZE),
+		HID_RI_FEATURE(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE | HID_IOF_NON_VOLATILE),
+	HID_RI_END_COLLECTION(0)
+	#endif
 };
 
 // Device descriptor structure. This descriptor, located in FLASH memory,
@@ -66,7 +121,12 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 			.ConfigurationNumber = 1,
 			.ConfigurationStrIndex = NO_DESCRIPTOR,
 
+			// Remote wakeup only with a wake source, see Generic_HasReportPending
+			#ifdef GENERIC_WAKE_BUTTON
+			.ConfigAttributes = (USB_CONFIG_ATTR_RESERVED | USB_CONFIG_ATTR_SELFPOWERED | USB_CONFIG_ATTR_REMOTEWAKEUP),
+			#else
 			.ConfigAttributes = (USB_CONFIG_ATTR_RESERVED | USB_CONFIG_ATTR_SELFPOWERED),
+			#endif
 			.MaxPowerConsumption = USB_CONFIG_POWER_MA(100)
 		},
 
@@ -77,7 +137,11 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 			.InterfaceNumber = INTERFACE_ID_GenericHID,
 			.AlternateSetting = 0x00,
 
+			#ifdef GENERIC_HIGH_RATE
+			.TotalEndpoints = 2,
+			#else
 			.TotalEndpoints = 1,
+			#endif
 
 			.Class = HID_CSCP_HIDClass,
 			.SubClass = HID_CSCP_NonBootSubclass,
@@ -104,8 +168,20 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 			.EndpointAddress = GENERIC_IN_EPADDR,
 			.Attributes = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
 			.EndpointSize = GENERIC_EPSIZE,
-			.PollingIntervalMS = 0x05
+			.PollingIntervalMS = GENERIC_POLLING_INTERVAL_MS
+		},
+
+	#ifdef GENERIC_HIGH_RATE
+	.HID_ReportOUTEndpoint =
+		{
+			.Header = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+			.EndpointAddress = GENERIC_OUT_EPADDR,
+			.Attributes = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize = GENERIC_EPSIZE,
+			.PollingIntervalMS = GENERIC_POLLING_INTERVAL_MS
 		},
+	#endif
 };
 
 // Language descriptor structure. This descriptor, located in FLASH memory, is
@@ -126,6 +202,28 @@ const USB_Descriptor_String_t PROGMEM ManufacturerString = USB_STRING_DESCRIPTOR
 // when the appropriate string ID is requested, listed in the Device Descriptor.
 const USB_Descriptor_String_t PROGMEM ProductString = USB_STRING_DESCRIPTOR(L"LUFA Generic HID Demo");
 
+// Descriptor table searched by CALLBACK_USB_GetDescriptor (DescriptorTable.h),
+// each entry array indexed by the descriptor index of its type.
+static const DescriptorTable_Entry_t PROGMEM DeviceDescriptors[] = {DESCRIPTOR_ENTRY(DeviceDescriptor)};
+static const DescriptorTable_Entry_t PROGMEM ConfigurationDescriptors[] = {DESCRIPTOR_ENTRY(ConfigurationDescriptor)};
+static const DescriptorTable_Entry_t PROGMEM StringDescriptors[] =
+{
+	[STRING_ID_Language] = DESCRIPTOR_STRING_ENTRY(LanguageString),
+	[STRING_ID_Manufacturer] = DESCRIPTOR_STRING_ENTRY(ManufacturerString),
+	[STRING_ID_Product] = DESCRIPTOR_STRING_ENTRY(ProductString),
+};
+static const DescriptorTable_Entry_t PROGMEM HIDDescriptors[] = {DESCRIPTOR_ENTRY(ConfigurationDescriptor.HID_GenericHID)};
+static const DescriptorTable_Entry_t PROGMEM HIDReportDescriptors[] = {DESCRIPTOR_ENTRY(GenericReport)};
+
+static const DescriptorTable_Row_t PROGMEM Descriptors[] =
+{
+	DESCRIPTOR_ROW(DTYPE_Device, DESCRIPTOR_ANY_INTERFACE, DeviceDescriptors),
+	DESCRIPTOR_ROW(DTYPE_Configuration, DESCRIPTOR_ANY_INTERFACE, ConfigurationDescriptors),
+	DESCRIPTOR_ROW(DTYPE_String, DESCRIPTOR_ANY_INTERFACE, StringDescriptors),
+	DESCRIPTOR_ROW(HID_DTYPE_HID, INTERFACE_ID_GenericHID, HIDDescriptors),
+	DESCRIPTOR_ROW(HID_DTYPE_Report, INTERFACE_ID_GenericHID, HIDReportDescriptors),
+};
+
 // This function is called by the library when in device mode, and must be
 // overridden (see library "USB Descriptors" documentation) by the application
 // code so that the address and size of a requested descriptor can be given
@@ -136,52 +234,5 @@ uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
 									const uint8_t wIndex,
 									const void** const DescriptorAddress)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB getdescriptor...0x%x, 0x%x\n", wValue, wIndex);
-	#endif
-	const uint8_t DescriptorType = (wValue >> 8);
-	const uint8_t DescriptorNumber = (wValue & 0xFF);
-
-	const void* Address = NULL;
-	uint16_t Size = NO_DESCRIPTOR;
-
-	switch (DescriptorType)
-	{
-		case DTYPE_Device:
-			Address = &DeviceDescriptor;
-			Size = sizeof(USB_Descriptor_Device_t);
-			break;
-		case DTYPE_Configuration:
-			Address = &ConfigurationDescriptor;
-			Size = sizeof(USB_Descriptor_Configuration_t);
-			break;
-		case DTYPE_String:
-			switch (DescriptorNumber)
-			{
-				case STRING_ID_Language:
-					Address = &LanguageString;
-					Size = pgm_read_byte(&LanguageString.Header.Size);
-					break;
-				case STRING_ID_Manufacturer:
-					Address = &ManufacturerString;
-					Size = pgm_read_byte(&ManufacturerString.Header.Size);
-					break;
-				case STRING_ID_Product:
-					Address = &ProductString;
-					Size = pgm_read_byte(&ProductString.Header.Size);
-					break;
-			}
-			break;
-		case HID_DTYPE_HID:
-			Address = &ConfigurationDescriptor.HID_GenericHID;
-			Size = sizeof(USB_HID_Descriptor_HID_t);
-			break;
-		case HID_DTYPE_Report:
-			Address = &GenericReport;
-			Size = sizeof(GenericReport);
-			break;
-	}
-
-	*DescriptorAddress = Address;
-	return Size;
+	return DESCRIPTOR_TABLE_LOOKUP(Descriptors, wValue, wIndex, DescriptorAddress);
 }
@@ -18,6 +18,9 @@ typedef struct
 	USB_Descriptor_Interface_t HID_Interface;
 	USB_HID_Descriptor_HID_t HID_GenericHID;
 	USB_Descriptor_Endpoint_t HID_ReportINEndpoint;
+	#ifdef GENERIC_HIGH_RATE
+	USB_Descriptor_Endpoint_t HID_ReportOUTEndpoint;
+	#endif
 } USB_Descriptor_Configuration_t;
 
 // Enum for the device interface descriptor IDs within the device. Each interface
@@ -42,8 +45,65 @@ enum StringDescriptors_t
 // Endpoint address of the Generic HID reporting IN endpoint.
 #define GENERIC_IN_EPADDR	(ENDPOINT_DIR_IN | 1)
 
+// Endpoint address of the Generic HID reporting OUT endpoint, high-rate mode
+// only. Reports from the host otherwise arrive with SET_REPORT on the control
+// endpoint.
+#define GENERIC_OUT_EPADDR	(ENDPOINT_DIR_OUT | 2)
+
+#if defined(GENERIC_HIGH_RATE) && defined(GENERIC_REPORT_IDS)
+	#error GENERIC_HIGH_RATE and GENERIC_REPORT_IDS are exclusive
+#endif
+
+#ifdef GENERIC_HIGH_RATE
+// High-rate mode: a full speed interrupt endpoint of the largest size, polled
+// every frame, moves one 64 byte report per millisecond in each direction.
+#define GENERIC_EPSIZE	64
+#define GENERIC_POLLING_INTERVAL_MS	1
+#elif defined(GENERIC_REPORT_IDS)
+// Multi-report mode: room for the largest report and its report ID byte.
+#define GENERIC_EPSIZE	16
+#define GENERIC_POLLING_INTERVAL_MS	5
+#else
 // Size in bytes of the Generic HID reporting endpoint.
 #define GENERIC_EPSIZE	8
+#define GENERIC_POLLING_INTERVAL_MS	5
+#endif
+
+// Size in bytes of the configuration feature report (Generic_Config_t).
+#define GENERIC_CONFIG_REPORT_SIZE	8
+
+#ifdef GENERIC_REPORT_IDS
+	#define GENERIC_CONFIG_REPORT_ID	GENERIC_REPORT_ID_Config
+#else
+	#define GENERIC_CONFIG_REPORT_ID	0
+#endif
+
+#ifdef GENERIC_REPORT_IDS
+// Reports of the multi-report mode, declared in GenericReport. Each one is
+// sent on its own when its content changes or its idle period elapses.
+enum GenericReportIDs_t
+{
+	GENERIC_REPORT_ID_Status = 1, // LED flags, IN and OUT, changes rarely
+	GENERIC_REPORT_ID_Sensor = 2, // Sensor block, changes every few frames
+	GENERIC_REPORT_ID_Counters = 3, // Host report count and uptime
+	GENERIC_REPORT_ID_Config = 4, // Configuration block, feature report
+};
+
+// Report sizes in bytes, without the report ID. GENERIC_REPORT_SIZE is the
+// largest one.
+#define GENERIC_STATUS_REPORT_SIZE		4
+#define GENERIC_SENSOR_REPORT_SIZE		GENERIC_REPORT_SIZE
+#define GENERIC_COUNTERS_REPORT_SIZE	8
+
+#if (GENERIC_REPORT_SIZE < GENERIC_COUNTERS_REPORT_SIZE)
+	#error GENERIC_REPORT_IDS needs a GENERIC_REPORT_SIZE of at least GENERIC_COUNTERS_REPORT_SIZE bytes
+#endif
+#if ((GENERIC_REPORT_SIZE + 1) > GENERIC_EPSIZE)
+	#error GENERIC_REPORT_SIZE and the report ID must fit into one GENERIC_EPSIZE packet
+#endif
+#elif (GENERIC_REPORT_SIZE > GENERIC_EPSIZE)
+	#error GENERIC_REPORT_SIZE must fit into one GENERIC_EPSIZE packet
+#endif
 
 // Function Prototypes:
 uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
@@ -2,12 +2,95 @@
 // of the demo and is responsible for the initial application hardware configuration.
 #include "GenericHID.h"
 #include "global.h"
-#include "uart.h"
-#include "rprintf.h"
 
-// Buffer to hold the previously generated HID report, for comparison purposes
-// inside the HID class driver.
-static uint8_t PrevHIDReportBuffer[GENERIC_REPORT_SIZE];
+#ifdef GENERIC_HIGH_RATE
+#if ((GENERIC_SAMPLE_QUEUE_DEPTH & (GENERIC_SAMPLE_QUEUE_DEPTH - 1)) != 0) || \
+	(GENERIC_SAMPLE_QUEUE_DEPTH < 2) || (GENERIC_SAMPLE_QUEUE_DEPTH > 128)
+	#error GENERIC_SAMPLE_QUEUE_DEPTH must be a power of two from 2 to 128
+#endif
+
+// Reports waiting for the IN endpoint. The main loop is the only producer and
+// CALLBACK_HID_Device_CreateHIDReport, from the main loop or the USB
+// interrupts, the only consumer; as in SPSCRingBuffer.h each side only
+// writes its own free running index. GET_REPORT copies the newest sample, the
+// one before the head, which the producer only writes again after it
+// published the next one.
+static uint8_t SampleQueue[GENERIC_SAMPLE_QUEUE_DEPTH][GENERIC_REPORT_SIZE];
+static volatile uint8_t SampleQueueHead;
+static volatile uint8_t SampleQueueTail;
+
+// Sequence number of the next sample of the demo producer.
+static uint16_t SampleSequence;
+#elif defined(GENERIC_REPORT_IDS)
+// One IN report of the multi-report mode.
+typedef struct
+{
+	uint8_t ReportID;
+	uint8_t ReportSize;
+	uint8_t IdleRate; // Idle rate until SET_IDLE, in units of 4ms, 0 to only send changes
+	void (*CreateReport)(uint8_t* const Data);
+} Generic_Report_t;
+
+static void Generic_CreateStatusReport(uint8_t* const Data);
+static void Generic_CreateSensorReport(uint8_t* const Data);
+static void Generic_CreateCountersReport(uint8_t* const Data);
+
+// The IN reports, in the order they are checked for changes.
+static const Generic_Report_t GenericReports[] PROGMEM =
+{
+	{GENERIC_REPORT_ID_Status, GENERIC_STATUS_REPORT_SIZE, 125, Generic_CreateStatusReport},
+	{GENERIC_REPORT_ID_Sensor, GENERIC_SENSOR_REPORT_SIZE, 0, Generic_CreateSensorReport},
+	{GENERIC_REPORT_ID_Counters, GENERIC_COUNTERS_REPORT_SIZE, 0, Generic_CreateCountersReport},
+};
+
+#define GENERIC_REPORT_COUNT	(sizeof(GenericReports) / sizeof(GenericReports[0]))
+
+// Per report state, the change detection the class driver does for a single
+// report: the last report sent, the idle rate set by the host and the frame
+// number the report was last sent in.
+static uint8_t PrevReports[GENERIC_REPORT_COUNT][GENERIC_REPORT_SIZE];
+static uint8_t ReportIdleRates[GENERIC_REPORT_COUNT];
+static uint16_t ReportSentFrames[GENERIC_REPORT_COUNT];
+
+// Reports not sent since the configuration, one bit per report.
+static uint8_t ReportsPending;
+
+// Report checked first for the next IN report. Round robin, so that a report
+// that changes every frame cannot starve the others.
+static uint8_t NextReport;
+
+// Counters report data. HostReports is written by the control request
+// handler, UptimeSeconds and UptimeMS by the Start Of Frame interrupt.
+static volatile uint32_t HostReports;
+static volatile uint32_t UptimeSeconds;
+static uint16_t UptimeMS;
+#else
+// The LED report. With GENERIC_DIRTY_REPORT it is only rebuilt after
+// Generic_MarkReportDirty, in between the class driver gets this copy and
+// sends it when the idle period elapses.
+static uint8_t GenericReportData[GENERIC_REPORT_SIZE];
+
+// Set when the report data may have changed, from any context.
+static volatile bool GenericReportDirty;
+#endif
+
+// Configuration block in EEPROM and its working copy. SET_REPORT only updates
+// the copy, the main loop writes it back one byte per pass, so that a feature
+// report never waits for the 3.4ms of each EEPROM byte write.
+Generic_Config_t EEMEM GenericConfigEEPROM;
+static Generic_Config_t GenericConfig;
+
+// Next byte of GenericConfig to write back, sizeof(GenericConfig) once the
+// EEPROM is up to date.
+static volatile uint8_t ConfigSaveIndex = sizeof(Generic_Config_t);
+
+static const Generic_Config_t GenericConfigDefaults PROGMEM =
+{
+	.Version = GENERIC_CONFIG_VERSION,
+	.SamplePeriodMS = 4,
+	.ReportMask = 0xFF,
+	.SensorThreshold = 0,
+};
 
 // LUFA HID Class driver interface configuration and state information. This
 // structure is passed to all HID Class driver functions, so that multiple
@@ -24,34 +107,414 @@ USB_ClassInfo_HID_Device_t Generic_HID_Interface =
 					.Size = GENERIC_EPSIZE,
 					.Banks = 1,
 				},
-			.PrevReportINBuffer = PrevHIDReportBuffer,
-			.PrevReportINBufferSize = sizeof(PrevHIDReportBuffer),
+			// Every queued sample is sent, or CALLBACK_HID_Device_CreateHIDReport
+			// tells the driver when a report changed; the driver never compares
+			// reports, it only sizes its report buffer.
+			.PrevReportINBuffer = NULL,
+			.PrevReportINBufferSize = GENERIC_REPORT_SIZE,
 		},
 };
 
+#if !defined(GENERIC_HIGH_RATE) && !defined(GENERIC_REPORT_IDS)
+// Marks the report data changed, the next IN report rebuilds it and is sent
+// if it differs from the last one. With GENERIC_DIRTY_REPORT, call after every
+// change of the data the report is built from; a change that is not marked
+// only goes out with the next idle report. Without it every IN report is
+// rebuilt anyway, and the mark only counts for the remote wakeup.
+void Generic_MarkReportDirty(void)
+{
+	GenericReportDirty = true;
+}
+#endif
+
+#ifdef GENERIC_WAKE_BUTTON
+// Any change of the wake button marks the report changed. INT6 senses the
+// edges asynchronously, so the button also wakes the CPU from power-down.
+ISR(INT6_vect)
+{
+	Generic_MarkReportDirty();
+}
+
+static void Generic_InitWakeButton(void)
+{
+	DDRE &= ~(1 << PE6);
+	PORTE |= (1 << PE6);
+
+	EICRB = ((EICRB & ~((1 << ISC61) | (1 << ISC60))) | (1 << ISC60));
+	EIFR = (1 << INTF6);
+	EIMSK |= (1 << INT6);
+}
+#endif
+
+// Whether a report waits for the host, for the remote wakeup. Only the wake
+// button changes a report while the bus is suspended: the LEDs only change on
+// a report of the host, the sample queue of the high-rate mode is kept full by
+// the demo source, and the multi-report mode only finds changed reports while
+// it builds them for the endpoint.
+static bool Generic_HasReportPending(void)
+{
+	#ifdef GENERIC_WAKE_BUTTON
+	return GenericReportDirty;
+	#else
+	return false;
+	#endif
+}
+
+// Loads the configuration block from EEPROM, or the defaults if the EEPROM
+// holds none of this version.
+static void Generic_LoadConfig(void)
+{
+	eeprom_read_block(&GenericConfig, &GenericConfigEEPROM, sizeof(GenericConfig));
+
+	if ((GenericConfig.Version != GENERIC_CONFIG_VERSION) || !(GenericConfig.SamplePeriodMS))
+		memcpy_P(&GenericConfig, &GenericConfigDefaults, sizeof(GenericConfig));
+}
+
+// Takes a configuration block from a feature report and starts writing it
+// back. Blocks of another size or version, or with invalid settings, are
+// ignored; the host sees that when it reads the block back.
+static void Generic_SetConfig(const uint8_t* const Data, const uint16_t Size)
+{
+	const Generic_Config_t* Config = (const Generic_Config_t*)Data;
+
+	if ((Size != sizeof(Generic_Config_t)) || (Config->Version != GENERIC_CONFIG_VERSION) ||
+		!(Config->SamplePeriodMS))
+	{
+		return;
+	}
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	memcpy(&GenericConfig, Config, sizeof(GenericConfig));
+	ConfigSaveIndex = 0;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+// Writes the next changed byte of the configuration block to EEPROM once the
+// previous write has completed. Main loop only.
+static void Generic_SaveConfigTask(void)
+{
+	if (!(eeprom_is_ready()) || (ConfigSaveIndex >= sizeof(GenericConfig)))
+		return;
+
+	// A new block from the control request interrupt restarts the write back
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint8_t Index = ConfigSaveIndex;
+
+	if (Index < sizeof(GenericConfig))
+	{
+		eeprom_update_byte(&((uint8_t*)&GenericConfigEEPROM)[Index], ((uint8_t*)&GenericConfig)[Index]);
+		ConfigSaveIndex = Index + 1;
+	}
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+#ifdef GENERIC_HIGH_RATE
+// Queues a report for the IN endpoint, returns false if the queue is full.
+// Main loop only.
+bool Generic_QueueSample(const uint8_t* const Sample)
+{
+	uint8_t Head = SampleQueueHead;
+
+	if ((uint8_t)(Head - SampleQueueTail) >= GENERIC_SAMPLE_QUEUE_DEPTH)
+		return false;
+
+	memcpy(SampleQueue[Head & (GENERIC_SAMPLE_QUEUE_DEPTH - 1)], Sample, GENERIC_REPORT_SIZE);
+	SPSC_RING_BUFFER_BARRIER();
+	SampleQueueHead = Head + 1;
+	return true;
+}
+
+// Demo telemetry source, keeps the sample queue full. An application queues
+// its own measurements with Generic_QueueSample instead.
+static void Generic_SampleTask(void)
+{
+	uint8_t Sample[GENERIC_REPORT_SIZE];
+	uint8_t CurrLEDMask = LEDs_GetLEDs();
+
+	while ((uint8_t)(SampleQueueHead - SampleQueueTail) < GENERIC_SAMPLE_QUEUE_DEPTH)
+	{
+		Sample[0] = ((CurrLEDMask & LEDS_LED1) ? 1 : 0);
+		Sample[1] = ((CurrLEDMask & LEDS_LED2) ? 1 : 0);
+		Sample[2] = ((CurrLEDMask & LEDS_LED3) ? 1 : 0);
+		Sample[3] = ((CurrLEDMask & LEDS_LED4) ? 1 : 0);
+
+		uint16_t FrameNumber = USB_Device_GetFrameNumber();
+		Sample[GENERIC_SAMPLE_SEQUENCE] = (SampleSequence & 0xFF);
+		Sample[GENERIC_SAMPLE_SEQUENCE + 1] = (SampleSequence >> 8);
+		Sample[GENERIC_SAMPLE_FRAME] = (FrameNumber & 0xFF);
+		Sample[GENERIC_SAMPLE_FRAME + 1] = (FrameNumber >> 8);
+
+		for (uint8_t i = GENERIC_SAMPLE_PAYLOAD; i < GENERIC_REPORT_SIZE; i++)
+			Sample[i] = (uint8_t)(SampleSequence + i);
+
+		Generic_QueueSample(Sample);
+		SampleSequence++;
+	}
+}
+
+// Hands a report from the interrupt OUT endpoint, if one arrived, to the same
+// callback as a SET_REPORT request.
+static void Generic_ReceiveReport(void)
+{
+	Endpoint_SelectEndpoint(GENERIC_OUT_EPADDR);
+	if (!(Endpoint_IsOUTReceived()))
+		return;
+
+	uint8_t ReportData[GENERIC_REPORT_SIZE];
+	uint16_t ReportSize = Endpoint_BytesInEndpoint();
+
+	if (ReportSize > sizeof(ReportData))
+		ReportSize = sizeof(ReportData);
+
+	memset(ReportData, 0, sizeof(ReportData));
+	Endpoint_Read_Stream_LE(ReportData, ReportSize, NULL);
+	Endpoint_ClearOUT();
+
+	CALLBACK_HID_Device_ProcessHIDReport(&Generic_HID_Interface, 0, HID_REPORT_ITEM_Out, ReportData, ReportSize);
+}
+#endif
+
+#ifdef INTERRUPT_DATA_ENDPOINT
+// Sends the report due in this frame if the IN bank is free and takes a report
+// from the OUT endpoint, then arms the interrupts of what is left
+// (EndpointInterrupt.h): TXINE while the report of the frame waits for the
+// bank, RXOUTE unless a report waits in the OUT bank. Runs from the endpoint
+// interrupt and from the Start Of Frame event, which makes the next report
+// due, and may interrupt a control request, so it keeps its endpoint
+// selected.
+static void Generic_ServiceEndpoints(void)
+{
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+
+	HID_Device_USBTask(&Generic_HID_Interface);
+
+	Endpoint_SelectEndpoint(GENERIC_IN_EPADDR);
+	if ((USB_DeviceState == DEVICE_STATE_Configured) &&
+	    (Generic_HID_Interface.State.PrevFrameNum != USB_Device_GetFrameNumber()))
+		UEIENX |= (1 << TXINE);
+	else
+		UEIENX &= ~(1 << TXINE);
+
+	#ifdef GENERIC_HIGH_RATE
+	Generic_ReceiveReport();
+
+	Endpoint_SelectEndpoint(GENERIC_OUT_EPADDR);
+	if (Endpoint_IsOUTReceived())
+		UEIENX &= ~(1 << RXOUTE);
+	else
+		UEIENX |= (1 << RXOUTE);
+	#endif
+
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+}
+#endif
+
+#ifdef GENERIC_REPORT_IDS
+// Marks every report for sending and restores the default idle rates, on
+// every new configuration.
+static void Generic_ResetReports(void)
+{
+	for (uint8_t i = 0; i < GENERIC_REPORT_COUNT; i++)
+		ReportIdleRates[i] = pgm_read_byte(&GenericReports[i].IdleRate);
+
+	ReportsPending = ((1 << GENERIC_REPORT_COUNT) - 1);
+	NextReport = 0;
+}
+
+// SET_IDLE and GET_IDLE per report ID, which the class driver keeps only once
+// for the interface. Report ID 0 of SET_IDLE sets every report, a request for
+// an unknown report ID is stalled.
+static void Generic_ProcessIdleRequest(void)
+{
+	if (USB_ControlRequest.wIndex != INTERFACE_ID_GenericHID)
+		return;
+
+	uint8_t ReportID = (USB_ControlRequest.wValue & 0xFF);
+
+	switch (USB_ControlRequest.bRequest)
+	{
+		case HID_REQ_SetIdle:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE))
+			{
+				bool Found = false;
+
+				for (uint8_t i = 0; i < GENERIC_REPORT_COUNT; i++)
+				{
+					if (ReportID && (ReportID != pgm_read_byte(&GenericReports[i].ReportID)))
+						continue;
+
+					ReportIdleRates[i] = (USB_ControlRequest.wValue >> 8);
+					Found = true;
+				}
+
+				Endpoint_ClearSETUP();
+
+				if (Found)
+					Endpoint_ClearStatusStage();
+				else
+					Endpoint_StallTransaction();
+			}
+			break;
+		case HID_REQ_GetIdle:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE))
+			{
+				uint8_t i;
+
+				for (i = 0; i < GENERIC_REPORT_COUNT; i++)
+				{
+					if (!(ReportID) || (ReportID == pgm_read_byte(&GenericReports[i].ReportID)))
+						break;
+				}
+
+				Endpoint_ClearSETUP();
+
+				if (i == GENERIC_REPORT_COUNT)
+				{
+					Endpoint_StallTransaction();
+					return;
+				}
+
+				Endpoint_Write_8(ReportIdleRates[i]);
+				Endpoint_ClearIN();
+				Endpoint_ClearStatusStage();
+			}
+			break;
+	}
+}
+
+// True if a byte of Data differs from the same byte of Prev by more than
+// Threshold.
+static bool Generic_ReportChanged(const uint8_t* const Data, const uint8_t* const Prev,
+								  const uint8_t Size, const uint8_t Threshold)
+{
+	for (uint8_t i = 0; i < Size; i++)
+	{
+		uint8_t Difference = (Data[i] > Prev[i]) ? (Data[i] - Prev[i]) : (Prev[i] - Data[i]);
+
+		if (Difference > Threshold)
+			return true;
+	}
+
+	return false;
+}
+
+// LED flags, the report of the single report mode.
+static void Generic_CreateStatusReport(uint8_t* const Data)
+{
+	uint8_t CurrLEDMask = LEDs_GetLEDs();
+
+	Data[0] = ((CurrLEDMask & LEDS_LED1) ? 1 : 0);
+	Data[1] = ((CurrLEDMask & LEDS_LED2) ? 1 : 0);
+	Data[2] = ((CurrLEDMask & LEDS_LED3) ? 1 : 0);
+	Data[3] = ((CurrLEDMask & LEDS_LED4) ? 1 : 0);
+}
+
+// Demo sensor block, a ramp that advances every SamplePeriodMS. An
+// application fills in its measurements here.
+static void Generic_CreateSensorReport(uint8_t* const Data)
+{
+	uint8_t Tick = (USB_Device_GetFrameNumber() / GenericConfig.SamplePeriodMS);
+
+	for (uint8_t i = 0; i < GENERIC_SENSOR_REPORT_SIZE; i++)
+		Data[i] = (uint8_t)(Tick + i);
+}
+
+// Reports received from the host and seconds since the configuration, little
+// endian.
+static void Generic_CreateCountersReport(uint8_t* const Data)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint32_t Reports = HostReports;
+	uint32_t Seconds = UptimeSeconds;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		Data[i] = (uint8_t)(Reports >> (8 * i));
+		Data[4 + i] = (uint8_t)(Seconds >> (8 * i));
+	}
+}
+#endif
+
+// Idle check of the main loop, run by PowerSave_IdleTask with the interrupts
+// disabled: true if the next pass has work. Otherwise arms the interrupts of
+// the endpoints the loop waits on. The class driver builds at most one IN
+// report per frame, the Start Of Frame interrupt ends the sleep for the next.
+static bool Generic_IsWorkPending(void)
+{
+	if (ConfigSaveIndex < sizeof(GenericConfig))
+		return true;
+
+	#ifdef GENERIC_HIGH_RATE
+	if ((uint8_t)(SampleQueueHead - SampleQueueTail) < GENERIC_SAMPLE_QUEUE_DEPTH)
+		return true;
+	#endif
+
+	#ifndef INTERRUPT_DATA_ENDPOINT
+	#ifdef GENERIC_HIGH_RATE
+	Endpoint_SelectEndpoint(GENERIC_OUT_EPADDR);
+	if (Endpoint_IsOUTReceived())
+		return true;
+
+	PowerSave_WakeOnEndpoint(GENERIC_OUT_EPADDR);
+	#endif
+
+	if (Generic_HID_Interface.State.PrevFrameNum != USB_Device_GetFrameNumber())
+	{
+		Endpoint_SelectEndpoint(GENERIC_IN_EPADDR);
+		if (Endpoint_IsReadWriteAllowed())
+			return true;
+
+		PowerSave_WakeOnEndpoint(GENERIC_IN_EPADDR);
+	}
+	#endif
+
+	return false;
+}
+
 // Main program entry point. This routine contains the overall program flow,
 // including initial setup of all components and the main program loop.
 int main(void)
 {
-	#ifdef MY_DEBUG
-	uartInit();
-	uartSetBaudRate(9600);
-	rprintfInit(uartSendByte);
-	rprintf("test start...\n");
-	#endif
+	EventLog_Init();
+	LOG_INFO(USB, Start, MCUSR, 0);
 
 	SetupHardware();
 
 	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
 	GlobalInterruptEnable();
 
-	#ifdef MY_DEBUG
-	rprintf("loop start...\n");
-	#endif
+	LOG_INFO(USB, LoopStart, 0, 0);
 	for (;;)
 	{
+		PERF_COUNT(MainLoopPasses);
+		PowerSave_Task(Generic_HasReportPending());
+		Generic_SaveConfigTask();
+
+		#ifdef GENERIC_HIGH_RATE
+		Generic_SampleTask();
+		#endif
+
+		#ifndef INTERRUPT_DATA_ENDPOINT
 		HID_Device_USBTask(&Generic_HID_Interface);
+		#ifdef GENERIC_HIGH_RATE
+		Generic_ReceiveReport();
+		#endif
 		USB_USBTask();
+		#endif
+		// With INTERRUPT_DATA_ENDPOINT the reports and control requests are
+		// handled from the USB interrupts, the loop is free for application work.
+
+		PowerSave_IdleTask(Generic_IsWorkPending);
 	}
 }
 
@@ -67,54 +530,76 @@ void SetupHardware(void)
 
 	// Hardware Initialization
 	LEDs_Init();
-	#ifdef MY_DEBUG
-	rprintf("before USB_Init...\n");
+	#ifdef GENERIC_WAKE_BUTTON
+	Generic_InitWakeButton();
 	#endif
+	CycleProbe_Init();
+	Generic_LoadConfig();
 	USB_Init();
-	#ifdef MY_DEBUG
-	rprintf("after USB_Init...\n");
-	#endif
+	LOG_INFO(USB, USBInit, 0, 0);
 }
 
 // Event handler for the library USB Connection event.
 void EVENT_USB_Device_Connect(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB connect...\n");
-	#endif
+	LOG_INFO(USB, Connect, 0, 0);
 	LEDs_SetAllLEDs(LEDMASK_USB_ENUMERATING);
 }
 
 // Event handler for the library USB Disconnection event.
 void EVENT_USB_Device_Disconnect(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB disconnect...\n");
-	#endif
+	LOG_INFO(USB, Disconnect, 0, 0);
 	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
 }
 
+// Event handler for the library USB Suspend event.
+void EVENT_USB_Device_Suspend(void)
+{
+	PowerSave_Suspend();
+}
+
+// Event handler for the library USB Wake Up event.
+void EVENT_USB_Device_WakeUp(void)
+{
+	PowerSave_WakeUp();
+}
+
 // Event handler for the library USB Configuration Changed event.
 void EVENT_USB_Device_ConfigurationChanged(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB configuration...\n");
-	#endif
 	bool ConfigSuccess = true;
 
 	ConfigSuccess &= HID_Device_ConfigureEndpoints(&Generic_HID_Interface);
+	#ifdef GENERIC_HIGH_RATE
+	ConfigSuccess &= Endpoint_ConfigureEndpoint(GENERIC_OUT_EPADDR, EP_TYPE_INTERRUPT, GENERIC_EPSIZE, 1);
+	#endif
+	#ifdef GENERIC_REPORT_IDS
+	Generic_ResetReports();
+	UptimeMS = 0;
+	UptimeSeconds = 0;
+	#endif
 
 	USB_Device_EnableSOFEvents();
 
+	LOG_INFO(USB, ConfigurationChanged, ConfigSuccess, 0);
 	LEDs_SetAllLEDs(ConfigSuccess ? LEDMASK_USB_READY : LEDMASK_USB_ERROR);
+
+	// The first report after the configuration is always sent
+	#if !defined(GENERIC_HIGH_RATE) && !defined(GENERIC_REPORT_IDS)
+	memset(GenericReportData, 0xFF, sizeof(GenericReportData));
+	Generic_MarkReportDirty();
+	#endif
 }
 
 // Event handler for the library USB Control Request reception event.
 void EVENT_USB_Device_ControlRequest(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB control request...0x%x, 0x%x\n", USB_ControlRequest.bRequest,
-	USB_ControlRequest.bmRequestType);
+	LOG_DEBUG(USB, ControlRequest, USB_ControlRequest.bRequest, USB_ControlRequest.bmRequestType);
+	PerfCounters_ProcessControlRequest();
+	CycleProbe_ProcessControlRequest();
+	#ifdef GENERIC_REPORT_IDS
+	Generic_ProcessIdleRequest();
 	#endif
 	HID_Device_ProcessControlRequest(&Generic_HID_Interface);
 }
@@ -122,12 +607,36 @@ void EVENT_USB_Device_ControlRequest(void)
 // Event handler for the USB device Start Of Frame event.
 void EVENT_USB_Device_StartOfFrame(void)
 {
-	#ifdef MY_DEBUG
-	//rprintf("USB start of frame...\n");
-	#endif
 	HID_Device_MillisecondElapsed(&Generic_HID_Interface);
+
+	#ifdef GENERIC_REPORT_IDS
+	if (++UptimeMS == 1000)
+	{
+		UptimeMS = 0;
+		UptimeSeconds++;
+	}
+	#endif
+
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	Generic_ServiceEndpoints();
+	#endif
 }
 
+#ifdef INTERRUPT_DATA_ENDPOINT
+// Event handler for the library USB Reset event. The bus reset disarmed the
+// endpoint interrupts, the control requests are handled from it again.
+void EVENT_USB_Device_Reset(void)
+{
+	EndpointInterrupt_Reset();
+}
+
+// Event handler of the USB endpoint interrupt (EndpointInterrupt.h).
+void EVENT_EndpointInterrupt_Data(void)
+{
+	Generic_ServiceEndpoints();
+}
+#endif
+
 // HID class driver callback function for the creation of HID reports to the host.
 // [in] HIDInterfaceInfo : Pointer to the HID class interface configuration
 // structure being referenced.
@@ -148,21 +657,158 @@ bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDIn
 										 void* ReportData,
 										 uint16_t* const ReportSize)
 {
+	CYCLE_PROBE(CYCLE_PROBE_CreateHIDReport);
+
+	// The configuration block, for GET_REPORT of type Feature
+	if (ReportType == HID_REPORT_ITEM_Feature)
+	{
+		*ReportSize = 0;
+
+		if (*ReportID == GENERIC_CONFIG_REPORT_ID)
+		{
+			memcpy(ReportData, &GenericConfig, sizeof(GenericConfig));
+			*ReportSize = sizeof(GenericConfig);
+		}
+
+		return false;
+	}
+
+	#ifdef GENERIC_HIGH_RATE
+	// GET_REPORT, on the control endpoint: the newest sample, queued or
+	// already sent. Only the IN endpoint takes samples from the queue.
+	if (Endpoint_GetCurrentEndpoint() == ENDPOINT_CONTROLEP)
+	{
+		memcpy(ReportData, SampleQueue[(uint8_t)(SampleQueueHead - 1) & (GENERIC_SAMPLE_QUEUE_DEPTH - 1)],
+			   GENERIC_REPORT_SIZE);
+		*ReportSize = GENERIC_REPORT_SIZE;
+		return false;
+	}
+
+	// One queued sample per report, nothing is sent while the queue is empty.
+	uint8_t Tail = SampleQueueTail;
+
+	if (Tail == SampleQueueHead)
+	{
+		*ReportSize = 0;
+		return false;
+	}
+
+	memcpy(ReportData, SampleQueue[Tail & (GENERIC_SAMPLE_QUEUE_DEPTH - 1)], GENERIC_REPORT_SIZE);
+	SPSC_RING_BUFFER_BARRIER();
+	SampleQueueTail = Tail + 1;
+
+	PERF_COUNT(INPackets);
+	CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+	PERF_ADD(INBytes, GENERIC_REPORT_SIZE);
+	LOG_DEBUG(DATA, CreateHIDReport, *ReportID, LEDs_GetLEDs());
+
+	*ReportSize = GENERIC_REPORT_SIZE;
+	return true;
+	#elif defined(GENERIC_REPORT_IDS)
 	uint8_t* Data = (uint8_t*)ReportData;
-	uint8_t CurrLEDMask = LEDs_GetLEDs();
+	Generic_Report_t Report;
 
-	Data[0] = ((CurrLEDMask & LEDS_LED1) ? 1 : 0);
-	Data[1] = ((CurrLEDMask & LEDS_LED2) ? 1 : 0);
-	Data[2] = ((CurrLEDMask & LEDS_LED3) ? 1 : 0);
-	Data[3] = ((CurrLEDMask & LEDS_LED4) ? 1 : 0);
+	// GET_REPORT names the report, it is sent whether it changed or not
+	if (*ReportID)
+	{
+		*ReportSize = 0;
+
+		for (uint8_t i = 0; i < GENERIC_REPORT_COUNT; i++)
+		{
+			memcpy_P(&Report, &GenericReports[i], sizeof(Report));
+
+			if ((Report.ReportID == *ReportID) && (ReportType == HID_REPORT_ITEM_In))
+			{
+				Report.CreateReport(Data);
+				*ReportSize = Report.ReportSize;
+			}
+		}
+
+		return false;
+	}
+
+	// IN endpoint: the first enabled report, round robin, that changed, was
+	// not sent since the configuration or whose idle period elapsed. The frame number
+	// has 11 bits, enough for the longest idle period of 1020ms.
+	uint16_t FrameNumber = USB_Device_GetFrameNumber();
+
+	for (uint8_t n = 0; n < GENERIC_REPORT_COUNT; n++)
+	{
+		uint8_t Index = NextReport;
+		NextReport = ((Index + 1) < GENERIC_REPORT_COUNT) ? (Index + 1) : 0;
+
+		memcpy_P(&Report, &GenericReports[Index], sizeof(Report));
 
-	#ifdef MY_DEBUG
-	rprintf("create HID report...0x%x : 0x%x 0x%x 0x%x 0x%x\n", 
-	ReportID, Data[0], Data[1], Data[2], Data[3]);
+		if (!(GenericConfig.ReportMask & (1 << (Report.ReportID - 1))))
+			continue;
+
+		Report.CreateReport(Data);
+
+		uint8_t Threshold = (Report.ReportID == GENERIC_REPORT_ID_Sensor) ? GenericConfig.SensorThreshold : 0;
+		bool Send = ((ReportsPending & (1 << Index)) ||
+					 Generic_ReportChanged(Data, PrevReports[Index], Report.ReportSize, Threshold));
+
+		if (!(Send) && ReportIdleRates[Index])
+			Send = (((FrameNumber - ReportSentFrames[Index]) & 0x7FF) >= (ReportIdleRates[Index] * 4));
+
+		if (Send)
+		{
+			memcpy(PrevReports[Index], Data, Report.ReportSize);
+			ReportSentFrames[Index] = FrameNumber;
+			ReportsPending &= ~(1 << Index);
+
+			PERF_COUNT(INPackets);
+			CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+			PERF_ADD(INBytes, Report.ReportSize + 1);
+			LOG_DEBUG(DATA, CreateHIDReport, Report.ReportID, LEDs_GetLEDs());
+
+			*ReportID = Report.ReportID;
+			*ReportSize = Report.ReportSize;
+			return true;
+		}
+	}
+
+	*ReportSize = 0;
+	return false;
+	#else
+	bool Changed = false;
+
+	#ifndef GENERIC_DIRTY_REPORT
+	// Rebuilt and compared with the last report on every call
+	GenericReportDirty = true;
 	#endif
 
+	// Rebuilt only when marked dirty, otherwise the last report is handed to
+	// the driver for idle reports and GET_REPORT.
+	if (GenericReportDirty)
+	{
+		uint8_t Data[GENERIC_REPORT_SIZE] = {0};
+		uint8_t CurrLEDMask = LEDs_GetLEDs();
+
+		GenericReportDirty = false;
+
+		Data[0] = ((CurrLEDMask & LEDS_LED1) ? 1 : 0);
+		Data[1] = ((CurrLEDMask & LEDS_LED2) ? 1 : 0);
+		Data[2] = ((CurrLEDMask & LEDS_LED3) ? 1 : 0);
+		Data[3] = ((CurrLEDMask & LEDS_LED4) ? 1 : 0);
+		#ifdef GENERIC_WAKE_BUTTON
+		Data[GENERIC_WAKE_BUTTON_INDEX] = ((PINE & (1 << PE6)) ? 0 : 1);
+		#endif
+
+		Changed = (memcmp(Data, GenericReportData, sizeof(Data)) != 0);
+		memcpy(GenericReportData, Data, sizeof(Data));
+
+		if (Changed)
+			CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+
+		LOG_DEBUG(DATA, CreateHIDReport, *ReportID, CurrLEDMask);
+	}
+
+	memcpy(ReportData, GenericReportData, GENERIC_REPORT_SIZE);
+
 	*ReportSize = GENERIC_REPORT_SIZE;
-	return false;
+	return Changed;
+	#endif
 }
 
 // HID class driver callback function for the processing of HID reports from
@@ -184,6 +830,24 @@ void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDI
 	uint8_t* Data = (uint8_t*)ReportData;
 	uint8_t NewLEDMask = LEDS_NO_LEDS;
 
+	PERF_COUNT(OUTPackets);
+	PERF_ADD(OUTBytes, ReportSize);
+
+	if (ReportType == HID_REPORT_ITEM_Feature)
+	{
+		if (ReportID == GENERIC_CONFIG_REPORT_ID)
+			Generic_SetConfig(Data, ReportSize);
+
+		return;
+	}
+
+	#ifdef GENERIC_REPORT_IDS
+	HostReports++;
+
+	if ((ReportID != GENERIC_REPORT_ID_Status) || (ReportSize < GENERIC_STATUS_REPORT_SIZE))
+		return;
+	#endif
+
 	if (Data[0])
 		NewLEDMask |= LEDS_LED1;
 
@@ -197,8 +861,8 @@ void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDI
 		NewLEDMask |= LEDS_LED4;
 
 	LEDs_SetAllLEDs(NewLEDMask);
-	#ifdef MY_DEBUG
-	rprintf("process HID report...0x%x : 0x%x 0x%x 0x%x 0x%x\n", 
-	ReportID, Data[0], Data[1], Data[2], Data[3]);
+	#if !defined(GENERIC_HIGH_RATE) && !defined(GENERIC_REPORT_IDS)
+	Generic_MarkReportDirty();
 	#endif
+	LOG_DEBUG(DATA, ProcessHIDReport, ReportID, NewLEDMask);
 }
@@ -6,9 +6,16 @@
 #include <avr/wdt.h>
 #include <avr/power.h>
 #include <avr/interrupt.h>
+#include <avr/eeprom.h>
 #include <string.h>
 
 #include "Descriptors.h"
+#include "SPSCRingBuffer.h"
+#include "PerfCounters.h"
+#include "PowerSave.h"
+#include "CycleProbe.h"
+#include "EventLog.h"
+#include "EndpointInterrupt.h"
 
 #include <LUFA/Drivers/Board/LEDs.h>
 #include <LUFA/Drivers/USB/USB.h>
@@ -31,14 +38,76 @@
 // in the USB interface.
 #define LEDMASK_USB_ERROR	(LEDS_LED1 | LEDS_LED3)
 
+// Version of the configuration block layout. A block in EEPROM with another
+// version, or the erased EEPROM, loads the defaults.
+#define GENERIC_CONFIG_VERSION		1
+
+#ifdef GENERIC_WAKE_BUTTON
+#if defined(GENERIC_HIGH_RATE) || defined(GENERIC_REPORT_IDS)
+	#error GENERIC_WAKE_BUTTON is reported in the LED report only
+#endif
+
+// Byte of the LED report holding the wake button, 1 while pressed. The
+// button pulls PE6 (INT6, Leonardo pin D7) to ground.
+#define GENERIC_WAKE_BUTTON_INDEX	4
+#endif
+
+#ifdef GENERIC_HIGH_RATE
+// Number of reports buffered between the sample producer and the IN endpoint,
+// a power of two. Four reports of 64 bytes absorb a few milliseconds of
+// main loop jitter.
+#ifndef GENERIC_SAMPLE_QUEUE_DEPTH
+	#define GENERIC_SAMPLE_QUEUE_DEPTH	4
+#endif
+
+// Layout of a high-rate IN report: the LED flags of the low-rate report, then
+// the sample sequence number and the USB frame number when the sample was
+// taken, little endian, then payload bytes that continue the sequence number
+// so the host can check every byte.
+#define GENERIC_SAMPLE_SEQUENCE		4
+#define GENERIC_SAMPLE_FRAME		6
+#define GENERIC_SAMPLE_PAYLOAD		8
+
+#if (GENERIC_REPORT_SIZE < GENERIC_SAMPLE_PAYLOAD)
+	#error GENERIC_HIGH_RATE needs a GENERIC_REPORT_SIZE of at least GENERIC_SAMPLE_PAYLOAD bytes
+#endif
+#endif
+
+// Type Defines:
+// Configuration block, read and written by the host in one feature report
+// (GET_REPORT / SET_REPORT of type Feature, report ID GENERIC_CONFIG_REPORT_ID)
+// and kept in EEPROM. The multi-report mode applies it to its reports, the
+// other modes keep it for the application.
+typedef struct
+{
+	uint8_t Version; // GENERIC_CONFIG_VERSION, blocks of another version are ignored
+	uint8_t SamplePeriodMS; // Update period of the sensor block, at least 1
+	uint8_t ReportMask; // IN reports sent on the interrupt endpoint, bit n for report ID n + 1
+	uint8_t SensorThreshold; // Smallest change of a sensor byte that sends the sensor block
+	uint8_t Reserved[4];
+} ATTR_PACKED Generic_Config_t;
+
+// The block is the whole feature report, and GET_REPORT builds it in the
+// class driver buffer of GENERIC_REPORT_SIZE bytes.
+_Static_assert(sizeof(Generic_Config_t) == GENERIC_CONFIG_REPORT_SIZE, "Generic_Config_t must be GENERIC_CONFIG_REPORT_SIZE bytes");
+_Static_assert(sizeof(Generic_Config_t) <= GENERIC_REPORT_SIZE, "Generic_Config_t must fit into a GENERIC_REPORT_SIZE report");
+
 // Function Prototypes:
 void SetupHardware(void);
+#ifdef GENERIC_HIGH_RATE
+bool Generic_QueueSample(const uint8_t* const Sample);
+#elif !defined(GENERIC_REPORT_IDS)
+void Generic_MarkReportDirty(void);
+#endif
 
 void EVENT_USB_Device_Connect(void);
 void EVENT_USB_Device_Disconnect(void);
+void EVENT_USB_Device_Suspend(void);
+void EVENT_USB_Device_WakeUp(void);
 void EVENT_USB_Device_ConfigurationChanged(void);
 void EVENT_USB_Device_ControlRequest(void);
 void EVENT_USB_Device_StartOfFrame(void);
+void EVENT_USB_Device_Reset(void);
 
 bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
 										 uint8_t* const ReportID,
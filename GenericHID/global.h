@@ -14,6 +14,5 @@
 #endif
 
 #define CYCLES_PER_US	((F_CPU+500000)/1000000)	// cpu cycles per microsecond
-#define MY_DEBUG
 
 #endif
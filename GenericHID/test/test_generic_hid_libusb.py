@@ -1,6 +1,8 @@
 #!/usr/bin/env python
 
+import struct
 import sys
+import time
 from time import sleep
 import usb.core
 import usb.util
@@ -10,6 +12,11 @@ import usb.util
 device_vid = 0x03EB
 device_pid = 0x204F
 
+# Sample layout of the high-rate firmware (GENERIC_HIGH_RATE in
+# GenericHID.h): LED flags, sequence number and frame number, then payload
+GENERIC_SAMPLE_SEQUENCE = 4
+GENERIC_SAMPLE_PAYLOAD = 8
+
 def get_and_init_hid_device():
 	device = usb.core.find(idVendor=device_vid, idProduct=device_pid)
 
@@ -32,6 +39,16 @@ def send_led_pattern(device, led1, led2, led3, led4):
 	# Report data for the demo is LED on/off data
 	report_data = [led1, led2, led3, led4]
 
+	# The high-rate firmware receives reports on an interrupt OUT endpoint,
+	# padded to the full report size
+	out_endpoint = find_endpoint(device, usb.util.ENDPOINT_OUT)
+	if out_endpoint is not None:
+		report_data += [0] * (out_endpoint.wMaxPacketSize - len(report_data))
+		number_of_bytes_written = device.write(out_endpoint.bEndpointAddress, report_data)
+		assert number_of_bytes_written == len(report_data)
+		print("Sent LED Pattern: {0}".format(report_data[0:4]))
+		return
+
 	# Send the generated report to the device
 	number_of_bytes_written = device.ctrl_transfer( # Set Report control request
 	0b00100001,	# bmRequestType (constant for this control request)
@@ -44,11 +61,81 @@ def send_led_pattern(device, led1, led2, led3, led4):
 
 	print("Sent LED Pattern: {0}".format(report_data))
 
+# Configuration block feature report (Generic_Config_t in GenericHID.h):
+# version, sample period in ms, report mask, sensor threshold, reserved
+GENERIC_CONFIG_VERSION = 1
+config_format = "<BBBB4x"
+
+def get_config(device, report_id=0):
+	report_data = device.ctrl_transfer( # Get Report control request
+	0b10100001,	# bmRequestType (constant for this control request)
+	0x01,		# bmRequest (constant for this control request)
+	(3 << 8) | report_id, # wValue (MSB is report type, LSB is report number)
+	0,			# wIndex (interface number)
+	struct.calcsize(config_format) + (1 if report_id else 0)
+	)
+	if report_id:
+		report_data = report_data[1:]
+	return struct.unpack(config_format, bytes(report_data))
+
+def set_config(device, sample_period_ms, report_mask, sensor_threshold, report_id=0):
+	# The whole block goes out in one feature report, the device writes it
+	# to EEPROM in the background
+	report_data = struct.pack(config_format, GENERIC_CONFIG_VERSION, sample_period_ms,
+							  report_mask, sensor_threshold)
+	if report_id:
+		report_data = bytes([report_id]) + report_data
+
+	number_of_bytes_written = device.ctrl_transfer( # Set Report control request
+	0b00100001,	# bmRequestType (constant for this control request)
+	0x09,		# bmRequest (constant for this control request)
+	(3 << 8) | report_id, # wValue (MSB is report type, LSB is report number)
+	0,			# wIndex (interface number)
+	report_data # report data to be sent
+	);
+	assert number_of_bytes_written == len(report_data)
+
+def find_endpoint(device, direction):
+	return usb.util.find_descriptor(device[0][(0,0)],
+		custom_match=lambda e: usb.util.endpoint_direction(e.bEndpointAddress) == direction)
+
 def receive_led_pattern(hid_device):
-	endpoint = hid_device[0][(0,0)][0]
+	endpoint = find_endpoint(hid_device, usb.util.ENDPOINT_IN)
+
+	# Skip the samples the high-rate firmware queued before the pattern was
+	# sent, the last one read carries the current LEDs
 	report_data = hid_device.read(endpoint.bEndpointAddress, endpoint.wMaxPacketSize)
+	if len(report_data) > GENERIC_SAMPLE_PAYLOAD:
+		sleep(0.01)
+		for i in range(8):
+			report_data = hid_device.read(endpoint.bEndpointAddress, endpoint.wMaxPacketSize)
 	return list(report_data)
 
+def measure_rate(hid_device, seconds=5):
+	# Reads reports as fast as they arrive and checks the sequence numbers of
+	# the high-rate samples for gaps
+	endpoint = find_endpoint(hid_device, usb.util.ENDPOINT_IN)
+	reports = 0
+	total_bytes = 0
+	gaps = 0
+	last_sequence = None
+
+	start = time.time()
+	while time.time() - start < seconds:
+		report_data = hid_device.read(endpoint.bEndpointAddress, endpoint.wMaxPacketSize)
+		reports += 1
+		total_bytes += len(report_data)
+
+		if len(report_data) > GENERIC_SAMPLE_PAYLOAD:
+			sequence = report_data[GENERIC_SAMPLE_SEQUENCE] | (report_data[GENERIC_SAMPLE_SEQUENCE + 1] << 8)
+			if last_sequence is not None and sequence != ((last_sequence + 1) & 0xFFFF):
+				gaps += 1
+			last_sequence = sequence
+
+	elapsed = time.time() - start
+	print("{0} reports in {1:.2f} s: {2:.0f} reports/s, {3:.1f} KB/s, {4} sequence gaps".format(
+		reports, elapsed, reports / elapsed, total_bytes / elapsed / 1024, gaps))
+
 def main():
 	hid_device = get_and_init_hid_device()
 
@@ -57,6 +144,21 @@ def main():
 		usb.util.get_string(hid_device, 256, hid_device.iProduct),
 		usb.util.get_string(hid_device, 256, hid_device.iManufacturer)))
 
+	if len(sys.argv) > 1 and sys.argv[1] == "rate":
+		measure_rate(hid_device)
+		return
+
+	# config [report_id [period mask threshold]]: reads, or writes and reads
+	# back, the configuration block. Report ID 4 for the multi-report mode.
+	if len(sys.argv) > 1 and sys.argv[1] == "config":
+		report_id = int(sys.argv[2], 0) if len(sys.argv) > 2 else 0
+		if len(sys.argv) > 5:
+			set_config(hid_device, int(sys.argv[3], 0), int(sys.argv[4], 0), int(sys.argv[5], 0), report_id)
+		version, period, mask, threshold = get_config(hid_device, report_id)
+		print("Config version {0}: sample period {1} ms, report mask {2:#04x}, sensor threshold {3}".format(
+			version, period, mask, threshold))
+		return
+
 	p = 0
 	while (True):
 		# Convert the current pattern index to a bit-mask and send
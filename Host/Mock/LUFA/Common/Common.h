@@ -0,0 +1,50 @@
+// Host stand-in for the LUFA common header. Only the macros used by the
+// firmware and by the mock USB layer are provided.
+#ifndef MOCK_LUFA_COMMON_H
+#define MOCK_LUFA_COMMON_H
+
+// Includes:
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+// Macros:
+#define ATTR_WARN_UNUSED_RESULT		__attribute__ ((warn_unused_result))
+#define ATTR_NON_NULL_PTR_ARG(...)	__attribute__ ((nonnull (__VA_ARGS__)))
+#define ATTR_PACKED					__attribute__ ((packed))
+#define ATTR_ALWAYS_INLINE			__attribute__ ((always_inline))
+#define ATTR_CONST					__attribute__ ((const))
+#define ATTR_PURE					__attribute__ ((pure))
+#define ATTR_WEAK					__attribute__ ((weak))
+#define ATTR_NO_RETURN				__attribute__ ((noreturn))
+
+#define CONCAT(x, y)				x ## y
+#define CONCAT_EXPANDED(x, y)		CONCAT(x, y)
+
+#define MIN(x, y)					(((x) < (y)) ? (x) : (y))
+#define MAX(x, y)					(((x) > (y)) ? (x) : (y))
+
+// The host is little endian like the AVR and the USB bus.
+#define cpu_to_le16(x)				(x)
+
+#define ARCH_AVR8					0
+#ifndef ARCH
+	#define ARCH					ARCH_AVR8
+#endif
+
+// Type Defines:
+typedef uint8_t uint_reg_t;
+
+// The global interrupt flag only holds back the endpoint interrupt of the
+// mock (see MockUSB.h), the other interrupt driven event handlers run when the
+// test fires them. The mask is the I bit of SREG.
+void GlobalInterruptEnable(void);
+void GlobalInterruptDisable(void);
+uint_reg_t GetGlobalInterruptMask(void);
+void SetGlobalInterruptMask(const uint_reg_t GlobalIntState);
+
+// Hands control from the firmware main loop back to the test, see MockUSB.h.
+void Mock_Yield(void);
+
+#endif
@@ -0,0 +1,29 @@
+// Host stand-in for the LUFA board LED driver. The LEDs are a plain variable
+// the tests can inspect.
+#ifndef MOCK_LUFA_LEDS_H
+#define MOCK_LUFA_LEDS_H
+
+#include "../../Common/Common.h"
+
+// Macros:
+#define LEDS_LED1		(1 << 0)
+#define LEDS_LED2		(1 << 1)
+#define LEDS_LED3		(1 << 2)
+#define LEDS_LED4		(1 << 3)
+#define LEDS_ALL_LEDS	(LEDS_LED1 | LEDS_LED2 | LEDS_LED3 | LEDS_LED4)
+#define LEDS_NO_LEDS	0
+
+// Global Variables:
+extern uint8_t Mock_LEDs;
+
+// Inline Functions:
+static inline void LEDs_Init(void) { Mock_LEDs = LEDS_NO_LEDS; }
+static inline void LEDs_Disable(void) {}
+static inline void LEDs_TurnOnLEDs(const uint8_t LEDMask) { Mock_LEDs |= LEDMask; }
+static inline void LEDs_TurnOffLEDs(const uint8_t LEDMask) { Mock_LEDs &= ~LEDMask; }
+static inline void LEDs_SetAllLEDs(const uint8_t LEDMask) { Mock_LEDs = LEDMask; }
+static inline void LEDs_ChangeLEDs(const uint8_t LEDMask, const uint8_t ActiveMask) { Mock_LEDs = (Mock_LEDs & ~LEDMask) | ActiveMask; }
+static inline void LEDs_ToggleLEDs(const uint8_t LEDMask) { Mock_LEDs ^= LEDMask; }
+static inline uint8_t LEDs_GetLEDs(void) { return Mock_LEDs; }
+
+#endif
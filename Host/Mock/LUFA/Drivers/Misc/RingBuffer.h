@@ -0,0 +1,65 @@
+// Host stand-in for the LUFA ring buffer driver, same interface without the
+// atomic blocks.
+#ifndef MOCK_LUFA_RINGBUFFER_H
+#define MOCK_LUFA_RINGBUFFER_H
+
+#include "../../Common/Common.h"
+
+// Type Defines:
+typedef struct
+{
+	uint8_t* In;
+	uint8_t* Out;
+	uint8_t* Start;
+	uint8_t* End;
+	uint16_t Size;
+	uint16_t Count;
+} RingBuffer_t;
+
+// Inline Functions:
+static inline void RingBuffer_InitBuffer(RingBuffer_t* Buffer, uint8_t* const DataPtr, const uint16_t Size)
+{
+	Buffer->In = DataPtr;
+	Buffer->Out = DataPtr;
+	Buffer->Start = &DataPtr[0];
+	Buffer->End = &DataPtr[Size];
+	Buffer->Size = Size;
+	Buffer->Count = 0;
+}
+
+static inline uint16_t RingBuffer_GetCount(RingBuffer_t* const Buffer) { return Buffer->Count; }
+static inline uint16_t RingBuffer_GetFreeCount(RingBuffer_t* const Buffer) { return (Buffer->Size - Buffer->Count); }
+// Polled by the main loop of the interrupt driven builds, which is where the
+// firmware hands control back to the test.
+static inline bool RingBuffer_IsEmpty(RingBuffer_t* const Buffer)
+{
+	Mock_Yield();
+	return (Buffer->Count == 0);
+}
+
+static inline bool RingBuffer_IsFull(RingBuffer_t* const Buffer) { return (Buffer->Count == Buffer->Size); }
+
+static inline void RingBuffer_Insert(RingBuffer_t* Buffer, const uint8_t Data)
+{
+	*Buffer->In = Data;
+
+	if (++Buffer->In == Buffer->End)
+		Buffer->In = Buffer->Start;
+
+	Buffer->Count++;
+}
+
+static inline uint8_t RingBuffer_Remove(RingBuffer_t* Buffer)
+{
+	uint8_t Data = *Buffer->Out;
+
+	if (++Buffer->Out == Buffer->End)
+		Buffer->Out = Buffer->Start;
+
+	Buffer->Count--;
+	return Data;
+}
+
+static inline uint8_t RingBuffer_Peek(RingBuffer_t* const Buffer) { return *Buffer->Out; }
+
+#endif
@@ -0,0 +1,61 @@
+// Host stand-in for the LUFA USB controller and endpoint driver, implemented by
+// MockUSB.c over in-memory endpoint FIFOs. Included by USB.h after the USB
+// types; a build that puts another Core/USBController.h first on the include
+// path (the simulator shim) replaces this one.
+#ifndef MOCK_LUFA_USBCONTROLLER_H
+#define MOCK_LUFA_USBCONTROLLER_H
+
+// External Variables:
+// The firmware waits for the USB interrupts by polling the device state, so
+// every read of it is a point where the firmware hands control back to the
+// test, see Mock_Yield.
+extern volatile uint8_t Mock_DeviceState;
+static inline uint8_t Mock_ReadDeviceState(void)
+{
+	Mock_Yield();
+	return Mock_DeviceState;
+}
+#define USB_DeviceState						Mock_ReadDeviceState()
+
+// Function Prototypes:
+void USB_Init(void);
+void USB_USBTask(void);
+void USB_Device_EnableSOFEvents(void);
+void USB_Device_DisableSOFEvents(void);
+uint16_t USB_Device_GetFrameNumber(void);
+void USB_Device_SendRemoteWakeup(void);
+void USB_Device_ProcessControlRequest(void);
+
+bool Endpoint_ConfigureEndpoint(const uint8_t Address, const uint8_t Type, const uint16_t Size, const uint8_t Banks);
+bool Endpoint_ConfigureEndpointTable(const USB_Endpoint_Table_t* const Table, const uint8_t Entries);
+void Endpoint_ResetEndpoint(const uint8_t Address);
+void Endpoint_SelectEndpoint(const uint8_t Address);
+uint8_t Endpoint_GetCurrentEndpoint(void);
+bool Endpoint_IsConfigured(void);
+bool Endpoint_IsReadWriteAllowed(void);
+bool Endpoint_IsINReady(void);
+bool Endpoint_IsOUTReceived(void);
+bool Endpoint_IsSETUPReceived(void);
+bool Endpoint_IsStalled(void);
+uint16_t Endpoint_BytesInEndpoint(void);
+void Endpoint_ClearIN(void);
+void Endpoint_ClearOUT(void);
+void Endpoint_ClearSETUP(void);
+void Endpoint_StallTransaction(void);
+void Endpoint_ClearStall(void);
+uint8_t Endpoint_WaitUntilReady(void);
+uint8_t Endpoint_Read_8(void);
+void Endpoint_Write_8(const uint8_t Data);
+void Endpoint_Discard_8(void);
+uint16_t Endpoint_Read_16_LE(void);
+void Endpoint_Write_16_LE(const uint16_t Data);
+uint32_t Endpoint_Read_32_LE(void);
+void Endpoint_Write_32_LE(const uint32_t Data);
+uint8_t Endpoint_Write_Stream_LE(const void* const Buffer, uint16_t Length, uint16_t* const BytesProcessed);
+uint8_t Endpoint_Read_Stream_LE(void* const Buffer, uint16_t Length, uint16_t* const BytesProcessed);
+uint8_t Endpoint_Write_Control_Stream_LE(const void* const Buffer, uint16_t Length);
+uint8_t Endpoint_Write_Control_PStream_LE(const void* const Buffer, uint16_t Length);
+uint8_t Endpoint_Read_Control_Stream_LE(void* const Buffer, uint16_t Length);
+void Endpoint_ClearStatusStage(void);
+
+#endif
@@ -0,0 +1,478 @@
+// Host stand-in for the LUFA USB driver (device mode only). It provides the
+// descriptor types, the endpoint and control endpoint API and the CDC and HID
+// class driver interfaces used by the firmware, on top of the in-memory
+// endpoints of MockUSB.c. Names and values follow LUFA 140928.
+#ifndef MOCK_LUFA_USB_H
+#define MOCK_LUFA_USB_H
+
+// Includes:
+#include "../../Common/Common.h"
+
+// Macros:
+#define VERSION_BCD(Major, Minor, Revision)	((((Major) & 0xFF) << 8) | (((Minor) & 0x0F) << 4) | ((Revision) & 0x0F))
+
+#define USB_STREAM_TIMEOUT_MS				100
+
+#define NO_DESCRIPTOR						0
+#define USE_INTERNAL_SERIAL					0xDC
+#define INTERNAL_SERIAL_LENGTH_BITS			80
+#define INTERNAL_SERIAL_START_ADDRESS		0x0E
+
+#define LANGUAGE_ID_ENG						0x0409
+
+#define USB_CONFIG_POWER_MA(mA)				((mA) >> 1)
+#define USB_CONFIG_ATTR_RESERVED			0x80
+#define USB_CONFIG_ATTR_SELFPOWERED			0x40
+#define USB_CONFIG_ATTR_REMOTEWAKEUP		0x20
+
+#define DTYPE_Device						0x01
+#define DTYPE_Configuration					0x02
+#define DTYPE_String						0x03
+#define DTYPE_Interface						0x04
+#define DTYPE_Endpoint						0x05
+#define DTYPE_DeviceQualifier				0x06
+#define DTYPE_Other							0x07
+#define DTYPE_InterfacePower				0x08
+#define DTYPE_InterfaceAssociation			0x0B
+#define DTYPE_CSInterface					0x24
+#define DTYPE_CSEndpoint					0x25
+
+#define USB_CSCP_NoDeviceClass				0x00
+#define USB_CSCP_NoDeviceSubclass			0x00
+#define USB_CSCP_NoDeviceProtocol			0x00
+#define USB_CSCP_VendorSpecificClass		0xFF
+#define USB_CSCP_VendorSpecificSubclass		0xFF
+#define USB_CSCP_VendorSpecificProtocol		0xFF
+#define USB_CSCP_IADDeviceClass				0xEF
+#define USB_CSCP_IADDeviceSubclass			0x02
+#define USB_CSCP_IADDeviceProtocol			0x01
+
+#define ENDPOINT_ATTR_NO_SYNC				(0 << 2)
+#define ENDPOINT_USAGE_DATA					(0 << 4)
+
+#define EP_TYPE_CONTROL						0x00
+#define EP_TYPE_ISOCHRONOUS					0x01
+#define EP_TYPE_BULK						0x02
+#define EP_TYPE_INTERRUPT					0x03
+
+#define ENDPOINT_DIR_MASK					0x80
+#define ENDPOINT_DIR_OUT					0x00
+#define ENDPOINT_DIR_IN						0x80
+#define ENDPOINT_EPNUM_MASK					0x0F
+#define ENDPOINT_CONTROLEP					0
+#define ENDPOINT_TOTAL_ENDPOINTS			7
+
+#define CONTROL_REQTYPE_DIRECTION			0x80
+#define CONTROL_REQTYPE_TYPE				0x60
+#define CONTROL_REQTYPE_RECIPIENT			0x1F
+#define REQDIR_HOSTTODEVICE					(0 << 7)
+#define REQDIR_DEVICETOHOST					(1 << 7)
+#define REQTYPE_STANDARD					(0 << 5)
+#define REQTYPE_CLASS						(1 << 5)
+#define REQTYPE_VENDOR						(2 << 5)
+#define REQREC_DEVICE						(0 << 0)
+#define REQREC_INTERFACE					(1 << 0)
+#define REQREC_ENDPOINT						(2 << 0)
+#define REQREC_OTHER						(3 << 0)
+
+#define USB_STRING_LEN(UnicodeChars)		(sizeof(USB_Descriptor_Header_t) + ((UnicodeChars) << 1))
+#define USB_STRING_DESCRIPTOR(String)		{ .Header = {.Size = sizeof(USB_Descriptor_Header_t) + (sizeof(String) - 2), .Type = DTYPE_String}, .UnicodeString = String }
+#define USB_STRING_DESCRIPTOR_ARRAY(...)	{ .Header = {.Size = sizeof(USB_Descriptor_Header_t) + sizeof((uint16_t[]){__VA_ARGS__}), .Type = DTYPE_String}, .UnicodeString = {__VA_ARGS__} }
+
+// Enums:
+enum USB_Device_States_t
+{
+	DEVICE_STATE_Unattached = 0,
+	DEVICE_STATE_Powered = 1,
+	DEVICE_STATE_Default = 2,
+	DEVICE_STATE_Addressed = 3,
+	DEVICE_STATE_Configured = 4,
+	DEVICE_STATE_Suspended = 5,
+};
+
+enum USB_Feature_Selectors_t
+{
+	FEATURE_SEL_EndpointHalt = 0x00,
+	FEATURE_SEL_DeviceRemoteWakeup = 0x01,
+	FEATURE_SEL_TestMode = 0x02,
+};
+
+enum USB_Control_Request_t
+{
+	REQ_GetStatus = 0,
+	REQ_ClearFeature = 1,
+	REQ_SetFeature = 3,
+	REQ_SetAddress = 5,
+	REQ_GetDescriptor = 6,
+	REQ_SetDescriptor = 7,
+	REQ_GetConfiguration = 8,
+	REQ_SetConfiguration = 9,
+	REQ_GetInterface = 10,
+	REQ_SetInterface = 11,
+	REQ_SynchFrame = 12,
+};
+
+enum Endpoint_WaitUntilReady_ErrorCodes_t
+{
+	ENDPOINT_READYWAIT_NoError = 0,
+	ENDPOINT_READYWAIT_EndpointStalled = 1,
+	ENDPOINT_READYWAIT_DeviceDisconnected = 2,
+	ENDPOINT_READYWAIT_BusSuspended = 3,
+	ENDPOINT_READYWAIT_Timeout = 4,
+};
+
+enum Endpoint_Stream_RW_ErrorCodes_t
+{
+	ENDPOINT_RWSTREAM_NoError = 0,
+	ENDPOINT_RWSTREAM_EndpointStalled = 1,
+	ENDPOINT_RWSTREAM_DeviceDisconnected = 2,
+	ENDPOINT_RWSTREAM_BusSuspended = 3,
+	ENDPOINT_RWSTREAM_Timeout = 4,
+	ENDPOINT_RWSTREAM_IncompleteTransfer = 5,
+};
+
+enum Endpoint_ControlStream_RW_ErrorCodes_t
+{
+	ENDPOINT_RWCSTREAM_NoError = 0,
+	ENDPOINT_RWCSTREAM_HostAborted = 1,
+	ENDPOINT_RWCSTREAM_DeviceDisconnected = 2,
+	ENDPOINT_RWCSTREAM_BusSuspended = 3,
+};
+
+// Type Defines:
+typedef struct
+{
+	uint8_t Size;
+	uint8_t Type;
+} ATTR_PACKED USB_Descriptor_Header_t;
+
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	uint16_t USBSpecification;
+	uint8_t Class;
+	uint8_t SubClass;
+	uint8_t Protocol;
+	uint8_t Endpoint0Size;
+	uint16_t VendorID;
+	uint16_t ProductID;
+	uint16_t ReleaseNumber;
+	uint8_t ManufacturerStrIndex;
+	uint8_t ProductStrIndex;
+	uint8_t SerialNumStrIndex;
+	uint8_t NumberOfConfigurations;
+} ATTR_PACKED USB_Descriptor_Device_t;
+
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	uint16_t TotalConfigurationSize;
+	uint8_t TotalInterfaces;
+	uint8_t ConfigurationNumber;
+	uint8_t ConfigurationStrIndex;
+	uint8_t ConfigAttributes;
+	uint8_t MaxPowerConsumption;
+} ATTR_PACKED USB_Descriptor_Configuration_Header_t;
+
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	uint8_t InterfaceNumber;
+	uint8_t AlternateSetting;
+	uint8_t TotalEndpoints;
+	uint8_t Class;
+	uint8_t SubClass;
+	uint8_t Protocol;
+	uint8_t InterfaceStrIndex;
+} ATTR_PACKED USB_Descriptor_Interface_t;
+
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	uint8_t FirstInterfaceIndex;
+	uint8_t TotalInterfaces;
+	uint8_t Class;
+	uint8_t SubClass;
+	uint8_t Protocol;
+	uint8_t IADStrIndex;
+} ATTR_PACKED USB_Descriptor_Interface_Association_t;
+
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	uint8_t EndpointAddress;
+	uint8_t Attributes;
+	uint16_t EndpointSize;
+	uint8_t PollingIntervalMS;
+} ATTR_PACKED USB_Descriptor_Endpoint_t;
+
+// The host build uses -fshort-wchar, so that wide string literals have the
+// 16-bit characters of the AVR build.
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	wchar_t UnicodeString[];
+} ATTR_PACKED USB_Descriptor_String_t;
+
+typedef struct
+{
+	uint8_t bmRequestType;
+	uint8_t bRequest;
+	uint16_t wValue;
+	uint16_t wIndex;
+	uint16_t wLength;
+} ATTR_PACKED USB_Request_Header_t;
+
+typedef struct
+{
+	uint8_t Address;
+	uint16_t Size;
+	uint8_t Type;
+	uint8_t Banks;
+} USB_Endpoint_Table_t;
+
+// External Variables:
+extern USB_Request_Header_t USB_ControlRequest;
+extern bool USB_Device_RemoteWakeupEnabled;
+extern uint8_t USB_Device_ConfigurationNumber;
+
+// USB controller and endpoint access, the host mock or the simulator shim.
+#include <LUFA/Drivers/USB/Core/USBController.h>
+
+// Application callbacks and events, the mock provides empty defaults for the
+// events the firmware does not handle.
+uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
+									const uint8_t wIndex,
+									const void** const DescriptorAddress)
+									ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(3);
+void EVENT_USB_Device_Connect(void);
+void EVENT_USB_Device_Disconnect(void);
+void EVENT_USB_Device_ConfigurationChanged(void);
+void EVENT_USB_Device_ControlRequest(void);
+void EVENT_USB_Device_StartOfFrame(void);
+void EVENT_USB_Device_Suspend(void);
+void EVENT_USB_Device_WakeUp(void);
+void EVENT_USB_Device_Reset(void);
+
+// CDC Class Driver:
+#define CDC_CSCP_CDCClass					0x02
+#define CDC_CSCP_NoSpecificSubclass			0x00
+#define CDC_CSCP_ACMSubclass				0x02
+#define CDC_CSCP_ATCommandProtocol			0x01
+#define CDC_CSCP_NoSpecificProtocol			0x00
+#define CDC_CSCP_VendorSpecificProtocol		0xFF
+#define CDC_CSCP_CDCDataClass				0x0A
+#define CDC_CSCP_NoDataSubclass				0x00
+#define CDC_CSCP_NoDataProtocol				0x00
+
+#define CDC_DSUBTYPE_CSInterface_Header		0x00
+#define CDC_DSUBTYPE_CSInterface_ACM		0x02
+#define CDC_DSUBTYPE_CSInterface_Union		0x06
+
+#define CDC_REQ_SendEncapsulatedCommand		0x00
+#define CDC_REQ_GetEncapsulatedResponse		0x01
+#define CDC_REQ_SetLineEncoding				0x20
+#define CDC_REQ_GetLineEncoding				0x21
+#define CDC_REQ_SetControlLineState			0x22
+#define CDC_REQ_SendBreak					0x23
+
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	uint8_t Subtype;
+	uint16_t CDCSpecification;
+} ATTR_PACKED USB_CDC_Descriptor_FunctionalHeader_t;
+
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	uint8_t Subtype;
+	uint8_t Capabilities;
+} ATTR_PACKED USB_CDC_Descriptor_FunctionalACM_t;
+
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	uint8_t Subtype;
+	uint8_t MasterInterfaceNumber;
+	uint8_t SlaveInterfaceNumber;
+} ATTR_PACKED USB_CDC_Descriptor_FunctionalUnion_t;
+
+typedef struct
+{
+	uint32_t BaudRateBPS;
+	uint8_t CharFormat;
+	uint8_t ParityType;
+	uint8_t DataBits;
+} ATTR_PACKED CDC_LineEncoding_t;
+
+typedef struct
+{
+	struct
+	{
+		uint8_t ControlInterfaceNumber;
+		USB_Endpoint_Table_t DataINEndpoint;
+		USB_Endpoint_Table_t DataOUTEndpoint;
+		USB_Endpoint_Table_t NotificationEndpoint;
+	} Config;
+	struct
+	{
+		struct
+		{
+			uint16_t HostToDevice;
+			uint16_t DeviceToHost;
+		} ControlLineStates;
+		CDC_LineEncoding_t LineEncoding;
+	} State;
+} USB_ClassInfo_CDC_Device_t;
+
+bool CDC_Device_ConfigureEndpoints(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+void CDC_Device_ProcessControlRequest(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+void CDC_Device_USBTask(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+uint8_t CDC_Device_SendByte(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo, const uint8_t Data) ATTR_NON_NULL_PTR_ARG(1);
+int16_t CDC_Device_ReceiveByte(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+uint16_t CDC_Device_BytesReceived(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+uint8_t CDC_Device_Flush(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+void EVENT_CDC_Device_LineEncodingChanged(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+void EVENT_CDC_Device_ControLineStateChanged(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+void EVENT_CDC_Device_BreakSent(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo, const uint8_t Duration) ATTR_NON_NULL_PTR_ARG(1);
+
+// HID Class Driver:
+#define HID_CSCP_HIDClass					0x03
+#define HID_CSCP_NonBootSubclass			0x00
+#define HID_CSCP_BootSubclass				0x01
+#define HID_CSCP_NonBootProtocol			0x00
+#define HID_CSCP_KeyboardBootProtocol		0x01
+#define HID_CSCP_MouseBootProtocol			0x02
+
+#define HID_DTYPE_HID						0x21
+#define HID_DTYPE_Report					0x22
+
+#define HID_REQ_GetReport					0x01
+#define HID_REQ_GetIdle						0x02
+#define HID_REQ_GetProtocol					0x03
+#define HID_REQ_SetReport					0x09
+#define HID_REQ_SetIdle						0x0A
+#define HID_REQ_SetProtocol					0x0B
+
+#define HID_REPORT_ITEM_In					0
+#define HID_REPORT_ITEM_Out					1
+#define HID_REPORT_ITEM_Feature				2
+
+#define HID_IOF_CONSTANT					(1 << 0)
+#define HID_IOF_DATA						(0 << 0)
+#define HID_IOF_VARIABLE					(1 << 1)
+#define HID_IOF_ARRAY						(0 << 1)
+#define HID_IOF_RELATIVE					(1 << 2)
+#define HID_IOF_ABSOLUTE					(0 << 2)
+#define HID_IOF_WRAP						(1 << 3)
+#define HID_IOF_NO_WRAP						(0 << 3)
+#define HID_IOF_NON_LINEAR					(1 << 4)
+#define HID_IOF_LINEAR						(0 << 4)
+#define HID_IOF_NO_PREFERRED_STATE			(1 << 5)
+#define HID_IOF_PREFERRED_STATE				(0 << 5)
+#define HID_IOF_NULLSTATE					(1 << 6)
+#define HID_IOF_NO_NULL_POSITION			(0 << 6)
+#define HID_IOF_VOLATILE					(1 << 7)
+#define HID_IOF_NON_VOLATILE				(0 << 7)
+
+#define HID_RI_TYPE_MAIN					0x00
+#define HID_RI_TYPE_GLOBAL					0x04
+#define HID_RI_TYPE_LOCAL					0x08
+#define HID_RI_DATA_BITS_0					0x00
+#define HID_RI_DATA_BITS_8					0x01
+#define HID_RI_DATA_BITS_16					0x02
+#define HID_RI_DATA_BITS_32					0x03
+#define HID_RI_DATA_BITS(DataBits)			CONCAT_EXPANDED(HID_RI_DATA_BITS_, DataBits)
+
+#define _HID_RI_ENCODE_0(Data)
+#define _HID_RI_ENCODE_8(Data)				, (Data & 0xFF)
+#define _HID_RI_ENCODE_16(Data)				_HID_RI_ENCODE_8(Data) _HID_RI_ENCODE_8(Data >> 8)
+#define _HID_RI_ENCODE_32(Data)				_HID_RI_ENCODE_16(Data) _HID_RI_ENCODE_16(Data >> 16)
+#define _HID_RI_ENCODE(DataBits, ...)		CONCAT_EXPANDED(_HID_RI_ENCODE_, DataBits(__VA_ARGS__))
+#define _HID_RI_ENTRY(Type, Tag, DataBits, ...)	(Type | Tag | HID_RI_DATA_BITS(DataBits)) _HID_RI_ENCODE(DataBits, (__VA_ARGS__))
+
+#define HID_RI_INPUT(DataBits, ...)			_HID_RI_ENTRY(HID_RI_TYPE_MAIN  , 0x80, DataBits, __VA_ARGS__)
+#define HID_RI_OUTPUT(DataBits, ...)		_HID_RI_ENTRY(HID_RI_TYPE_MAIN  , 0x90, DataBits, __VA_ARGS__)
+#define HID_RI_COLLECTION(DataBits, ...)	_HID_RI_ENTRY(HID_RI_TYPE_MAIN  , 0xA0, DataBits, __VA_ARGS__)
+#define HID_RI_FEATURE(DataBits, ...)		_HID_RI_ENTRY(HID_RI_TYPE_MAIN  , 0xB0, DataBits, __VA_ARGS__)
+#define HID_RI_END_COLLECTION(DataBits, ...)	_HID_RI_ENTRY(HID_RI_TYPE_MAIN  , 0xC0, DataBits, __VA_ARGS__)
+#define HID_RI_USAGE_PAGE(DataBits, ...)	_HID_RI_ENTRY(HID_RI_TYPE_GLOBAL, 0x00, DataBits, __VA_ARGS__)
+#define HID_RI_LOGICAL_MINIMUM(DataBits, ...)	_HID_RI_ENTRY(HID_RI_TYPE_GLOBAL, 0x10, DataBits, __VA_ARGS__)
+#define HID_RI_LOGICAL_MAXIMUM(DataBits, ...)	_HID_RI_ENTRY(HID_RI_TYPE_GLOBAL, 0x20, DataBits, __VA_ARGS__)
+#define HID_RI_REPORT_SIZE(DataBits, ...)	_HID_RI_ENTRY(HID_RI_TYPE_GLOBAL, 0x70, DataBits, __VA_ARGS__)
+#define HID_RI_REPORT_ID(DataBits, ...)		_HID_RI_ENTRY(HID_RI_TYPE_GLOBAL, 0x80, DataBits, __VA_ARGS__)
+#define HID_RI_REPORT_COUNT(DataBits, ...)	_HID_RI_ENTRY(HID_RI_TYPE_GLOBAL, 0x90, DataBits, __VA_ARGS__)
+#define HID_RI_USAGE(DataBits, ...)			_HID_RI_ENTRY(HID_RI_TYPE_LOCAL , 0x00, DataBits, __VA_ARGS__)
+
+#define HID_DESCRIPTOR_VENDOR(VendorPageNum, CollectionUsage, DataINUsage, DataOUTUsage, NumBytes) \
+	HID_RI_USAGE_PAGE(16, (0xFF00 | VendorPageNum)),	\
+	HID_RI_USAGE(8, CollectionUsage),					\
+	HID_RI_COLLECTION(8, 0x01),							\
+		HID_RI_USAGE(8, DataINUsage),					\
+		HID_RI_LOGICAL_MINIMUM(8, 0x00),				\
+		HID_RI_LOGICAL_MAXIMUM(8, 0xFF),				\
+		HID_RI_REPORT_SIZE(8, 0x08),					\
+		HID_RI_REPORT_COUNT(8, NumBytes),				\
+		HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE), \
+		HID_RI_USAGE(8, DataOUTUsage),					\
+		HID_RI_LOGICAL_MINIMUM(8, 0x00),				\
+		HID_RI_LOGICAL_MAXIMUM(8, 0xFF),				\
+		HID_RI_REPORT_SIZE(8, 0x08),					\
+		HID_RI_REPORT_COUNT(8, NumBytes),				\
+		HID_RI_OUTPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE | HID_IOF_NON_VOLATILE), \
+	HID_RI_END_COLLECTION(0)
+
+typedef uint8_t USB_Descriptor_HIDReport_Datatype_t;
+
+typedef struct
+{
+	USB_Descriptor_Header_t Header;
+	uint16_t HIDSpec;
+	uint8_t CountryCode;
+	uint8_t TotalReportDescriptors;
+	uint8_t HIDReportType;
+	uint16_t HIDReportLength;
+} ATTR_PACKED USB_HID_Descriptor_HID_t;
+
+typedef struct
+{
+	struct
+	{
+		uint8_t InterfaceNumber;
+		USB_Endpoint_Table_t ReportINEndpoint;
+		void* PrevReportINBuffer;
+		uint8_t PrevReportINBufferSize;
+	} Config;
+	struct
+	{
+		bool UsingReportProtocol;
+		uint16_t PrevFrameNum;
+		uint16_t IdleCount;
+		uint16_t IdleMSRemaining;
+	} State;
+} USB_ClassInfo_HID_Device_t;
+
+bool HID_Device_ConfigureEndpoints(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+void HID_Device_ProcessControlRequest(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+static inline void HID_Device_MillisecondElapsed(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
+{
+	if (HIDInterfaceInfo->State.IdleMSRemaining)
+		HIDInterfaceInfo->State.IdleMSRemaining--;
+}
+
+bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+										 uint8_t* const ReportID,
+										 const uint8_t ReportType,
+										 void* ReportData,
+										 uint16_t* const ReportSize);
+void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+										  const uint8_t ReportID,
+										  const uint8_t ReportType,
+										  const void* ReportData,
+										  const uint16_t ReportSize);
+
+#endif
@@ -0,0 +1,7 @@
+// Host stand-in for the LUFA platform header.
+#ifndef MOCK_LUFA_PLATFORM_H
+#define MOCK_LUFA_PLATFORM_H
+
+#include "../Common/Common.h"
+
+#endif
@@ -0,0 +1,55 @@
+// Host side of the AVR peripherals used by the firmware.
+#include <stddef.h>
+#include <avr/io.h>
+#include <avr/boot.h>
+
+// Global Variables:
+volatile uint8_t MCUSR;
+volatile uint8_t TCCR1A;
+volatile uint8_t TCCR1B;
+volatile uint16_t TCNT1;
+volatile uint8_t TIFR1;
+volatile uint8_t TIMSK1;
+
+volatile uint8_t DDRE;
+volatile uint8_t PORTE;
+volatile uint8_t PINE = 0xFF;
+volatile uint8_t EICRB;
+volatile uint8_t EIMSK;
+volatile uint8_t EIFR;
+
+volatile uint8_t UDR1;
+volatile uint8_t UCSR1A;
+volatile uint8_t UCSR1B;
+volatile uint8_t UCSR1C;
+volatile uint16_t UBRR1;
+
+// Signature row read by boot_signature_byte_get. The unique ID of the
+// ATmega32U4 is the 10 bytes from INTERNAL_SERIAL_START_ADDRESS (0x0E).
+uint8_t Mock_SignatureRow[MOCK_SIGNATURE_ROW_SIZE] =
+{
+	[0x00] = 0x1E, [0x02] = 0x95, [0x04] = 0x87,
+	[0x0E] = 0x5A, 0x7B, 0x9C, 0xBD, 0xDE, 0xFF, 0x10, 0x31, 0x52, 0x73,
+};
+
+// USART1 interrupt of the event log (Common/EventLog.c), absent from the
+// firmware builds without logging.
+void USART1_UDRE_vect(void) __attribute__ ((weak));
+
+uint16_t Mock_UARTRead(uint8_t* const Buffer, const uint16_t Length)
+{
+	uint16_t Count = 0;
+
+	if (USART1_UDRE_vect == NULL)
+		return 0;
+
+	// The interrupt either writes UDR1 or disables itself.
+	while ((Count < Length) && (UCSR1B & (1 << TXEN1)) && (UCSR1B & (1 << UDRIE1)))
+	{
+		USART1_UDRE_vect();
+		if (UCSR1B & (1 << UDRIE1))
+			Buffer[Count++] = UDR1;
+	}
+
+	return Count;
+}
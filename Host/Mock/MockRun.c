@@ -0,0 +1,126 @@
+// Runs the firmware main loop as a coroutine of the test, on its own stack.
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "MockUSB.h"
+
+// Macros:
+#define MOCK_FIRMWARE_STACK_SIZE	(256 * 1024)
+
+// Global Variables:
+static ucontext_t Mock_TestContext;
+static ucontext_t Mock_FirmwareContext;
+static uint8_t Mock_FirmwareStack[MOCK_FIRMWARE_STACK_SIZE];
+static int (*Mock_FirmwareMain)(void);
+static bool Mock_FirmwareStarted;
+static bool Mock_FirmwareRunning;
+static uint32_t Mock_PassesLeft;
+static uint8_t Mock_InterruptDepth;
+static bool Mock_InterruptsEnabled;
+static bool Mock_InterruptsEnabledOnEntry;
+uint8_t Mock_SleepMode;
+
+static void Mock_FirmwareEntry(void)
+{
+	Mock_FirmwareMain();
+
+	fprintf(stderr, "firmware main returned\n");
+	exit(EXIT_FAILURE);
+}
+
+void Mock_RunFirmware(int (*Main)(void), const uint32_t Passes)
+{
+	if (!Passes)
+		return;
+
+	if (!Mock_FirmwareStarted)
+	{
+		getcontext(&Mock_FirmwareContext);
+		Mock_FirmwareContext.uc_stack.ss_sp = Mock_FirmwareStack;
+		Mock_FirmwareContext.uc_stack.ss_size = sizeof(Mock_FirmwareStack);
+		Mock_FirmwareContext.uc_link = NULL;
+		makecontext(&Mock_FirmwareContext, Mock_FirmwareEntry, 0);
+
+		Mock_FirmwareMain = Main;
+		Mock_FirmwareStarted = true;
+	}
+
+	Mock_PassesLeft = Passes;
+	Mock_FirmwareRunning = true;
+	swapcontext(&Mock_TestContext, &Mock_FirmwareContext);
+	Mock_FirmwareRunning = false;
+}
+
+void Mock_Yield(void)
+{
+	if (!Mock_FirmwareRunning || Mock_InterruptsBlocked())
+		return;
+
+	Mock_Stats.Yields++;
+
+	if (--Mock_PassesLeft == 0)
+		swapcontext(&Mock_FirmwareContext, &Mock_TestContext);
+}
+
+// sleep_cpu of the firmware, the test ends the sleep with the next interrupt
+// it plays.
+void Mock_Sleep(void)
+{
+	Mock_Stats.Sleeps++;
+	Mock_Yield();
+}
+
+// The controller clears the I bit on entry and RETI sets it again, the
+// endpoint interrupt held back in between runs on the way out.
+void Mock_EnterInterrupt(void)
+{
+	if (!(Mock_InterruptDepth++))
+	{
+		Mock_InterruptsEnabledOnEntry = Mock_InterruptsEnabled;
+		Mock_InterruptsEnabled = false;
+	}
+}
+
+void Mock_LeaveInterrupt(void)
+{
+	if (!(--Mock_InterruptDepth))
+	{
+		Mock_InterruptsEnabled = Mock_InterruptsEnabledOnEntry;
+		if (Mock_InterruptsEnabled)
+			Mock_RunPendingInterrupts();
+	}
+}
+
+bool Mock_InterruptsBlocked(void)
+{
+	return (Mock_InterruptDepth || !(Mock_InterruptsEnabled));
+}
+
+// Global interrupt flag of the firmware. Enabling it outside of an interrupt
+// handler runs the endpoint interrupt that was held back.
+void GlobalInterruptEnable(void)
+{
+	Mock_InterruptsEnabled = true;
+	if (!(Mock_InterruptDepth))
+		Mock_RunPendingInterrupts();
+}
+
+void GlobalInterruptDisable(void)
+{
+	Mock_InterruptsEnabled = false;
+}
+
+uint_reg_t GetGlobalInterruptMask(void)
+{
+	return (Mock_InterruptsEnabled ? (1 << SREG_I) : 0);
+}
+
+void SetGlobalInterruptMask(const uint_reg_t GlobalIntState)
+{
+	if (GlobalIntState & (1 << SREG_I))
+		GlobalInterruptEnable();
+	else
+		GlobalInterruptDisable();
+}
@@ -0,0 +1,61 @@
+// avr-libc style stream functions over the put/get pairs of a device stream.
+#include <stdio.h>
+#include "MockUSB.h"
+
+int Mock_fputc(int c, Mock_FILE* stream)
+{
+	if (!(stream->flags & _FDEV_SETUP_WRITE) || (stream->put((char)c, stream) != 0))
+		return EOF;
+
+	return (unsigned char)c;
+}
+
+int Mock_fgetc(Mock_FILE* stream)
+{
+	if (!(stream->flags & _FDEV_SETUP_READ))
+		return EOF;
+
+	int c = stream->get(stream);
+
+	return (c < 0) ? EOF : (unsigned char)c;
+}
+
+size_t Mock_fread(void* ptr, size_t size, size_t nmemb, Mock_FILE* stream)
+{
+	uint8_t* Data = (uint8_t*)ptr;
+
+	// The stream is how the polled and interrupt driven main loops wait for
+	// data, let the test run in between.
+	Mock_Yield();
+
+	for (size_t i = 0; i < nmemb; i++)
+	{
+		for (size_t j = 0; j < size; j++)
+		{
+			int c = Mock_fgetc(stream);
+
+			if (c == EOF)
+				return i;
+
+			*Data++ = c;
+		}
+	}
+
+	return nmemb;
+}
+
+size_t Mock_fwrite(const void* ptr, size_t size, size_t nmemb, Mock_FILE* stream)
+{
+	const uint8_t* Data = (const uint8_t*)ptr;
+
+	for (size_t i = 0; i < nmemb; i++)
+	{
+		for (size_t j = 0; j < size; j++)
+		{
+			if (Mock_fputc(*Data++, stream) == EOF)
+				return i;
+		}
+	}
+
+	return nmemb;
+}
@@ -0,0 +1,826 @@
+// Mock USB device layer: in-memory endpoint FIFOs behind the LUFA Endpoint_*
+// API, and the host side used by the tests. See MockUSB.h.
+#include <avr/boot.h>
+#include <avr/io.h>
+#include "MockUSB.h"
+
+// The mock itself changes the device state without yielding.
+#undef USB_DeviceState
+#define USB_DeviceState Mock_DeviceState
+
+// Type Defines:
+typedef struct
+{
+	uint16_t Length;
+	uint8_t Data[MOCK_MAX_EPSIZE];
+} Mock_Packet_t;
+
+typedef struct
+{
+	bool Configured;
+	uint8_t Address;
+	uint8_t Type;
+	uint16_t Size;
+	uint8_t Banks;
+	volatile uint8_t InterruptEnable; // UEIENX
+	uint8_t PendingInterrupts; // UEIENX bits of the interrupts held back
+
+	// Bank the firmware is writing (IN) or position in the oldest packet (OUT)
+	uint8_t Bank[MOCK_MAX_EPSIZE];
+	uint16_t BankLength;
+	uint16_t ReadIndex;
+
+	Mock_Packet_t FIFO[MOCK_FIFO_DEPTH];
+	uint8_t FIFOHead;
+	uint8_t FIFOCount;
+} Mock_Endpoint_t;
+
+// Global Variables:
+volatile uint8_t Mock_DeviceState;
+USB_Request_Header_t USB_ControlRequest;
+bool USB_Device_RemoteWakeupEnabled;
+uint8_t USB_Device_ConfigurationNumber;
+uint8_t Mock_LEDs;
+Mock_Stats_t Mock_Stats;
+bool Mock_DeferResume;
+
+static Mock_Endpoint_t Mock_Endpoints[ENDPOINT_TOTAL_ENDPOINTS];
+static uint8_t Mock_SelectedEndpoint;
+static bool Mock_SOFEvents;
+static uint16_t Mock_FrameNumber;
+static void (*Mock_HostHook)(void);
+
+// Control transfer state
+static bool Mock_SETUPPending;
+static bool Mock_ControlStalled;
+static uint8_t Mock_ControlOut[MOCK_MAX_CONTROL_DATA];
+static uint16_t Mock_ControlOutIndex;
+static uint8_t Mock_ControlIn[MOCK_MAX_CONTROL_DATA];
+static uint16_t Mock_ControlInLength;
+
+// Default event handlers, the firmware overrides the ones it handles.
+ATTR_WEAK void EVENT_USB_Device_Connect(void) {}
+ATTR_WEAK void EVENT_USB_Device_Disconnect(void) {}
+ATTR_WEAK void EVENT_USB_Device_ConfigurationChanged(void) {}
+ATTR_WEAK void EVENT_USB_Device_ControlRequest(void) {}
+ATTR_WEAK void EVENT_USB_Device_StartOfFrame(void) {}
+ATTR_WEAK void EVENT_USB_Device_Suspend(void) {}
+ATTR_WEAK void EVENT_USB_Device_WakeUp(void) {}
+ATTR_WEAK void EVENT_USB_Device_Reset(void) {}
+ATTR_WEAK void USB_COM_vect(void) {}
+
+static Mock_Endpoint_t* Mock_GetEndpoint(const uint8_t Address)
+{
+	return &Mock_Endpoints[Address & ENDPOINT_EPNUM_MASK];
+}
+
+static Mock_Endpoint_t* Mock_GetSelected(void)
+{
+	return &Mock_Endpoints[Mock_SelectedEndpoint];
+}
+
+static bool Mock_IsIN(const Mock_Endpoint_t* const Endpoint)
+{
+	return ((Endpoint->Address & ENDPOINT_DIR_MASK) == ENDPOINT_DIR_IN);
+}
+
+static Mock_Packet_t* Mock_FIFOTail(Mock_Endpoint_t* const Endpoint)
+{
+	return &Endpoint->FIFO[(Endpoint->FIFOHead + Endpoint->FIFOCount) % MOCK_FIFO_DEPTH];
+}
+
+static void Mock_RunEndpointInterrupt(void)
+{
+	Mock_Stats.EndpointInterrupts++;
+	Mock_EnterInterrupt();
+	USB_COM_vect();
+	Mock_LeaveInterrupt();
+}
+
+// Runs the endpoint interrupt if Enable is set in the UEIENX of Endpoint, or
+// holds it back until the firmware enables the interrupts again.
+static void Mock_EndpointInterrupt(Mock_Endpoint_t* const Endpoint, const uint8_t Enable)
+{
+	if (!(Endpoint->InterruptEnable & (1 << Enable)))
+		return;
+
+	if (Mock_InterruptsBlocked())
+	{
+		Endpoint->PendingInterrupts |= (1 << Enable);
+		return;
+	}
+
+	Mock_RunEndpointInterrupt();
+}
+
+static void Mock_FIFOPop(Mock_Endpoint_t* const Endpoint)
+{
+	Endpoint->FIFOHead = (Endpoint->FIFOHead + 1) % MOCK_FIFO_DEPTH;
+	Endpoint->FIFOCount--;
+}
+
+void Mock_RunPendingInterrupts(void)
+{
+	for (uint8_t Number = 0; Number < ENDPOINT_TOTAL_ENDPOINTS; Number++)
+	{
+		Mock_Endpoint_t* Endpoint = &Mock_Endpoints[Number];
+		uint8_t Pending = (Endpoint->PendingInterrupts & Endpoint->InterruptEnable);
+
+		// An interrupt disarmed in the meantime no longer fires.
+		Endpoint->PendingInterrupts = 0;
+		if (Pending)
+			Mock_RunEndpointInterrupt();
+	}
+}
+
+// Device life cycle
+
+void Mock_Reset(void)
+{
+	memset(Mock_Endpoints, 0, sizeof(Mock_Endpoints));
+	memset(&Mock_Stats, 0, sizeof(Mock_Stats));
+	Mock_SelectedEndpoint = ENDPOINT_CONTROLEP;
+	Mock_SOFEvents = false;
+	Mock_FrameNumber = 0;
+	Mock_HostHook = NULL;
+	Mock_DeferResume = false;
+	USB_DeviceState = DEVICE_STATE_Unattached;
+	USB_Device_RemoteWakeupEnabled = false;
+	USB_Device_ConfigurationNumber = 0;
+}
+
+void Mock_Connect(void)
+{
+	USB_DeviceState = DEVICE_STATE_Powered;
+	EVENT_USB_Device_Connect();
+	USB_DeviceState = DEVICE_STATE_Default;
+	EVENT_USB_Device_Reset();
+	USB_DeviceState = DEVICE_STATE_Addressed;
+}
+
+void Mock_Configure(void)
+{
+	if (USB_DeviceState == DEVICE_STATE_Unattached)
+		Mock_Connect();
+
+	Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_STANDARD | REQREC_DEVICE,
+					 REQ_SetConfiguration, 1, 0, NULL, 0);
+}
+
+void Mock_Disconnect(void)
+{
+	for (uint8_t i = 1; i < ENDPOINT_TOTAL_ENDPOINTS; i++)
+		Mock_Endpoints[i].Configured = false;
+
+	USB_DeviceState = DEVICE_STATE_Unattached;
+	USB_Device_ConfigurationNumber = 0;
+	EVENT_USB_Device_Disconnect();
+}
+
+void Mock_Suspend(void)
+{
+	USB_DeviceState = DEVICE_STATE_Suspended;
+	EVENT_USB_Device_Suspend();
+}
+
+void Mock_WakeUp(void)
+{
+	USB_DeviceState = (USB_Device_ConfigurationNumber ? DEVICE_STATE_Configured : DEVICE_STATE_Addressed);
+	EVENT_USB_Device_WakeUp();
+}
+
+void Mock_StartOfFrame(void)
+{
+	Mock_FrameNumber = (Mock_FrameNumber + 1) & 0x07FF;
+
+	if (Mock_SOFEvents)
+	{
+		Mock_EnterInterrupt();
+		EVENT_USB_Device_StartOfFrame();
+		Mock_LeaveInterrupt();
+	}
+}
+
+void Mock_SetHostHook(void (*Hook)(void))
+{
+	Mock_HostHook = Hook;
+}
+
+// Host side of the data endpoints
+
+bool Mock_HostSendPacket(const uint8_t Address, const void* const Data, const uint16_t Length)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetEndpoint(Address);
+
+	if (!(Endpoint->Configured) || (Length > Endpoint->Size) || (Endpoint->FIFOCount == MOCK_FIFO_DEPTH))
+	{
+		return false;
+	}
+
+	Mock_Packet_t* Packet = Mock_FIFOTail(Endpoint);
+	Packet->Length = Length;
+	if (Length)
+		memcpy(Packet->Data, Data, Length);
+	Endpoint->FIFOCount++;
+
+	Mock_EndpointInterrupt(Endpoint, RXOUTE);
+	return true;
+}
+
+uint16_t Mock_HostWrite(const uint8_t Address, const void* const Data, const uint16_t Length)
+{
+	const uint8_t* Bytes = (const uint8_t*)Data;
+	uint16_t Size = Mock_GetEndpoint(Address)->Size;
+	uint16_t Sent = 0;
+
+	while (Sent < Length)
+	{
+		uint16_t Chunk = MIN(Size, Length - Sent);
+
+		if (!(Mock_HostSendPacket(Address, &Bytes[Sent], Chunk)))
+			break;
+		Sent += Chunk;
+	}
+
+	return Sent;
+}
+
+int16_t Mock_HostReadPacket(const uint8_t Address, void* const Data, const uint16_t MaxLength)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetEndpoint(Address);
+
+	if (!(Endpoint->FIFOCount))
+		return -1;
+
+	Mock_Packet_t* Packet = &Endpoint->FIFO[Endpoint->FIFOHead];
+	uint16_t Length = MIN(Packet->Length, MaxLength);
+
+	if (Length)
+		memcpy(Data, Packet->Data, Length);
+	Mock_FIFOPop(Endpoint);
+
+	Mock_EndpointInterrupt(Endpoint, TXINE);
+	return Length;
+}
+
+uint16_t Mock_HostRead(const uint8_t Address, void* const Data, const uint16_t Length)
+{
+	uint8_t* Bytes = (uint8_t*)Data;
+	uint16_t Size = Mock_GetEndpoint(Address)->Size;
+	uint16_t Received = 0;
+
+	while (Received < Length)
+	{
+		int16_t Chunk = Mock_HostReadPacket(Address, &Bytes[Received], Length - Received);
+
+		if (Chunk < 0)
+			break;
+
+		Received += Chunk;
+		if (Chunk < Size)
+			break;
+	}
+
+	return Received;
+}
+
+uint8_t Mock_PendingPackets(const uint8_t Address)
+{
+	return Mock_GetEndpoint(Address)->FIFOCount;
+}
+
+// Host side of the control endpoint
+
+static void Mock_StandardRequest(void)
+{
+	uint8_t DescriptorType = (USB_ControlRequest.wValue >> 8);
+
+	switch (USB_ControlRequest.bRequest)
+	{
+		case REQ_GetDescriptor:
+			if ((USB_ControlRequest.bmRequestType & CONTROL_REQTYPE_TYPE) != REQTYPE_STANDARD)
+				break;
+
+			if ((DescriptorType == DTYPE_String) && ((USB_ControlRequest.wValue & 0xFF) == USE_INTERNAL_SERIAL))
+			{
+				// Same digits as the LUFA internal serial, from the mock signature row:
+				// the nibbles of the unique ID, low nibble first.
+				static const char Hex[] = "0123456789ABCDEF";
+				uint8_t Descriptor[2 + (INTERNAL_SERIAL_LENGTH_BITS / 4) * 2];
+
+				Descriptor[0] = sizeof(Descriptor);
+				Descriptor[1] = DTYPE_String;
+				for (uint8_t i = 0; i < (INTERNAL_SERIAL_LENGTH_BITS / 4); i++)
+				{
+					uint8_t SerialByte = boot_signature_byte_get(INTERNAL_SERIAL_START_ADDRESS + (i / 2));
+
+					Descriptor[2 + (i * 2)] = Hex[((i & 0x01) ? (SerialByte >> 4) : SerialByte) & 0x0F];
+					Descriptor[3 + (i * 2)] = 0;
+				}
+
+				Endpoint_ClearSETUP();
+				Endpoint_Write_Control_Stream_LE(Descriptor, sizeof(Descriptor));
+				Endpoint_ClearOUT();
+			}
+			else
+			{
+				const void* DescriptorPointer;
+				uint16_t DescriptorSize;
+
+				if ((DescriptorSize = CALLBACK_USB_GetDescriptor(USB_ControlRequest.wValue,
+																 USB_ControlRequest.wIndex,
+																 &DescriptorPointer)) == NO_DESCRIPTOR)
+				{
+					break;
+				}
+
+				Endpoint_ClearSETUP();
+				Endpoint_Write_Control_PStream_LE(DescriptorPointer, DescriptorSize);
+				Endpoint_ClearOUT();
+			}
+			break;
+		case REQ_SetConfiguration:
+			Endpoint_ClearSETUP();
+			Endpoint_ClearStatusStage();
+			USB_Device_ConfigurationNumber = (USB_ControlRequest.wValue & 0xFF);
+			USB_DeviceState = (USB_Device_ConfigurationNumber ? DEVICE_STATE_Configured : DEVICE_STATE_Addressed);
+			EVENT_USB_Device_ConfigurationChanged();
+			break;
+		case REQ_GetConfiguration:
+			Endpoint_ClearSETUP();
+			Endpoint_Write_8(USB_Device_ConfigurationNumber);
+			Endpoint_ClearIN();
+			Endpoint_ClearStatusStage();
+			break;
+		case REQ_SetFeature:
+		case REQ_ClearFeature:
+			if (((USB_ControlRequest.bmRequestType & CONTROL_REQTYPE_RECIPIENT) == REQREC_DEVICE) &&
+				(USB_ControlRequest.wValue == FEATURE_SEL_DeviceRemoteWakeup))
+			{
+				USB_Device_RemoteWakeupEnabled = (USB_ControlRequest.bRequest == REQ_SetFeature);
+				Endpoint_ClearSETUP();
+				Endpoint_ClearStatusStage();
+			}
+			break;
+	}
+}
+
+int16_t Mock_HostControl(const uint8_t bmRequestType, const uint8_t bRequest,
+						 const uint16_t wValue, const uint16_t wIndex,
+						 void* const Data, const uint16_t wLength)
+{
+	USB_ControlRequest.bmRequestType = bmRequestType;
+	USB_ControlRequest.bRequest = bRequest;
+	USB_ControlRequest.wValue = wValue;
+	USB_ControlRequest.wIndex = wIndex;
+	USB_ControlRequest.wLength = wLength;
+
+	Mock_ControlOutIndex = 0;
+	Mock_ControlInLength = 0;
+	Mock_ControlStalled = false;
+	if (!(bmRequestType & REQDIR_DEVICETOHOST) && wLength)
+		memcpy(Mock_ControlOut, Data, MIN(wLength, MOCK_MAX_CONTROL_DATA));
+
+	Mock_SETUPPending = true;
+	Mock_EndpointInterrupt(&Mock_Endpoints[ENDPOINT_CONTROLEP], RXSTPE);
+
+	// A SETUP the endpoint interrupt left is handled by USB_USBTask in the
+	// firmware main loop, which the mock stands in for here.
+	if (Mock_SETUPPending)
+	{
+		uint8_t PrevSelectedEndpoint = Mock_SelectedEndpoint;
+		Mock_SelectedEndpoint = ENDPOINT_CONTROLEP;
+
+		Mock_EnterInterrupt();
+		USB_Device_ProcessControlRequest();
+		Mock_LeaveInterrupt();
+
+		Mock_SelectedEndpoint = PrevSelectedEndpoint;
+	}
+
+	if (Mock_ControlStalled)
+		return -1;
+
+	if (bmRequestType & REQDIR_DEVICETOHOST)
+	{
+		uint16_t Length = MIN(Mock_ControlInLength, wLength);
+		if (Length)
+			memcpy(Data, Mock_ControlIn, Length);
+		return Length;
+	}
+
+	return 0;
+}
+
+// LUFA USB driver
+
+// Same order as the LUFA control request handler: the application event
+// first, then the standard requests it left unhandled, and a stall for a
+// request nobody handled.
+void USB_Device_ProcessControlRequest(void)
+{
+	EVENT_USB_Device_ControlRequest();
+
+	if (Mock_SETUPPending)
+		Mock_StandardRequest();
+
+	if (Mock_SETUPPending)
+	{
+		Mock_SETUPPending = false;
+		Mock_ControlStalled = true;
+	}
+}
+
+void USB_Init(void)
+{
+	// Repeated initialization from the firmware keeps the state the test set up.
+}
+
+void USB_USBTask(void)
+{
+	if (Mock_HostHook)
+		Mock_HostHook();
+
+	Mock_Yield();
+}
+
+void USB_Device_EnableSOFEvents(void)
+{
+	Mock_SOFEvents = true;
+}
+
+void USB_Device_DisableSOFEvents(void)
+{
+	Mock_SOFEvents = false;
+}
+
+uint16_t USB_Device_GetFrameNumber(void)
+{
+	return Mock_FrameNumber;
+}
+
+void USB_Device_SendRemoteWakeup(void)
+{
+	// The host resumes the bus at once, and the wakeup interrupt follows.
+	if (USB_Device_RemoteWakeupEnabled && (USB_DeviceState == DEVICE_STATE_Suspended))
+	{
+		Mock_Stats.RemoteWakeups++;
+		if (Mock_DeferResume)
+			return;
+
+		Mock_EnterInterrupt();
+		Mock_WakeUp();
+		Mock_LeaveInterrupt();
+	}
+}
+
+// LUFA endpoint driver
+
+bool Endpoint_ConfigureEndpoint(const uint8_t Address, const uint8_t Type, const uint16_t Size, const uint8_t Banks)
+{
+	uint8_t Number = (Address & ENDPOINT_EPNUM_MASK);
+
+	if ((Number == 0) || (Number >= ENDPOINT_TOTAL_ENDPOINTS) || (Size > MOCK_MAX_EPSIZE) ||
+		(Banks < 1) || (Banks > 2))
+	{
+		return false;
+	}
+
+	Mock_Endpoint_t* Endpoint = &Mock_Endpoints[Number];
+	Endpoint->Configured = true;
+	Endpoint->Address = Address;
+	Endpoint->Type = Type;
+	Endpoint->Size = Size;
+	Endpoint->Banks = Banks;
+	Endpoint->BankLength = 0;
+	Endpoint->ReadIndex = 0;
+	return true;
+}
+
+bool Endpoint_ConfigureEndpointTable(const USB_Endpoint_Table_t* const Table, const uint8_t Entries)
+{
+	for (uint8_t i = 0; i < Entries; i++)
+	{
+		if (!(Table[i].Address))
+			continue;
+
+		if (!(Endpoint_ConfigureEndpoint(Table[i].Address, Table[i].Type, Table[i].Size, Table[i].Banks)))
+			return false;
+	}
+
+	return true;
+}
+
+void Endpoint_ResetEndpoint(const uint8_t Address)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetEndpoint(Address);
+
+	Endpoint->BankLength = 0;
+	Endpoint->ReadIndex = 0;
+	Endpoint->FIFOHead = 0;
+	Endpoint->FIFOCount = 0;
+}
+
+void Endpoint_SelectEndpoint(const uint8_t Address)
+{
+	Mock_SelectedEndpoint = (Address & ENDPOINT_EPNUM_MASK);
+}
+
+volatile uint8_t* Mock_UEIENX(void)
+{
+	return &Mock_GetSelected()->InterruptEnable;
+}
+
+uint8_t Endpoint_GetCurrentEndpoint(void)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+
+	return (Mock_SelectedEndpoint | (Endpoint->Address & ENDPOINT_DIR_MASK));
+}
+
+bool Endpoint_IsConfigured(void)
+{
+	return Mock_GetSelected()->Configured;
+}
+
+bool Endpoint_IsINReady(void)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+
+	if (Mock_SelectedEndpoint == ENDPOINT_CONTROLEP)
+		return true;
+
+	if (!(Endpoint->Configured) || !(Mock_IsIN(Endpoint)))
+		return false;
+
+	// A firmware polling for a free bank waits for the host, let it read. An
+	// interrupt does not wait, and the host may be the one it interrupted.
+	if ((Endpoint->FIFOCount >= Endpoint->Banks) && Mock_HostHook && !(Mock_InterruptsBlocked()))
+	{
+		uint8_t SelectedEndpoint = Mock_SelectedEndpoint;
+
+		Mock_HostHook();
+		Mock_SelectedEndpoint = SelectedEndpoint;
+	}
+
+	return (Endpoint->FIFOCount < Endpoint->Banks);
+}
+
+bool Endpoint_IsOUTReceived(void)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+
+	if (Mock_SelectedEndpoint == ENDPOINT_CONTROLEP)
+		return (Mock_ControlOutIndex < USB_ControlRequest.wLength);
+
+	return (Endpoint->Configured && !(Mock_IsIN(Endpoint)) && Endpoint->FIFOCount);
+}
+
+bool Endpoint_IsReadWriteAllowed(void)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+
+	if (Mock_IsIN(Endpoint))
+		return (Endpoint_IsINReady() && (Endpoint->BankLength < Endpoint->Size));
+	else
+		return (Endpoint_IsOUTReceived() && Endpoint_BytesInEndpoint());
+}
+
+bool Endpoint_IsSETUPReceived(void)
+{
+	return ((Mock_SelectedEndpoint == ENDPOINT_CONTROLEP) && Mock_SETUPPending);
+}
+
+bool Endpoint_IsStalled(void)
+{
+	return ((Mock_SelectedEndpoint == ENDPOINT_CONTROLEP) && Mock_ControlStalled);
+}
+
+uint16_t Endpoint_BytesInEndpoint(void)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+
+	if (Mock_SelectedEndpoint == ENDPOINT_CONTROLEP)
+		return (USB_ControlRequest.wLength - Mock_ControlOutIndex);
+
+	if (Mock_IsIN(Endpoint))
+		return Endpoint->BankLength;
+
+	if (!(Endpoint->FIFOCount))
+		return 0;
+
+	return (Endpoint->FIFO[Endpoint->FIFOHead].Length - Endpoint->ReadIndex);
+}
+
+void Endpoint_ClearIN(void)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+
+	if ((Mock_SelectedEndpoint == ENDPOINT_CONTROLEP) || !(Mock_IsIN(Endpoint)))
+		return;
+
+	if (Endpoint->FIFOCount < MOCK_FIFO_DEPTH)
+	{
+		Mock_Packet_t* Packet = Mock_FIFOTail(Endpoint);
+		Packet->Length = Endpoint->BankLength;
+		memcpy(Packet->Data, Endpoint->Bank, Endpoint->BankLength);
+		Endpoint->FIFOCount++;
+	}
+
+	Mock_Stats.PacketsIn++;
+	Mock_Stats.BytesIn += Endpoint->BankLength;
+	Endpoint->BankLength = 0;
+}
+
+void Endpoint_ClearOUT(void)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+
+	if ((Mock_SelectedEndpoint == ENDPOINT_CONTROLEP) || Mock_IsIN(Endpoint) || !(Endpoint->FIFOCount))
+		return;
+
+	Mock_Stats.PacketsOut++;
+	Mock_Stats.BytesOut += Endpoint->FIFO[Endpoint->FIFOHead].Length;
+	Mock_FIFOPop(Endpoint);
+	Endpoint->ReadIndex = 0;
+}
+
+void Endpoint_ClearSETUP(void)
+{
+	Mock_SETUPPending = false;
+}
+
+void Endpoint_StallTransaction(void)
+{
+	if (Mock_SelectedEndpoint == ENDPOINT_CONTROLEP)
+		Mock_ControlStalled = true;
+}
+
+void Endpoint_ClearStall(void)
+{
+	if (Mock_SelectedEndpoint == ENDPOINT_CONTROLEP)
+		Mock_ControlStalled = false;
+}
+
+uint8_t Endpoint_WaitUntilReady(void)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+	uint8_t SelectedEndpoint = Mock_SelectedEndpoint;
+
+	// Every call of the host hook stands for one millisecond of the firmware
+	// spinning here, up to the LUFA stream timeout.
+	for (uint8_t TimeoutMSRem = USB_STREAM_TIMEOUT_MS; ; TimeoutMSRem--)
+	{
+		if (USB_DeviceState == DEVICE_STATE_Unattached)
+			return ENDPOINT_READYWAIT_DeviceDisconnected;
+
+		if (Mock_IsIN(Endpoint) ? Endpoint_IsINReady() : Endpoint_IsOUTReceived())
+			return ENDPOINT_READYWAIT_NoError;
+
+		if (!(TimeoutMSRem) || !(Mock_HostHook))
+			break;
+
+		Mock_HostHook();
+		Mock_SelectedEndpoint = SelectedEndpoint;
+	}
+
+	Mock_Stats.WaitTimeouts++;
+	return ENDPOINT_READYWAIT_Timeout;
+}
+
+uint8_t Endpoint_Read_8(void)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+
+	if (Mock_SelectedEndpoint == ENDPOINT_CONTROLEP)
+		return (Mock_ControlOutIndex < USB_ControlRequest.wLength) ? Mock_ControlOut[Mock_ControlOutIndex++] : 0;
+
+	if (Mock_IsIN(Endpoint) || !(Endpoint->FIFOCount))
+		return 0;
+
+	Mock_Packet_t* Packet = &Endpoint->FIFO[Endpoint->FIFOHead];
+	return (Endpoint->ReadIndex < Packet->Length) ? Packet->Data[Endpoint->ReadIndex++] : 0;
+}
+
+void Endpoint_Write_8(const uint8_t Data)
+{
+	Mock_Endpoint_t* Endpoint = Mock_GetSelected();
+
+	if (Mock_SelectedEndpoint == ENDPOINT_CONTROLEP)
+	{
+		if (Mock_ControlInLength < MOCK_MAX_CONTROL_DATA)
+			Mock_ControlIn[Mock_ControlInLength++] = Data;
+		return;
+	}
+
+	if (Mock_IsIN(Endpoint) && (Endpoint->BankLength < Endpoint->Size))
+		Endpoint->Bank[Endpoint->BankLength++] = Data;
+}
+
+void Endpoint_Discard_8(void)
+{
+	Endpoint_Read_8();
+}
+
+uint16_t Endpoint_Read_16_LE(void)
+{
+	uint16_t Data = Endpoint_Read_8();
+
+	return (Data | ((uint16_t)Endpoint_Read_8() << 8));
+}
+
+void Endpoint_Write_16_LE(const uint16_t Data)
+{
+	Endpoint_Write_8(Data & 0xFF);
+	Endpoint_Write_8(Data >> 8);
+}
+
+uint32_t Endpoint_Read_32_LE(void)
+{
+	uint32_t Data = Endpoint_Read_16_LE();
+
+	return (Data | ((uint32_t)Endpoint_Read_16_LE() << 16));
+}
+
+void Endpoint_Write_32_LE(const uint32_t Data)
+{
+	Endpoint_Write_16_LE(Data & 0xFFFF);
+	Endpoint_Write_16_LE(Data >> 16);
+}
+
+uint8_t Endpoint_Write_Stream_LE(const void* const Buffer, uint16_t Length, uint16_t* const BytesProcessed)
+{
+	const uint8_t* Data = (const uint8_t*)Buffer;
+	uint8_t ErrorCode;
+
+	while (Length)
+	{
+		if (!(Endpoint_IsReadWriteAllowed()))
+		{
+			Endpoint_ClearIN();
+
+			if ((ErrorCode = Endpoint_WaitUntilReady()) != ENDPOINT_READYWAIT_NoError)
+				return ErrorCode;
+		}
+
+		Endpoint_Write_8(*Data++);
+		Length--;
+	}
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+uint8_t Endpoint_Read_Stream_LE(void* const Buffer, uint16_t Length, uint16_t* const BytesProcessed)
+{
+	uint8_t* Data = (uint8_t*)Buffer;
+	uint8_t ErrorCode;
+
+	while (Length)
+	{
+		if (!(Endpoint_IsReadWriteAllowed()))
+		{
+			Endpoint_ClearOUT();
+
+			if ((ErrorCode = Endpoint_WaitUntilReady()) != ENDPOINT_READYWAIT_NoError)
+				return ErrorCode;
+		}
+
+		*Data++ = Endpoint_Read_8();
+		Length--;
+	}
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+uint8_t Endpoint_Write_Control_Stream_LE(const void* const Buffer, uint16_t Length)
+{
+	const uint8_t* Data = (const uint8_t*)Buffer;
+
+	if (Length > USB_ControlRequest.wLength)
+		Length = USB_ControlRequest.wLength;
+
+	while (Length--)
+		Endpoint_Write_8(*Data++);
+
+	return ENDPOINT_RWCSTREAM_NoError;
+}
+
+uint8_t Endpoint_Write_Control_PStream_LE(const void* const Buffer, uint16_t Length)
+{
+	// Flash and SRAM share the address space on the host.
+	return Endpoint_Write_Control_Stream_LE(Buffer, Length);
+}
+
+uint8_t Endpoint_Read_Control_Stream_LE(void* const Buffer, uint16_t Length)
+{
+	uint8_t* Data = (uint8_t*)Buffer;
+
+	while (Length--)
+		*Data++ = Endpoint_Read_8();
+
+	return ENDPOINT_RWCSTREAM_NoError;
+}
+
+void Endpoint_ClearStatusStage(void)
+{
+}
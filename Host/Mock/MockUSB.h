@@ -0,0 +1,116 @@
+// Test-side interface of the mock USB device layer. The firmware talks to the
+// LUFA style Endpoint_* API, the tests play the host through the Mock_Host*
+// functions below. Every endpoint has an in-memory packet FIFO: packets the
+// host writes to an OUT endpoint wait there until the firmware clears them,
+// at most Banks of them are visible to the firmware at a time like on the
+// controller; packets the firmware clears on an IN endpoint wait there until
+// the host reads them, and the IN endpoint is only ready while fewer than
+// Banks packets are waiting.
+//
+// UEIENX holds the interrupt enables of the selected endpoint. The mock runs
+// USB_COM_vect, as the controller would, when the host sends a packet to an
+// OUT endpoint with RXOUTE set, reads a packet from an IN endpoint with TXINE
+// set, or sends a SETUP with RXSTPE set on the control endpoint. While the
+// firmware has the interrupts disabled, or runs an interrupt handler, the
+// interrupt is held back until it enables them again, and only runs if the
+// firmware left it armed. A SETUP the interrupt did not handle is handled as
+// USB_USBTask would.
+#ifndef MOCKUSB_H
+#define MOCKUSB_H
+
+// Includes:
+#include <LUFA/Drivers/USB/USB.h>
+
+// Macros:
+// Largest endpoint size supported by the controller.
+#define MOCK_MAX_EPSIZE			256
+
+// Number of packets each endpoint FIFO can hold.
+#define MOCK_FIFO_DEPTH			64
+
+// Largest control transfer data stage.
+#define MOCK_MAX_CONTROL_DATA	512
+
+// Type Defines:
+typedef struct
+{
+	uint32_t PacketsIn; // Packets cleared by the firmware on IN endpoints
+	uint32_t PacketsOut; // Packets cleared by the firmware on OUT endpoints
+	uint32_t BytesIn;
+	uint32_t BytesOut;
+	uint32_t WaitTimeouts; // Endpoint_WaitUntilReady calls that found no free bank
+	uint32_t Yields; // Mock_Yield calls from the firmware main loop
+	uint32_t Sleeps; // sleep_cpu calls
+	uint32_t RemoteWakeups; // USB_Device_SendRemoteWakeup calls that signalled resume
+	uint32_t EndpointInterrupts; // USB_COM_vect runs for an enabled endpoint interrupt
+} Mock_Stats_t;
+
+// Global Variables:
+extern Mock_Stats_t Mock_Stats;
+
+// The host resumes the bus at once on a remote wakeup, unless this is set:
+// the bus then stays suspended until the test calls Mock_WakeUp.
+extern bool Mock_DeferResume;
+
+// Function Prototypes:
+// USB endpoint interrupt, ISR(USB_COM_vect) of the firmware or an empty default.
+void USB_COM_vect(void);
+
+// Device life cycle, fires the matching EVENT_USB_Device_* handlers.
+void Mock_Reset(void);
+void Mock_Connect(void);
+void Mock_Configure(void);
+void Mock_Disconnect(void);
+void Mock_Suspend(void);
+void Mock_WakeUp(void);
+void Mock_StartOfFrame(void);
+
+// Host side of the data endpoints, Address is the endpoint address including
+// its direction bit. Mock_HostSendPacket queues one packet (Length 0 for a
+// zero length packet) and returns false if the endpoint is not configured,
+// the packet is larger than the endpoint or the FIFO is full. Mock_HostReadPacket returns the length of the oldest
+// packet sent by the firmware, or -1 if there is none.
+bool Mock_HostSendPacket(const uint8_t Address, const void* const Data, const uint16_t Length);
+uint16_t Mock_HostWrite(const uint8_t Address, const void* const Data, const uint16_t Length);
+int16_t Mock_HostReadPacket(const uint8_t Address, void* const Data, const uint16_t MaxLength);
+uint16_t Mock_HostRead(const uint8_t Address, void* const Data, const uint16_t Length);
+uint8_t Mock_PendingPackets(const uint8_t Address);
+
+// Host side of the control endpoint. Runs one control transfer through the
+// firmware and the standard request handler, returns the number of bytes of
+// the IN data stage copied to Data, or -1 if the request was stalled or left
+// unhandled. Data holds the OUT data stage for host to device requests.
+int16_t Mock_HostControl(const uint8_t bmRequestType, const uint8_t bRequest,
+						 const uint16_t wValue, const uint16_t wIndex,
+						 void* const Data, const uint16_t wLength);
+
+// Called from USB_USBTask on every main loop pass, from
+// Endpoint_WaitUntilReady while the firmware waits for a bank and when the
+// firmware polls an IN endpoint without a free bank. Lets the test play the
+// host concurrently with the firmware.
+void Mock_SetHostHook(void (*Hook)(void));
+
+// Runs the firmware main loop for the given number of USB_USBTask passes. The
+// firmware runs on its own stack and keeps its state between calls, Main is
+// only entered on the first call.
+void Mock_RunFirmware(int (*Main)(void), const uint32_t Passes);
+
+// Called by the mock layer on every USB_USBTask pass, every read of
+// USB_DeviceState and every poll of a LUFA ring buffer or stdio stream, which
+// covers the main loops that do not run USB_USBTask and the loops that wait
+// for an interrupt. Hands control back to the test once the passes given
+// to Mock_RunFirmware are used up, never from an interrupt handler.
+void Mock_Yield(void);
+
+// Bracket the event handlers the mock fires in place of the USB interrupts.
+void Mock_EnterInterrupt(void);
+void Mock_LeaveInterrupt(void);
+
+// True inside an interrupt handler and while the firmware has the interrupts
+// disabled (GlobalInterruptDisable).
+bool Mock_InterruptsBlocked(void);
+
+// Runs the endpoint interrupt held back while the interrupts were blocked.
+void Mock_RunPendingInterrupts(void);
+
+#endif
@@ -0,0 +1,20 @@
+// Host stand-in for the avr-libc bootloader support header, only the
+// signature row read. Tests may change Mock_SignatureRow before the firmware
+// starts.
+#ifndef MOCK_AVR_BOOT_H
+#define MOCK_AVR_BOOT_H
+
+#include <stdint.h>
+
+// Macros:
+#define MOCK_SIGNATURE_ROW_SIZE		0x20
+
+// Global Variables:
+extern uint8_t Mock_SignatureRow[MOCK_SIGNATURE_ROW_SIZE];
+
+static inline uint8_t boot_signature_byte_get(const uint16_t Address)
+{
+	return Mock_SignatureRow[Address % MOCK_SIGNATURE_ROW_SIZE];
+}
+
+#endif
@@ -0,0 +1,31 @@
+// Host stand-in for the avr-libc EEPROM driver. EEMEM variables are plain
+// zero initialized variables, and writes complete immediately.
+#ifndef MOCK_AVR_EEPROM_H
+#define MOCK_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Macros:
+#define EEMEM
+
+// Function Prototypes:
+void Mock_Yield(void);
+
+// Polled by the main loop of the interrupt driven builds, which is where the
+// firmware hands control back to the test.
+static inline int eeprom_is_ready(void)
+{
+	Mock_Yield();
+	return 1;
+}
+
+static inline uint8_t eeprom_read_byte(const uint8_t* const Address) { return *Address; }
+static inline void eeprom_update_byte(uint8_t* const Address, const uint8_t Value) { *Address = Value; }
+static inline void eeprom_read_block(void* const Destination, const void* const Source, const size_t Length)
+{
+	memcpy(Destination, Source, Length);
+}
+
+#endif
@@ -0,0 +1,14 @@
+// Host stand-in for the avr-libc interrupt header. Interrupt service routines
+// become plain functions the tests call in place of the hardware.
+#ifndef MOCK_AVR_INTERRUPT_H
+#define MOCK_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+// Macros:
+#define ISR(vector, ...)	void vector(void); void vector(void)
+
+static inline void sei(void) {}
+static inline void cli(void) {}
+
+#endif
@@ -0,0 +1,75 @@
+// Host stand-in for the avr-libc register definitions. Registers are plain
+// variables, only the ones the firmware touches are provided.
+#ifndef MOCK_AVR_IO_H
+#define MOCK_AVR_IO_H
+
+#include <stdint.h>
+
+// Macros:
+#define _BV(bit)	(1 << (bit))
+
+// Global interrupt enable of SREG
+#define SREG_I		7
+
+#define WDRF		3
+#define CS10		0
+#define TOV1		0
+#define TOIE1		0
+
+// PORTE and external interrupt 6
+#define PE6			6
+#define ISC60		4
+#define ISC61		5
+#define INT6		6
+#define INTF6		6
+
+// USART1
+#define U2X1		1
+#define UCSZ10		1
+#define UCSZ11		2
+#define TXEN1		3
+#define UDRIE1		5
+
+// USB endpoint interrupt enables
+#define TXINE		0
+#define RXOUTE		2
+#define RXSTPE		3
+
+// Enables of the selected endpoint, the mock endpoint layer raises the
+// interrupts (MockUSB.h).
+#define UEIENX		(*Mock_UEIENX())
+
+// Global Variables:
+extern volatile uint8_t MCUSR;
+
+// Timer1 does not run, TCNT1 only changes when a test writes it.
+extern volatile uint8_t TCCR1A;
+extern volatile uint8_t TCCR1B;
+extern volatile uint16_t TCNT1;
+extern volatile uint8_t TIFR1;
+extern volatile uint8_t TIMSK1;
+
+// Port E, the inputs read high as with the pull-ups until a test drives them.
+extern volatile uint8_t DDRE;
+extern volatile uint8_t PORTE;
+extern volatile uint8_t PINE;
+extern volatile uint8_t EICRB;
+extern volatile uint8_t EIMSK;
+extern volatile uint8_t EIFR;
+
+// USART1 only transmits when a test calls Mock_UARTRead.
+extern volatile uint8_t UDR1;
+extern volatile uint8_t UCSR1A;
+extern volatile uint8_t UCSR1B;
+extern volatile uint8_t UCSR1C;
+extern volatile uint16_t UBRR1;
+
+// Function Prototypes:
+volatile uint8_t* Mock_UEIENX(void);
+
+// Sends up to Length bytes on USART1 into Buffer by running the data register
+// empty interrupt as long as the firmware keeps it enabled, returns the
+// number of bytes sent.
+uint16_t Mock_UARTRead(uint8_t* const Buffer, const uint16_t Length);
+
+#endif
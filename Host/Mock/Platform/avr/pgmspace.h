@@ -0,0 +1,19 @@
+// Host stand-in for the avr-libc program space utilities, flash and SRAM share
+// one address space on the host.
+#ifndef MOCK_AVR_PGMSPACE_H
+#define MOCK_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Macros:
+#define PROGMEM
+#define PSTR(s)					(s)
+#define pgm_read_byte(addr)		(*(const uint8_t*)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)	(*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr)		(*(void* const*)(addr))
+#define memcpy_P				memcpy
+#define strlen_P				strlen
+
+#endif
@@ -0,0 +1,15 @@
+// Host stand-in for the avr-libc power reduction and clock prescaler driver.
+#ifndef MOCK_AVR_POWER_H
+#define MOCK_AVR_POWER_H
+
+typedef enum
+{
+	clock_div_1 = 0,
+	clock_div_2 = 1,
+	clock_div_4 = 2,
+	clock_div_8 = 3,
+} clock_div_t;
+
+static inline void clock_prescale_set(const clock_div_t Divider) { (void)Divider; }
+
+#endif
@@ -0,0 +1,29 @@
+// Host stand-in for the avr-libc sleep mode driver. Sleeping hands control
+// back to the test, which plays the interrupt that ends the sleep.
+#ifndef MOCK_AVR_SLEEP_H
+#define MOCK_AVR_SLEEP_H
+
+#include <stdint.h>
+
+// Macros:
+#define SLEEP_MODE_IDLE			0
+#define SLEEP_MODE_ADC			1
+#define SLEEP_MODE_PWR_DOWN		2
+#define SLEEP_MODE_PWR_SAVE		3
+#define SLEEP_MODE_STANDBY		6
+#define SLEEP_MODE_EXT_STANDBY	7
+
+// Global Variables:
+// Mode of the last set_sleep_mode.
+extern uint8_t Mock_SleepMode;
+
+// Function Prototypes:
+// Counts the sleep in Mock_Stats and yields, see MockUSB.h.
+void Mock_Sleep(void);
+
+static inline void set_sleep_mode(const uint8_t Mode) { Mock_SleepMode = Mode; }
+static inline void sleep_enable(void) {}
+static inline void sleep_disable(void) {}
+static inline void sleep_cpu(void) { Mock_Sleep(); }
+
+#endif
@@ -0,0 +1,8 @@
+// Host stand-in for the avr-libc watchdog driver.
+#ifndef MOCK_AVR_WDT_H
+#define MOCK_AVR_WDT_H
+
+static inline void wdt_disable(void) {}
+static inline void wdt_reset(void) {}
+
+#endif
@@ -0,0 +1,14 @@
+// Host stand-in for the AVRlib global defines.
+#ifndef AVRLIBDEFS_H
+#define AVRLIBDEFS_H
+
+// Macros:
+#ifndef BV
+	#define BV(bit)			(1 << (bit))
+#endif
+#define cbi(reg, bit)		(reg &= ~(BV(bit)))
+#define sbi(reg, bit)		(reg |= (BV(bit)))
+#define inb(addr)			(addr)
+#define outb(addr, data)	(addr) = (data)
+
+#endif
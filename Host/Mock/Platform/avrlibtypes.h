@@ -0,0 +1,21 @@
+// Host stand-in for the AVRlib type definitions.
+#ifndef AVRLIBTYPES_H
+#define AVRLIBTYPES_H
+
+#include <stdint.h>
+
+// Macros:
+#ifndef FALSE
+	#define FALSE	0
+	#define TRUE	-1
+#endif
+
+// Type Defines:
+typedef uint8_t		u08;
+typedef int8_t		s08;
+typedef uint16_t	u16;
+typedef int16_t		s16;
+typedef uint32_t	u32;
+typedef int32_t		s32;
+
+#endif
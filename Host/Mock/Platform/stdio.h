@@ -0,0 +1,49 @@
+// Host stand-in for the avr-libc stdio streams. The host C library is included
+// first, then FILE and the stream functions the firmware uses are replaced by
+// the avr-libc style device streams (put/get function pairs with user data).
+#include_next <stdio.h>
+
+#ifndef MOCK_STDIO_H
+#define MOCK_STDIO_H
+
+#include <stdint.h>
+
+// Type Defines:
+typedef struct Mock_FILE
+{
+	uint8_t flags;
+	int (*put)(char, struct Mock_FILE*);
+	int (*get)(struct Mock_FILE*);
+	void* udata;
+} Mock_FILE;
+
+// Macros:
+#define _FDEV_SETUP_READ	0x01
+#define _FDEV_SETUP_WRITE	0x02
+#define _FDEV_SETUP_RW		(_FDEV_SETUP_READ | _FDEV_SETUP_WRITE)
+
+#define _FDEV_ERR			(-1)
+#define _FDEV_EOF			(-2)
+
+#define FDEV_SETUP_STREAM(p, g, f)	{ .flags = f, .put = p, .get = g, .udata = 0 }
+#define fdev_set_udata(stream, u)	do { (stream)->udata = (u); } while (0)
+#define fdev_get_udata(stream)		((stream)->udata)
+
+#define FILE				Mock_FILE
+
+#undef fread
+#undef fwrite
+#undef fputc
+#undef fgetc
+#define fread				Mock_fread
+#define fwrite				Mock_fwrite
+#define fputc				Mock_fputc
+#define fgetc				Mock_fgetc
+
+// Function Prototypes:
+size_t Mock_fread(void* ptr, size_t size, size_t nmemb, Mock_FILE* stream);
+size_t Mock_fwrite(const void* ptr, size_t size, size_t nmemb, Mock_FILE* stream);
+int Mock_fputc(int c, Mock_FILE* stream);
+int Mock_fgetc(Mock_FILE* stream);
+
+#endif
@@ -0,0 +1,14 @@
+// Host stand-in for the avr-libc atomic block macros. The mock plays its
+// interrupts between firmware calls, so the block only runs its body once.
+#ifndef MOCK_UTIL_ATOMIC_H
+#define MOCK_UTIL_ATOMIC_H
+
+#include <stdint.h>
+
+// Macros:
+#define ATOMIC_RESTORESTATE		1
+#define ATOMIC_FORCEON			2
+
+#define ATOMIC_BLOCK(Type)		for (uint8_t MockAtomicOnce = (Type); MockAtomicOnce; MockAtomicOnce = 0)
+
+#endif
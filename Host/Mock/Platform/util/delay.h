@@ -0,0 +1,8 @@
+// Host stand-in for the avr-libc busy-wait delays, which return at once.
+#ifndef MOCK_UTIL_DELAY_H
+#define MOCK_UTIL_DELAY_H
+
+static inline void _delay_ms(const double Milliseconds) { (void)Milliseconds; }
+static inline void _delay_us(const double Microseconds) { (void)Microseconds; }
+
+#endif
@@ -0,0 +1,528 @@
+// libusb-1.0 implementation of the Bulk Vendor client, see BulkVendorClient.h.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <libusb.h>
+
+#include "BulkVendorClient.h"
+
+// Macros:
+#define BVCLIENT_DEFAULT_TRANSFERS		8
+#define BVCLIENT_DEFAULT_TRANSFER_SIZE	512
+#define BVCLIENT_DEFAULT_RECEIVE_SIZE	(64UL * 1024)
+#define BVCLIENT_DEFAULT_TIMEOUT_MS		1000
+
+#define BVCLIENT_MIN(x, y)				(((x) < (y)) ? (x) : (y))
+
+// Type Defines:
+struct BVClient
+{
+	libusb_context* Context;
+	libusb_device_handle* Handle;
+	BVClient_Config_t Config;
+	bool InterfaceClaimed;
+	bool Closing;
+	int Error; // First failed transfer, sticky
+
+	struct libusb_transfer* ReadTransfers[BVCLIENT_MAX_TRANSFERS];
+	uint32_t ReadsInFlight;
+	BVClient_ReadCallback_t ReadCallback;
+	void* ReadUserData;
+
+	struct libusb_transfer* WriteTransfers[BVCLIENT_MAX_TRANSFERS];
+	bool WriteBusy[BVCLIENT_MAX_TRANSFERS];
+	uint32_t WritesInFlight;
+	BVClient_WriteCallback_t WriteCallback;
+	void* WriteUserData;
+
+	// Receive ring of the polled reads, and the completed IN transfers that
+	// did not fit into it yet, oldest first.
+	uint8_t* Ring;
+	uint32_t RingHead;
+	uint32_t RingCount;
+	struct libusb_transfer* Held[BVCLIENT_MAX_TRANSFERS];
+	uint32_t HeldCount;
+	uint32_t HeldOffset; // Bytes of the oldest held transfer already in the ring
+};
+
+static int BVClient_StatusError(const enum libusb_transfer_status Status)
+{
+	switch (Status)
+	{
+		case LIBUSB_TRANSFER_COMPLETED:
+			return LIBUSB_SUCCESS;
+		case LIBUSB_TRANSFER_TIMED_OUT:
+			return LIBUSB_ERROR_TIMEOUT;
+		case LIBUSB_TRANSFER_STALL:
+			return LIBUSB_ERROR_PIPE;
+		case LIBUSB_TRANSFER_NO_DEVICE:
+			return LIBUSB_ERROR_NO_DEVICE;
+		case LIBUSB_TRANSFER_OVERFLOW:
+			return LIBUSB_ERROR_OVERFLOW;
+		default:
+			return LIBUSB_ERROR_IO;
+	}
+}
+
+static void BVClient_SetError(BVClient_t* const Client, const int Error)
+{
+	if (!(Client->Error))
+		Client->Error = Error;
+}
+
+static void BVClient_SubmitRead(BVClient_t* const Client, struct libusb_transfer* const Transfer)
+{
+	int Error;
+
+	if (Client->Closing || Client->Error)
+		return;
+
+	Transfer->length = Client->Config.TransferSize;
+	if ((Error = libusb_submit_transfer(Transfer)) != LIBUSB_SUCCESS)
+		BVClient_SetError(Client, Error);
+	else
+		Client->ReadsInFlight++;
+}
+
+// Moves received bytes into the ring, false if they did not all fit.
+static bool BVClient_RingInsert(BVClient_t* const Client, const uint8_t* Data, uint32_t* const Length)
+{
+	uint32_t Size = Client->Config.ReceiveBufferSize;
+	uint32_t Count = BVCLIENT_MIN(*Length, Size - Client->RingCount);
+
+	for (uint32_t i = 0; i < Count; i++)
+		Client->Ring[(Client->RingHead + Client->RingCount + i) % Size] = Data[i];
+
+	Client->RingCount += Count;
+	*Length -= Count;
+	return !(*Length);
+}
+
+// Moves the held IN transfers into the ring as far as it has room, and
+// queues them again once they are empty.
+static void BVClient_ReleaseHeld(BVClient_t* const Client)
+{
+	while (Client->HeldCount)
+	{
+		struct libusb_transfer* Transfer = Client->Held[0];
+		uint32_t Remaining = (Transfer->actual_length - Client->HeldOffset);
+		uint32_t Length = Remaining;
+
+		bool Emptied = BVClient_RingInsert(Client, &Transfer->buffer[Client->HeldOffset], &Length);
+		Client->HeldOffset += (Remaining - Length);
+		if (!(Emptied))
+			return;
+
+		Client->HeldCount--;
+		memmove(&Client->Held[0], &Client->Held[1], Client->HeldCount * sizeof(Client->Held[0]));
+		Client->HeldOffset = 0;
+		BVClient_SubmitRead(Client, Transfer);
+	}
+}
+
+static void LIBUSB_CALL BVClient_ReadComplete(struct libusb_transfer* Transfer)
+{
+	BVClient_t* Client = (BVClient_t*)Transfer->user_data;
+
+	Client->ReadsInFlight--;
+	if (Client->Closing || (Transfer->status == LIBUSB_TRANSFER_CANCELLED))
+		return;
+
+	if (Transfer->status != LIBUSB_TRANSFER_COMPLETED)
+	{
+		BVClient_SetError(Client, BVClient_StatusError(Transfer->status));
+		return;
+	}
+
+	if (Client->ReadCallback)
+	{
+		Client->ReadCallback(Client->ReadUserData, Transfer->buffer, Transfer->actual_length);
+		BVClient_SubmitRead(Client, Transfer);
+		return;
+	}
+
+	// Keep the order: behind held transfers, or held itself when the ring
+	// is full.
+	Client->Held[Client->HeldCount++] = Transfer;
+	BVClient_ReleaseHeld(Client);
+}
+
+static void LIBUSB_CALL BVClient_WriteComplete(struct libusb_transfer* Transfer)
+{
+	BVClient_t* Client = (BVClient_t*)Transfer->user_data;
+	int Status = BVClient_StatusError(Transfer->status);
+
+	for (uint8_t i = 0; i < Client->Config.WriteTransfers; i++)
+	{
+		if (Client->WriteTransfers[i] == Transfer)
+			Client->WriteBusy[i] = false;
+	}
+	Client->WritesInFlight--;
+
+	if (Client->Closing || (Transfer->status == LIBUSB_TRANSFER_CANCELLED))
+		return;
+
+	if (Status != LIBUSB_SUCCESS)
+		BVClient_SetError(Client, Status);
+
+	if (Client->WriteCallback)
+		Client->WriteCallback(Client->WriteUserData, Transfer->actual_length, Status);
+}
+
+static struct libusb_transfer* BVClient_AllocTransfer(BVClient_t* const Client, const uint8_t Endpoint,
+													  const libusb_transfer_cb_fn Callback, const unsigned int TimeoutMS)
+{
+	struct libusb_transfer* Transfer = libusb_alloc_transfer(0);
+	uint8_t* Buffer = malloc(Client->Config.TransferSize);
+
+	if (!(Transfer) || !(Buffer))
+	{
+		libusb_free_transfer(Transfer);
+		free(Buffer);
+		return NULL;
+	}
+
+	libusb_fill_bulk_transfer(Transfer, Client->Handle, Endpoint, Buffer, Client->Config.TransferSize,
+							  Callback, Client, TimeoutMS);
+	return Transfer;
+}
+
+static bool BVClient_IsBulkVendor(libusb_device* const Device)
+{
+	struct libusb_device_descriptor Descriptor;
+
+	if (libusb_get_device_descriptor(Device, &Descriptor) != LIBUSB_SUCCESS)
+		return false;
+
+	return (Descriptor.idVendor == BVCLIENT_VENDOR_ID) && (Descriptor.idProduct == BVCLIENT_PRODUCT_ID);
+}
+
+// Reads the serial number and the device path of a Bulk Vendor device.
+static int BVClient_GetDeviceInfo(libusb_device* const Device, BVClient_DeviceInfo_t* const Info)
+{
+	struct libusb_device_descriptor Descriptor;
+	libusb_device_handle* Handle;
+	uint8_t Ports[7]; // Deepest hub tree allowed by the USB specification
+	int PortCount;
+	int Length;
+	int Error;
+
+	if ((Error = libusb_get_device_descriptor(Device, &Descriptor)) != LIBUSB_SUCCESS)
+		return Error;
+
+	if ((PortCount = libusb_get_port_numbers(Device, Ports, sizeof(Ports))) < 0)
+		return PortCount;
+
+	Length = snprintf(Info->Path, sizeof(Info->Path), "%u-", libusb_get_bus_number(Device));
+	for (int i = 0; i < PortCount; i++)
+		Length += snprintf(&Info->Path[Length], sizeof(Info->Path) - Length, i ? ".%u" : "%u", Ports[i]);
+
+	if ((Error = libusb_open(Device, &Handle)) != LIBUSB_SUCCESS)
+		return Error;
+
+	Error = libusb_get_string_descriptor_ascii(Handle, Descriptor.iSerialNumber, (unsigned char*)Info->Serial,
+											   sizeof(Info->Serial));
+	libusb_close(Handle);
+
+	return (Error < 0) ? Error : LIBUSB_SUCCESS;
+}
+
+// Opens the Bulk Vendor device with serial number Serial, or the first one if
+// Serial is NULL.
+static int BVClient_OpenDevice(libusb_context* const Context, const char* const Serial,
+							   libusb_device_handle** const Handle)
+{
+	libusb_device** Devices;
+	ssize_t Count;
+	int Error = LIBUSB_ERROR_NO_DEVICE;
+
+	if ((Count = libusb_get_device_list(Context, &Devices)) < 0)
+		return (int)Count;
+
+	for (ssize_t i = 0; i < Count; i++)
+	{
+		BVClient_DeviceInfo_t Info;
+
+		if (!(BVClient_IsBulkVendor(Devices[i])))
+			continue;
+
+		if (Serial && ((BVClient_GetDeviceInfo(Devices[i], &Info) != LIBUSB_SUCCESS) || strcmp(Info.Serial, Serial)))
+			continue;
+
+		Error = libusb_open(Devices[i], Handle);
+		break;
+	}
+
+	libusb_free_device_list(Devices, 1);
+	return Error;
+}
+
+int BVClient_ListDevices(BVClient_DeviceInfo_t* const Devices, const uint32_t MaxDevices)
+{
+	libusb_context* Context;
+	libusb_device** List;
+	ssize_t Count;
+	int Found = 0;
+	int Error;
+
+	if ((Error = libusb_init(&Context)) != LIBUSB_SUCCESS)
+		return Error;
+
+	if ((Count = libusb_get_device_list(Context, &List)) < 0)
+	{
+		libusb_exit(Context);
+		return (int)Count;
+	}
+
+	for (ssize_t i = 0; (i < Count) && ((uint32_t)Found < MaxDevices); i++)
+	{
+		// Devices that can not be opened, e.g. without permission, are left out
+		if (BVClient_IsBulkVendor(List[i]) && (BVClient_GetDeviceInfo(List[i], &Devices[Found]) == LIBUSB_SUCCESS))
+			Found++;
+	}
+
+	libusb_free_device_list(List, 1);
+	libusb_exit(Context);
+	return Found;
+}
+
+int BVClient_Open(BVClient_t** const Client, const BVClient_Config_t* const Config)
+{
+	return BVClient_OpenSerial(Client, Config, NULL);
+}
+
+int BVClient_OpenSerial(BVClient_t** const Client, const BVClient_Config_t* const Config, const char* const Serial)
+{
+	BVClient_t* NewClient = calloc(1, sizeof(BVClient_t));
+	int Error;
+
+	*Client = NULL;
+	if (!(NewClient))
+		return LIBUSB_ERROR_NO_MEM;
+
+	if (Config)
+		NewClient->Config = *Config;
+	if (!(NewClient->Config.ReadTransfers))
+		NewClient->Config.ReadTransfers = BVCLIENT_DEFAULT_TRANSFERS;
+	if (!(NewClient->Config.WriteTransfers))
+		NewClient->Config.WriteTransfers = BVCLIENT_DEFAULT_TRANSFERS;
+	if (!(NewClient->Config.TransferSize))
+		NewClient->Config.TransferSize = BVCLIENT_DEFAULT_TRANSFER_SIZE;
+	if (!(NewClient->Config.ReceiveBufferSize))
+		NewClient->Config.ReceiveBufferSize = BVCLIENT_DEFAULT_RECEIVE_SIZE;
+	if (!(NewClient->Config.WriteTimeoutMS))
+		NewClient->Config.WriteTimeoutMS = BVCLIENT_DEFAULT_TIMEOUT_MS;
+
+	if ((NewClient->Config.ReadTransfers > BVCLIENT_MAX_TRANSFERS) ||
+		(NewClient->Config.WriteTransfers > BVCLIENT_MAX_TRANSFERS))
+	{
+		free(NewClient);
+		return LIBUSB_ERROR_INVALID_PARAM;
+	}
+
+	if ((Error = libusb_init(&NewClient->Context)) != LIBUSB_SUCCESS)
+	{
+		free(NewClient);
+		return Error;
+	}
+
+	if ((Error = BVClient_OpenDevice(NewClient->Context, Serial, &NewClient->Handle)) != LIBUSB_SUCCESS)
+	{
+		BVClient_Close(NewClient);
+		return Error;
+	}
+
+	if ((Error = libusb_claim_interface(NewClient->Handle, BVCLIENT_INTERFACE)) != LIBUSB_SUCCESS)
+	{
+		BVClient_Close(NewClient);
+		return Error;
+	}
+	NewClient->InterfaceClaimed = true;
+
+	if (!(NewClient->Ring = malloc(NewClient->Config.ReceiveBufferSize)))
+	{
+		BVClient_Close(NewClient);
+		return LIBUSB_ERROR_NO_MEM;
+	}
+
+	for (uint8_t i = 0; i < NewClient->Config.WriteTransfers; i++)
+	{
+		if (!(NewClient->WriteTransfers[i] = BVClient_AllocTransfer(NewClient, BVCLIENT_OUT_EPADDR, BVClient_WriteComplete,
+																	NewClient->Config.WriteTimeoutMS)))
+		{
+			BVClient_Close(NewClient);
+			return LIBUSB_ERROR_NO_MEM;
+		}
+	}
+
+	for (uint8_t i = 0; i < NewClient->Config.ReadTransfers; i++)
+	{
+		if (!(NewClient->ReadTransfers[i] = BVClient_AllocTransfer(NewClient, BVCLIENT_IN_EPADDR, BVClient_ReadComplete, 0)))
+		{
+			BVClient_Close(NewClient);
+			return LIBUSB_ERROR_NO_MEM;
+		}
+
+		BVClient_SubmitRead(NewClient, NewClient->ReadTransfers[i]);
+	}
+
+	if ((Error = NewClient->Error))
+	{
+		BVClient_Close(NewClient);
+		return Error;
+	}
+
+	*Client = NewClient;
+	return LIBUSB_SUCCESS;
+}
+
+void BVClient_Close(BVClient_t* const Client)
+{
+	if (!(Client))
+		return;
+
+	Client->Closing = true;
+
+	// Cancel everything still queued and wait for the cancellations.
+	for (uint8_t i = 0; i < BVCLIENT_MAX_TRANSFERS; i++)
+	{
+		if (Client->ReadTransfers[i])
+			libusb_cancel_transfer(Client->ReadTransfers[i]);
+		if (Client->WriteTransfers[i] && Client->WriteBusy[i])
+			libusb_cancel_transfer(Client->WriteTransfers[i]);
+	}
+
+	while (Client->ReadsInFlight || Client->WritesInFlight)
+	{
+		if (libusb_handle_events(Client->Context) != LIBUSB_SUCCESS)
+			break;
+	}
+
+	for (uint8_t i = 0; i < BVCLIENT_MAX_TRANSFERS; i++)
+	{
+		if (Client->ReadTransfers[i])
+			free(Client->ReadTransfers[i]->buffer);
+		if (Client->WriteTransfers[i])
+			free(Client->WriteTransfers[i]->buffer);
+		libusb_free_transfer(Client->ReadTransfers[i]);
+		libusb_free_transfer(Client->WriteTransfers[i]);
+	}
+
+	if (Client->InterfaceClaimed)
+		libusb_release_interface(Client->Handle, BVCLIENT_INTERFACE);
+	if (Client->Handle)
+		libusb_close(Client->Handle);
+	if (Client->Context)
+		libusb_exit(Client->Context);
+
+	free(Client->Ring);
+	free(Client);
+}
+
+void BVClient_SetReadCallback(BVClient_t* const Client, const BVClient_ReadCallback_t Callback, void* const UserData)
+{
+	Client->ReadCallback = Callback;
+	Client->ReadUserData = UserData;
+}
+
+void BVClient_SetWriteCallback(BVClient_t* const Client, const BVClient_WriteCallback_t Callback, void* const UserData)
+{
+	Client->WriteCallback = Callback;
+	Client->WriteUserData = UserData;
+}
+
+int BVClient_Write(BVClient_t* const Client, const void* const Data, const uint32_t Length)
+{
+	const uint8_t* Buffer = (const uint8_t*)Data;
+	uint32_t Accepted = 0;
+
+	if (Client->Error)
+		return Client->Error;
+
+	for (uint8_t i = 0; (i < Client->Config.WriteTransfers) && (Accepted < Length); i++)
+	{
+		if (Client->WriteBusy[i])
+			continue;
+
+		struct libusb_transfer* Transfer = Client->WriteTransfers[i];
+		uint32_t Count = BVCLIENT_MIN(Length - Accepted, Client->Config.TransferSize);
+		int Error;
+
+		memcpy(Transfer->buffer, &Buffer[Accepted], Count);
+		Transfer->length = Count;
+		if ((Error = libusb_submit_transfer(Transfer)) != LIBUSB_SUCCESS)
+		{
+			BVClient_SetError(Client, Error);
+			return (Accepted ? (int)Accepted : Error);
+		}
+
+		Client->WriteBusy[i] = true;
+		Client->WritesInFlight++;
+		Accepted += Count;
+	}
+
+	return Accepted;
+}
+
+int BVClient_Read(BVClient_t* const Client, void* const Data, const uint32_t Length)
+{
+	uint8_t* Buffer = (uint8_t*)Data;
+	uint32_t Size = Client->Config.ReceiveBufferSize;
+	uint32_t Count = BVCLIENT_MIN(Length, Client->RingCount);
+
+	for (uint32_t i = 0; i < Count; i++)
+		Buffer[i] = Client->Ring[(Client->RingHead + i) % Size];
+
+	Client->RingHead = (Client->RingHead + Count) % Size;
+	Client->RingCount -= Count;
+
+	BVClient_ReleaseHeld(Client);
+
+	if (!(Count) && Client->Error)
+		return Client->Error;
+
+	return Count;
+}
+
+int BVClient_Poll(BVClient_t* const Client, const unsigned int TimeoutMS)
+{
+	struct timeval Timeout = {.tv_sec = (TimeoutMS / 1000), .tv_usec = ((TimeoutMS % 1000) * 1000)};
+	int Error;
+
+	if ((Error = libusb_handle_events_timeout_completed(Client->Context, &Timeout, NULL)) != LIBUSB_SUCCESS)
+		BVClient_SetError(Client, Error);
+
+	return Client->Error;
+}
+
+int BVClient_Flush(BVClient_t* const Client, const unsigned int TimeoutMS)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	uint64_t DeadlineMS = ((uint64_t)Now.tv_sec * 1000) + (Now.tv_nsec / 1000000) + TimeoutMS;
+
+	while (Client->WritesInFlight && !(Client->Error))
+	{
+		clock_gettime(CLOCK_MONOTONIC, &Now);
+		uint64_t NowMS = ((uint64_t)Now.tv_sec * 1000) + (Now.tv_nsec / 1000000);
+		if (NowMS >= DeadlineMS)
+			return LIBUSB_ERROR_TIMEOUT;
+
+		BVClient_Poll(Client, (unsigned int)(DeadlineMS - NowMS));
+	}
+
+	return Client->Error;
+}
+
+uint32_t BVClient_WritesPending(const BVClient_t* const Client)
+{
+	return Client->WritesInFlight;
+}
+
+uint32_t BVClient_BytesAvailable(const BVClient_t* const Client)
+{
+	return Client->RingCount;
+}
@@ -0,0 +1,105 @@
+// Host client library for the Bulk Vendor device (VID 0x03EB, PID 0x206C).
+// Keeps a queue of libusb asynchronous bulk transfers on both data endpoints,
+// so the pipe stays full instead of one synchronous round trip per packet:
+//	- ReadTransfers IN transfers are always queued on endpoint 3; received
+//	  data goes to the read callback, or to a receive ring that BVClient_Read
+//	  polls. While the ring is full, completed IN transfers are held back and
+//	  the device is NAKed, nothing is dropped.
+//	- BVClient_Write splits the data into transfers of TransferSize bytes and
+//	  queues up to WriteTransfers of them on endpoint 4 without blocking.
+// Completions, and with them the callbacks, only happen inside BVClient_Poll
+// and BVClient_Flush. All functions return a negative libusb_error code once
+// a transfer has failed, the error is sticky until the client is closed.
+#ifndef BULKVENDORCLIENT_H
+#define BULKVENDORCLIENT_H
+
+// Includes:
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Macros:
+#define BVCLIENT_VENDOR_ID			0x03EB
+#define BVCLIENT_PRODUCT_ID			0x206C
+#define BVCLIENT_INTERFACE			0
+#define BVCLIENT_IN_EPADDR			0x83
+#define BVCLIENT_OUT_EPADDR			0x04
+
+// Largest number of transfers queued per direction.
+#define BVCLIENT_MAX_TRANSFERS		32
+
+// Digits of the serial number, the unique ID of the board in hex.
+#define BVCLIENT_SERIAL_LENGTH		20
+
+// Room for a device path "<bus>-<port>[.<port>...]", the name of the device in
+// /sys/bus/usb/devices on Linux.
+#define BVCLIENT_PATH_LENGTH		32
+
+// Type Defines:
+typedef struct BVClient BVClient_t;
+
+// Called with the data of every completed IN transfer, in order.
+typedef void (*BVClient_ReadCallback_t)(void* const UserData, const uint8_t* const Data, const uint32_t Length);
+
+// Called for every completed OUT transfer, Status is 0 or a libusb_error code.
+typedef void (*BVClient_WriteCallback_t)(void* const UserData, const uint32_t Length, const int Status);
+
+typedef struct
+{
+	uint8_t ReadTransfers; // IN transfers kept queued, 8 by default
+	uint8_t WriteTransfers; // OUT transfers in flight at most, 8 by default
+	uint32_t TransferSize; // Bytes per transfer, 512 by default; an IN transfer also completes on a short packet
+	uint32_t ReceiveBufferSize; // Receive ring of the polled reads, 64 KB by default
+	unsigned int WriteTimeoutMS; // 1000 by default, IN transfers never time out
+} BVClient_Config_t;
+
+typedef struct
+{
+	char Serial[BVCLIENT_SERIAL_LENGTH + 1];
+	char Path[BVCLIENT_PATH_LENGTH];
+} BVClient_DeviceInfo_t;
+
+// Function Prototypes:
+// Opens the first Bulk Vendor device and starts the IN transfers. Config may
+// be NULL, zero fields take their defaults. Returns 0 or a libusb_error code.
+int BVClient_Open(BVClient_t** const Client, const BVClient_Config_t* const Config);
+
+// Same as BVClient_Open for the device with serial number Serial, or the first
+// device if Serial is NULL. The serial is fixed per board, so a rack of boards
+// is addressed without querying each one with vendor requests.
+int BVClient_OpenSerial(BVClient_t** const Client, const BVClient_Config_t* const Config, const char* const Serial);
+
+// Fills Devices with the serial number and device path of up to MaxDevices
+// attached Bulk Vendor devices, returns their number or a libusb_error code.
+// Only the serial string descriptor of each device is read.
+int BVClient_ListDevices(BVClient_DeviceInfo_t* const Devices, const uint32_t MaxDevices);
+void BVClient_Close(BVClient_t* const Client);
+
+void BVClient_SetReadCallback(BVClient_t* const Client, const BVClient_ReadCallback_t Callback, void* const UserData);
+void BVClient_SetWriteCallback(BVClient_t* const Client, const BVClient_WriteCallback_t Callback, void* const UserData);
+
+// Queues as much of Data as free OUT transfers allow, returns the number of
+// bytes accepted, 0 when all transfers are in flight.
+int BVClient_Write(BVClient_t* const Client, const void* const Data, const uint32_t Length);
+
+// Copies up to Length received bytes out of the receive ring, returns the
+// number of bytes copied.
+int BVClient_Read(BVClient_t* const Client, void* const Data, const uint32_t Length);
+
+// Handles transfer completions for up to TimeoutMS, returns 0 or the error.
+int BVClient_Poll(BVClient_t* const Client, const unsigned int TimeoutMS);
+
+// Waits until every queued OUT transfer has completed or TimeoutMS passed.
+int BVClient_Flush(BVClient_t* const Client, const unsigned int TimeoutMS);
+
+uint32_t BVClient_WritesPending(const BVClient_t* const Client);
+uint32_t BVClient_BytesAvailable(const BVClient_t* const Client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+// Streams stdin through the Bulk Vendor echo to stdout with the client
+// library, e.g. to check a large transfer end to end:
+//	bulk_stream < data.bin > echo.bin && cmp data.bin echo.bin
+// With several boards attached, -l lists their serial numbers and device
+// paths and -s picks the board by serial number.
+//	bulk_stream [-l] [-s serial]
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <libusb.h>
+
+#include "BulkVendorClient.h"
+
+// Macros:
+#define STREAM_CHUNK_SIZE	4096
+
+// Time the echo may take to drain after the last write.
+#define STREAM_DRAIN_MS		1000
+
+// Boards listed by -l at most.
+#define STREAM_MAX_DEVICES	64
+
+// Global Variables:
+static uint64_t BytesReceived;
+
+static void Stream_ReadCallback(void* const UserData, const uint8_t* const Data, const uint32_t Length)
+{
+	fwrite(Data, 1, Length, stdout);
+	BytesReceived += Length;
+}
+
+static void Stream_Usage(const char* const Program)
+{
+	fprintf(stderr, "usage: %s [-l] [-s serial]\n", Program);
+	exit(EXIT_FAILURE);
+}
+
+static int Stream_ListDevices(void)
+{
+	static BVClient_DeviceInfo_t Devices[STREAM_MAX_DEVICES];
+	int Count = BVClient_ListDevices(Devices, STREAM_MAX_DEVICES);
+
+	if (Count < 0)
+	{
+		fprintf(stderr, "bulk_stream: %s\n", libusb_error_name(Count));
+		return EXIT_FAILURE;
+	}
+
+	for (int i = 0; i < Count; i++)
+		printf("%s %s\n", Devices[i].Serial, Devices[i].Path);
+
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+	BVClient_t* Client;
+	uint8_t Chunk[STREAM_CHUNK_SIZE];
+	uint64_t BytesSent = 0;
+	const char* Serial = NULL;
+	size_t Count;
+	int Option;
+	int Error;
+
+	while ((Option = getopt(argc, argv, "ls:")) != -1)
+	{
+		switch (Option)
+		{
+			case 'l':
+				return Stream_ListDevices();
+			case 's':
+				Serial = optarg;
+				break;
+			default:
+				Stream_Usage(argv[0]);
+		}
+	}
+
+	if ((Error = BVClient_OpenSerial(&Client, NULL, Serial)) != LIBUSB_SUCCESS)
+	{
+		fprintf(stderr, "bulk_stream: %s\n", libusb_error_name(Error));
+		return EXIT_FAILURE;
+	}
+
+	BVClient_SetReadCallback(Client, Stream_ReadCallback, NULL);
+
+	while (!(Error) && ((Count = fread(Chunk, 1, sizeof(Chunk), stdin)) > 0))
+	{
+		for (size_t Written = 0; !(Error) && (Written < Count); )
+		{
+			int Accepted = BVClient_Write(Client, &Chunk[Written], Count - Written);
+
+			if (Accepted < 0)
+				Error = Accepted;
+			else if (!(Accepted))
+				Error = BVClient_Poll(Client, 100);
+			else
+				Written += Accepted;
+		}
+
+		BytesSent += Count;
+	}
+
+	if (!(Error))
+		Error = BVClient_Flush(Client, STREAM_DRAIN_MS);
+
+	for (unsigned int Waited = 0; !(Error) && (BytesReceived < BytesSent) && (Waited < STREAM_DRAIN_MS); Waited += 10)
+		Error = BVClient_Poll(Client, 10);
+
+	BVClient_Close(Client);
+	fflush(stdout);
+
+	if (Error || (BytesReceived != BytesSent))
+	{
+		fprintf(stderr, "bulk_stream: %llu of %llu bytes echoed%s%s\n", (unsigned long long)BytesReceived,
+				(unsigned long long)BytesSent, Error ? ", " : "", Error ? libusb_error_name(Error) : "");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
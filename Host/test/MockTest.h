@@ -0,0 +1,40 @@
+// Minimal assertion helpers for the host tests.
+#ifndef MOCKTEST_H
+#define MOCKTEST_H
+
+// Includes:
+#include <stdio.h>
+#include <stdlib.h>
+
+// Macros:
+// Fails the test program on the first false condition.
+#define TEST_ASSERT(Condition)												\
+	do																		\
+	{																		\
+		if (!(Condition))													\
+		{																	\
+			printf("%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #Condition); \
+			exit(EXIT_FAILURE);												\
+		}																	\
+	} while (0)
+
+#define TEST_ASSERT_EQUAL(Expected, Actual)									\
+	do																		\
+	{																		\
+		long _Expected = (long)(Expected);									\
+		long _Actual = (long)(Actual);										\
+		if (_Expected != _Actual)											\
+		{																	\
+			printf("%s:%d: %s: expected %ld, got %ld\n", __FILE__, __LINE__, #Actual, _Expected, _Actual); \
+			exit(EXIT_FAILURE);												\
+		}																	\
+	} while (0)
+
+#define RUN_TEST(Test)														\
+	do																		\
+	{																		\
+		printf("%s...\n", #Test);											\
+		Test();																\
+	} while (0)
+
+#endif
@@ -0,0 +1,69 @@
+// Echo benchmark for the BulkVendor firmware on the mock endpoint layer. The
+// host keeps the OUT endpoint full and reads every IN packet as soon as it is
+// sent, so the firmware loop is the only limit. Reports the host CPU time and
+// the main loop polls per echoed packet; the polls are what a regression in
+// LufaUtil.c or the echo loop shows up in first.
+//	bench_BulkVendor [packets]
+#include <time.h>
+#include "MockUSB.h"
+#include "MockTest.h"
+#include "BulkVendor.h"
+
+// Global Variables:
+static uint32_t PacketsToSend;
+static uint32_t PacketsSent;
+static uint32_t PacketsReceived;
+static uint32_t Mismatches;
+
+int Firmware_Main(void);
+
+static void BenchHostHook(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE];
+	int16_t Length;
+
+	while ((Length = Mock_HostReadPacket(VENDOR_IN_EPADDR, Data, sizeof(Data))) >= 0)
+	{
+		if ((Length != VENDOR_IO_EPSIZE) || (Data[0] != (uint8_t)PacketsReceived))
+			Mismatches++;
+		PacketsReceived++;
+	}
+
+	while ((PacketsSent < PacketsToSend) && (Mock_PendingPackets(VENDOR_OUT_EPADDR) < VENDOR_EP_BANKS))
+	{
+		memset(Data, (uint8_t)PacketsSent, sizeof(Data));
+		Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data));
+		PacketsSent++;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	struct timespec Start, End;
+
+	PacketsToSend = (argc > 1) ? strtoul(argv[1], NULL, 0) : 100000;
+
+	Mock_Reset();
+	Mock_RunFirmware(Firmware_Main, 1);
+	Mock_Configure();
+	Mock_SetHostHook(BenchHostHook);
+	Mock_Stats.Yields = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &Start);
+	while (PacketsReceived < PacketsToSend)
+	{
+		Mock_StartOfFrame();
+		Mock_RunFirmware(Firmware_Main, 1024);
+		BenchHostHook();
+	}
+	clock_gettime(CLOCK_MONOTONIC, &End);
+
+	double Seconds = (End.tv_sec - Start.tv_sec) + (End.tv_nsec - Start.tv_nsec) / 1e9;
+	printf("banks %d: %lu packets, %.1f ns/packet, %.2f polls/packet, %lu wait timeouts\n",
+		   VENDOR_EP_BANKS, (unsigned long)PacketsReceived, (Seconds * 1e9) / PacketsReceived,
+		   (double)Mock_Stats.Yields / PacketsReceived, (unsigned long)Mock_Stats.WaitTimeouts);
+
+	TEST_ASSERT_EQUAL(0, Mismatches);
+	TEST_ASSERT_EQUAL(0, Mock_Stats.WaitTimeouts);
+	return 0;
+}
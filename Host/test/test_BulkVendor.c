@@ -0,0 +1,712 @@
+// Echo tests for the BulkVendor firmware on the mock endpoint layer, built for
+// each VENDOR_EP_BANKS and INTERRUPT_DATA_ENDPOINT combination and for the
+// VENDOR_FRAMED_ECHO message echo.
+#include "MockUSB.h"
+#include "MockTest.h"
+#include "BulkVendor.h"
+#include <avr/boot.h>
+#include <avr/sleep.h>
+
+// Macros:
+#define HOST_BUFFER_SIZE	4096
+
+// Global Variables:
+// Everything the firmware sent on the IN endpoint, drained as the host would.
+static uint8_t HostReceived[HOST_BUFFER_SIZE];
+static uint16_t HostReceivedLength;
+static uint16_t HostReceivedPackets;
+
+int Firmware_Main(void);
+
+static void DrainIN(void)
+{
+	int16_t Length;
+
+	while ((Length = Mock_HostReadPacket(VENDOR_IN_EPADDR, &HostReceived[HostReceivedLength],
+										 HOST_BUFFER_SIZE - HostReceivedLength)) >= 0)
+	{
+		HostReceivedLength += Length;
+		HostReceivedPackets++;
+	}
+}
+
+static void ClearReceived(void)
+{
+	HostReceivedLength = 0;
+	HostReceivedPackets = 0;
+}
+
+// One frame: the main loop runs a few hundred passes, the interrupt driven
+// build services the endpoints whenever the host sends or reads a packet.
+static void RunFrames(const uint16_t Frames)
+{
+	for (uint16_t i = 0; i < Frames; i++)
+	{
+		Mock_StartOfFrame();
+		Mock_RunFirmware(Firmware_Main, 256);
+		DrainIN();
+	}
+}
+
+static void FillPattern(uint8_t* const Data, const uint16_t Length, const uint8_t Seed)
+{
+	for (uint16_t i = 0; i < Length; i++)
+		Data[i] = (uint8_t)(Seed + i * 7);
+}
+
+static void test_NoEchoBeforeConfiguration(void)
+{
+	uint8_t Data[8] = "unconfd";
+
+	Mock_Connect();
+	TEST_ASSERT(!Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data)));
+	RunFrames(4);
+	TEST_ASSERT_EQUAL(0, HostReceivedLength);
+
+	Mock_Configure();
+	RunFrames(4);
+	TEST_ASSERT_EQUAL(0, HostReceivedLength);
+	TEST_ASSERT_EQUAL(LEDMASK_USB_READY, Mock_LEDs);
+}
+
+static void test_EchoShortPacket(void)
+{
+	uint8_t Data[10] = "abcdefghi";
+
+	ClearReceived();
+	TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data)));
+	RunFrames(4);
+
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+}
+
+#ifndef VENDOR_FRAMED_ECHO
+// Length of each packet read by PacketLengthHook.
+static uint8_t HostPacketLengths[8];
+
+static void PacketLengthHook(void)
+{
+	int16_t Length;
+
+	while ((HostReceivedPackets < sizeof(HostPacketLengths)) &&
+		   ((Length = Mock_HostReadPacket(VENDOR_IN_EPADDR, &HostReceived[HostReceivedLength],
+										  HOST_BUFFER_SIZE - HostReceivedLength)) >= 0))
+	{
+		HostReceivedLength += Length;
+		HostPacketLengths[HostReceivedPackets++] = Length;
+	}
+}
+
+// Short packets sent before the host reads are echoed one by one, never merged
+// into a longer packet or split.
+static void test_EchoKeepsPacketBoundaries(void)
+{
+	static const uint8_t Lengths[] = {10, 20, 1, VENDOR_IO_EPSIZE, 33};
+	uint8_t Data[VENDOR_IO_EPSIZE * 2];
+	uint16_t Offset = 0;
+
+	ClearReceived();
+	FillPattern(Data, sizeof(Data), 0x44);
+	for (uint8_t i = 0; i < sizeof(Lengths); i++)
+	{
+		TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, &Data[Offset], Lengths[i]));
+		Offset += Lengths[i];
+	}
+
+	Mock_SetHostHook(PacketLengthHook);
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		Mock_StartOfFrame();
+		Mock_RunFirmware(Firmware_Main, 256);
+		PacketLengthHook();
+	}
+	Mock_SetHostHook(NULL);
+
+	TEST_ASSERT_EQUAL(sizeof(Lengths), HostReceivedPackets);
+	TEST_ASSERT(memcmp(Lengths, HostPacketLengths, sizeof(Lengths)) == 0);
+	TEST_ASSERT_EQUAL(Offset, HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, Offset) == 0);
+}
+
+static void test_EchoFullPackets(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE * 16];
+
+	ClearReceived();
+	FillPattern(Data, sizeof(Data), 0x11);
+	TEST_ASSERT_EQUAL(sizeof(Data), Mock_HostWrite(VENDOR_OUT_EPADDR, Data, sizeof(Data)));
+
+	// The host reads as soon as a packet is sent.
+	Mock_SetHostHook(DrainIN);
+	RunFrames(64);
+	Mock_SetHostHook(NULL);
+
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+	TEST_ASSERT_EQUAL(0, Mock_PendingPackets(VENDOR_OUT_EPADDR));
+}
+
+// Reads one packet every few calls, the firmware has to wait for IN banks.
+static void SlowHostHook(void)
+{
+	static uint8_t Calls;
+
+	if ((++Calls % 8) == 0)
+	{
+		int16_t Length = Mock_HostReadPacket(VENDOR_IN_EPADDR, &HostReceived[HostReceivedLength],
+											 HOST_BUFFER_SIZE - HostReceivedLength);
+		if (Length >= 0)
+			HostReceivedLength += Length;
+	}
+}
+
+// No packet may be lost or reordered while the host is slower than the
+// firmware.
+static void test_EchoWithSlowHost(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE * 8];
+
+	ClearReceived();
+	FillPattern(Data, sizeof(Data), 0x5A);
+	Mock_HostWrite(VENDOR_OUT_EPADDR, Data, sizeof(Data));
+
+	Mock_Stats.WaitTimeouts = 0;
+	Mock_SetHostHook(SlowHostHook);
+	for (uint16_t i = 0; (i < 256) && (HostReceivedLength < sizeof(Data)); i++)
+	{
+		TEST_ASSERT(Mock_PendingPackets(VENDOR_IN_EPADDR) <= VENDOR_EP_BANKS);
+		Mock_StartOfFrame();
+		Mock_RunFirmware(Firmware_Main, 16);
+		SlowHostHook();
+	}
+	Mock_SetHostHook(NULL);
+
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+	TEST_ASSERT_EQUAL(0, Mock_Stats.WaitTimeouts);
+}
+#else
+// Sends one message, ended by a zero length packet if it is a multiple of the
+// endpoint size, and collects its echo.
+static void EchoMessage(const uint8_t* const Data, const uint16_t Length)
+{
+	ClearReceived();
+	TEST_ASSERT_EQUAL(Length, Mock_HostWrite(VENDOR_OUT_EPADDR, Data, Length));
+	if (!(Length % VENDOR_IO_EPSIZE))
+		TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, NULL, 0));
+
+	Mock_Stats.WaitTimeouts = 0;
+	Mock_SetHostHook(DrainIN);
+	RunFrames(8);
+	Mock_SetHostHook(NULL);
+	TEST_ASSERT_EQUAL(0, Mock_Stats.WaitTimeouts);
+}
+
+// A message of whole packets is echoed with a zero length packet at its end.
+static void test_MessageEndsWithZeroLengthPacket(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE * 3];
+
+	FillPattern(Data, sizeof(Data), 0x21);
+	EchoMessage(Data, sizeof(Data));
+
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+	TEST_ASSERT_EQUAL(4, HostReceivedPackets);
+}
+
+static void test_MessageEndsWithShortPacket(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE + 36];
+
+	FillPattern(Data, sizeof(Data), 0x33);
+	EchoMessage(Data, sizeof(Data));
+
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+	TEST_ASSERT_EQUAL(2, HostReceivedPackets);
+}
+
+// Only VENDOR_MESSAGE_SIZE bytes of a longer message are echoed.
+static void test_LongMessageIsTruncated(void)
+{
+	uint8_t Data[VENDOR_MESSAGE_SIZE + 40];
+
+	FillPattern(Data, sizeof(Data), 0x55);
+	EchoMessage(Data, sizeof(Data));
+
+	TEST_ASSERT_EQUAL(VENDOR_MESSAGE_SIZE, HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, VENDOR_MESSAGE_SIZE) == 0);
+	TEST_ASSERT_EQUAL(0, Mock_PendingPackets(VENDOR_OUT_EPADDR));
+}
+#endif
+
+static int16_t VendorRequest(const uint8_t Direction, const uint8_t bRequest, const uint16_t wValue,
+							 void* const Data, const uint16_t wLength)
+{
+	return Mock_HostControl(Direction | REQTYPE_VENDOR | REQREC_DEVICE, bRequest, wValue, 0, Data, wLength);
+}
+
+static PerfCounters_t GetStatistics(void)
+{
+	PerfCounters_t Statistics;
+
+	TEST_ASSERT_EQUAL(sizeof(Statistics), VendorRequest(REQDIR_DEVICETOHOST, VENDOR_REQ_GetStatistics, 0,
+														&Statistics, sizeof(Statistics)));
+	return Statistics;
+}
+
+static void test_Statistics(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE + 8];
+
+	TEST_ASSERT_EQUAL(0, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_ResetStatistics, 0, NULL, 0));
+	PerfCounters_t Statistics = GetStatistics();
+	TEST_ASSERT_EQUAL(0, Statistics.OUTBytes);
+	TEST_ASSERT_EQUAL(0, Statistics.INBytes);
+
+	ClearReceived();
+	FillPattern(Data, sizeof(Data), 0x66);
+	Mock_HostWrite(VENDOR_OUT_EPADDR, Data, sizeof(Data));
+	Mock_SetHostHook(DrainIN);
+	RunFrames(8);
+	Mock_SetHostHook(NULL);
+
+	Statistics = GetStatistics();
+	TEST_ASSERT_EQUAL(sizeof(Data), Statistics.OUTBytes);
+	TEST_ASSERT_EQUAL(sizeof(Data), Statistics.INBytes);
+	TEST_ASSERT(Statistics.OUTPackets >= 2);
+	TEST_ASSERT(Statistics.INPackets >= 2);
+	TEST_ASSERT(Statistics.MainLoopPasses > 0);
+	TEST_ASSERT_EQUAL(0, Statistics.WaitTimeouts);
+}
+
+// Sink discards the OUT data, source sends a running count on the IN endpoint.
+static void test_Modes(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE];
+	uint8_t Mode;
+
+	TEST_ASSERT_EQUAL(0, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_SetMode, VENDOR_MODE_Sink, NULL, 0));
+	TEST_ASSERT_EQUAL(1, VendorRequest(REQDIR_DEVICETOHOST, VENDOR_REQ_GetMode, 0, &Mode, sizeof(Mode)));
+	TEST_ASSERT_EQUAL(VENDOR_MODE_Sink, Mode);
+
+	ClearReceived();
+	FillPattern(Data, sizeof(Data), 0x77);
+	Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data) - 1);
+	RunFrames(4);
+	TEST_ASSERT_EQUAL(0, HostReceivedLength);
+	TEST_ASSERT_EQUAL(0, Mock_PendingPackets(VENDOR_OUT_EPADDR));
+
+	// A few passes only, the source fills the IN endpoint on every one.
+	TEST_ASSERT_EQUAL(0, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_SetMode, VENDOR_MODE_Source, NULL, 0));
+	Mock_SetHostHook(DrainIN);
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		Mock_StartOfFrame();
+		Mock_RunFirmware(Firmware_Main, 8);
+		DrainIN();
+	}
+	Mock_SetHostHook(NULL);
+	TEST_ASSERT(HostReceivedLength >= VENDOR_IO_EPSIZE);
+	for (uint16_t i = 1; i < HostReceivedLength; i++)
+		TEST_ASSERT_EQUAL((uint8_t)(HostReceived[0] + i), HostReceived[i]);
+
+	// Invalid modes are stalled and leave the mode unchanged.
+	TEST_ASSERT_EQUAL(-1, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_SetMode, 3, NULL, 0));
+	TEST_ASSERT_EQUAL(1, VendorRequest(REQDIR_DEVICETOHOST, VENDOR_REQ_GetMode, 0, &Mode, sizeof(Mode)));
+	TEST_ASSERT_EQUAL(VENDOR_MODE_Source, Mode);
+
+	TEST_ASSERT_EQUAL(0, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_SetMode, VENDOR_MODE_Echo, NULL, 0));
+	TEST_ASSERT_EQUAL(0, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_Flush, 0, NULL, 0));
+	RunFrames(4);
+}
+
+// Packets received before the flush are never echoed.
+static void test_Flush(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE * 4];
+
+	ClearReceived();
+	FillPattern(Data, sizeof(Data), 0x88);
+	Mock_HostWrite(VENDOR_OUT_EPADDR, Data, sizeof(Data));
+	TEST_ASSERT_EQUAL(0, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_Flush, 0, NULL, 0));
+	RunFrames(4);
+
+	TEST_ASSERT_EQUAL(0, HostReceivedLength);
+	TEST_ASSERT_EQUAL(0, Mock_PendingPackets(VENDOR_OUT_EPADDR));
+
+	// The data path keeps working afterwards.
+	Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, 5);
+	RunFrames(4);
+	TEST_ASSERT_EQUAL(5, HostReceivedLength);
+}
+
+static void test_UnknownVendorRequest(void)
+{
+	uint8_t Data[4];
+
+	TEST_ASSERT_EQUAL(-1, VendorRequest(REQDIR_DEVICETOHOST, 0x7F, 0, Data, sizeof(Data)));
+	TEST_ASSERT_EQUAL(-1, VendorRequest(REQDIR_DEVICETOHOST, VENDOR_REQ_SetMode, 0, Data, sizeof(Data)));
+}
+
+#ifdef EVENT_LOG_ENABLED
+// Sends the event log on the UART until it is empty, returns the number of
+// records.
+static uint8_t ReadEventLog(uint8_t* const Records, const uint16_t Length)
+{
+	uint16_t Count = Mock_UARTRead(Records, Length);
+
+	TEST_ASSERT_EQUAL(0, Count % EVENT_LOG_RECORD_SIZE);
+	for (uint16_t i = 0; i < Count; i += EVENT_LOG_RECORD_SIZE)
+	{
+		TEST_ASSERT_EQUAL(EVENT_LOG_SYNC, Records[i]);
+		TEST_ASSERT(Records[i + 1] < EVENT_COUNT);
+	}
+
+	return Count / EVENT_LOG_RECORD_SIZE;
+}
+
+// Records are kept while the UART is busy, the ones that do not fit are
+// counted and reported once it has caught up.
+static void test_EventLog(void)
+{
+	uint8_t Records[EVENT_LOG_RING_SIZE * 2];
+	uint8_t Mode;
+
+	// The earlier tests have filled the log, send it and the drop count.
+	ReadEventLog(Records, sizeof(Records));
+	VendorRequest(REQDIR_DEVICETOHOST, VENDOR_REQ_GetMode, 0, &Mode, sizeof(Mode));
+	ReadEventLog(Records, sizeof(Records));
+
+	TEST_ASSERT_EQUAL(0, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_SetMode, VENDOR_MODE_Echo, NULL, 0));
+	TEST_ASSERT_EQUAL(2, ReadEventLog(Records, sizeof(Records)));
+	TEST_ASSERT_EQUAL(EVENT_ControlRequest, Records[1]);
+	TEST_ASSERT_EQUAL(VENDOR_REQ_SetMode, Records[2]);
+	TEST_ASSERT_EQUAL(EVENT_VendorMode, Records[EVENT_LOG_RECORD_SIZE + 1]);
+
+	const uint8_t Capacity = EVENT_LOG_RING_SIZE / EVENT_LOG_RECORD_SIZE;
+	for (uint8_t i = 0; i < Capacity + 10; i++)
+		VendorRequest(REQDIR_DEVICETOHOST, VENDOR_REQ_GetMode, 0, &Mode, sizeof(Mode));
+	TEST_ASSERT_EQUAL(Capacity, ReadEventLog(Records, sizeof(Records)));
+
+	VendorRequest(REQDIR_DEVICETOHOST, VENDOR_REQ_GetMode, 0, &Mode, sizeof(Mode));
+	TEST_ASSERT_EQUAL(2, ReadEventLog(Records, sizeof(Records)));
+	TEST_ASSERT_EQUAL(EVENT_Dropped, Records[1]);
+	TEST_ASSERT_EQUAL(10, Records[2] | (Records[3] << 8));
+	TEST_ASSERT_EQUAL(EVENT_ControlRequest, Records[EVENT_LOG_RECORD_SIZE + 1]);
+}
+
+// The per-packet records are only compiled in at the debug level of DATA.
+static void test_LogLevels(void)
+{
+	uint8_t Records[EVENT_LOG_RING_SIZE * 2];
+	uint8_t Data[10] = "loglevels";
+	uint8_t PacketRecords = 0;
+
+	ReadEventLog(Records, sizeof(Records));
+	ClearReceived();
+	TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data)));
+	RunFrames(4);
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+
+	uint8_t Count = ReadEventLog(Records, sizeof(Records));
+	for (uint8_t i = 0; i < Count; i++)
+	{
+		uint8_t Event = Records[(i * EVENT_LOG_RECORD_SIZE) + 1];
+		if ((Event == EVENT_EchoPacket) || (Event == EVENT_EchoBytes) || (Event == EVENT_EchoMessage))
+			PacketRecords++;
+	}
+
+	if (LOG_ENABLED(DATA, Debug))
+		TEST_ASSERT(PacketRecords > 0);
+	else
+		TEST_ASSERT_EQUAL(0, PacketRecords);
+}
+#endif
+
+// While the bus is suspended the LEDs are off and the main loop sleeps, the
+// device never resumes the bus itself. After the wakeup it echoes again.
+static void test_Suspend(void)
+{
+	uint8_t Data[10] = "suspended";
+
+	TEST_ASSERT_EQUAL(0, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_ResetStatistics, 0, NULL, 0));
+	uint32_t Sleeps = Mock_Stats.Sleeps;
+
+	Mock_Suspend();
+	TEST_ASSERT_EQUAL(LEDS_NO_LEDS, Mock_LEDs);
+	Mock_RunFirmware(Firmware_Main, 256);
+	TEST_ASSERT(Mock_Stats.Sleeps > Sleeps);
+	TEST_ASSERT_EQUAL(0, Mock_Stats.RemoteWakeups);
+	// The event log keeps the UART, and with it the CPU clock, running
+	#ifdef EVENT_LOG_ENABLED
+	TEST_ASSERT_EQUAL(SLEEP_MODE_IDLE, Mock_SleepMode);
+	#else
+	TEST_ASSERT_EQUAL(SLEEP_MODE_PWR_DOWN, Mock_SleepMode);
+	#endif
+
+	Mock_WakeUp();
+	TEST_ASSERT_EQUAL(LEDMASK_USB_READY, Mock_LEDs);
+
+	ClearReceived();
+	TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data)));
+	RunFrames(4);
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+
+	PerfCounters_t Statistics = GetStatistics();
+	TEST_ASSERT_EQUAL(1, Statistics.Suspends);
+	TEST_ASSERT(Statistics.SuspendedSleeps > 0);
+
+	// Configured again, the idle main loop no longer takes the suspend sleep
+	Mock_RunFirmware(Firmware_Main, 256);
+	TEST_ASSERT_EQUAL(Statistics.SuspendedSleeps, GetStatistics().SuspendedSleeps);
+}
+
+static uint8_t EndpointInterrupts(const uint8_t Address)
+{
+	Endpoint_SelectEndpoint(Address);
+	return UEIENX;
+}
+
+#ifdef INTERRUPT_DATA_ENDPOINT
+// The endpoint interrupt takes each packet as soon as it is received and fills
+// each IN bank as soon as the host took it, without a Start Of Frame.
+static void test_EchoWithinFrame(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE];
+
+	ClearReceived();
+	FillPattern(Data, sizeof(Data), 0x31);
+	TEST_ASSERT_EQUAL((1 << RXOUTE), EndpointInterrupts(VENDOR_OUT_EPADDR));
+	TEST_ASSERT_EQUAL((1 << RXSTPE), EndpointInterrupts(ENDPOINT_CONTROLEP));
+
+	// Two packets fill the receive ring, the third waits in its bank with the
+	// interrupt disarmed.
+	uint32_t Interrupts = Mock_Stats.EndpointInterrupts;
+	for (uint8_t i = 0; i < 4; i++)
+		TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data)));
+	TEST_ASSERT_EQUAL(Interrupts + 3, Mock_Stats.EndpointInterrupts);
+	TEST_ASSERT_EQUAL(2, Mock_PendingPackets(VENDOR_OUT_EPADDR));
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(VENDOR_OUT_EPADDR));
+
+	// The main loop echoes into both IN banks and takes the waiting packets,
+	// the rest of the echo waits for the host.
+	Mock_RunFirmware(Firmware_Main, 1024);
+	TEST_ASSERT_EQUAL(0, Mock_PendingPackets(VENDOR_OUT_EPADDR));
+	TEST_ASSERT_EQUAL(2, Mock_PendingPackets(VENDOR_IN_EPADDR));
+	TEST_ASSERT_EQUAL((1 << TXINE), EndpointInterrupts(VENDOR_IN_EPADDR));
+
+	// Each packet the host reads frees the bank for the next one
+	DrainIN();
+	TEST_ASSERT_EQUAL(4 * sizeof(Data), HostReceivedLength);
+	TEST_ASSERT_EQUAL(4, HostReceivedPackets);
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(VENDOR_IN_EPADDR));
+	TEST_ASSERT_EQUAL((1 << RXOUTE), EndpointInterrupts(VENDOR_OUT_EPADDR));
+	for (uint8_t i = 0; i < 4; i++)
+		TEST_ASSERT(memcmp(Data, &HostReceived[i * sizeof(Data)], sizeof(Data)) == 0);
+}
+#endif
+
+#ifdef IDLE_SLEEP
+
+// With no data to move the main loop sleeps in IDLE, armed to wake on the
+// endpoint it waits on, and still echoes in the same frames as without sleep.
+static void test_IdleSleep(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE - 1]; // Short, a whole message for the framed echo
+
+	TEST_ASSERT_EQUAL(0, VendorRequest(REQDIR_HOSTTODEVICE, VENDOR_REQ_ResetStatistics, 0, NULL, 0));
+	ClearReceived();
+	uint32_t Sleeps = Mock_Stats.Sleeps;
+	RunFrames(2);
+	TEST_ASSERT(Mock_Stats.Sleeps > Sleeps);
+	TEST_ASSERT_EQUAL(SLEEP_MODE_IDLE, Mock_SleepMode);
+
+	FillPattern(Data, sizeof(Data), 0x41);
+	// Waiting for a packet or a control request, the packet ends the sleep
+	TEST_ASSERT_EQUAL((1 << RXOUTE), EndpointInterrupts(VENDOR_OUT_EPADDR));
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(VENDOR_IN_EPADDR));
+	TEST_ASSERT_EQUAL((1 << RXSTPE), EndpointInterrupts(ENDPOINT_CONTROLEP));
+
+	uint32_t Interrupts = Mock_Stats.EndpointInterrupts;
+	TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data)));
+	TEST_ASSERT_EQUAL(Interrupts + 1, Mock_Stats.EndpointInterrupts);
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	// The interrupt took the packet and stays armed for the next one
+	TEST_ASSERT_EQUAL((1 << RXOUTE), EndpointInterrupts(VENDOR_OUT_EPADDR));
+	TEST_ASSERT_EQUAL((1 << RXSTPE), EndpointInterrupts(ENDPOINT_CONTROLEP));
+	#else
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(VENDOR_OUT_EPADDR));
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(ENDPOINT_CONTROLEP));
+	#endif
+
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+
+	#if (VENDOR_EP_BANKS > 1) && !defined(VENDOR_FRAMED_ECHO) && !defined(INTERRUPT_DATA_ENDPOINT)
+	// With both IN banks full the echo waits for the host to read, and a
+	// bank read by the host ends the sleep.
+	ClearReceived();
+	for (uint8_t i = 0; i < 4; i++)
+		TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data)));
+	Mock_RunFirmware(Firmware_Main, 256);
+	TEST_ASSERT_EQUAL(2, Mock_PendingPackets(VENDOR_IN_EPADDR));
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(VENDOR_OUT_EPADDR));
+	TEST_ASSERT_EQUAL((1 << TXINE), EndpointInterrupts(VENDOR_IN_EPADDR));
+
+	Interrupts = Mock_Stats.EndpointInterrupts;
+	RunFrames(2);
+	TEST_ASSERT(Mock_Stats.EndpointInterrupts > Interrupts);
+	TEST_ASSERT_EQUAL(4 * sizeof(Data), HostReceivedLength);
+	#endif
+
+	TEST_ASSERT(GetStatistics().IdleSleeps > 0);
+}
+#endif
+
+static void test_DeviceDescriptor(void)
+{
+	uint8_t Descriptor[18];
+
+	TEST_ASSERT_EQUAL(sizeof(Descriptor),
+					  Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE, REQ_GetDescriptor,
+									   (DTYPE_Device << 8), 0, Descriptor, sizeof(Descriptor)));
+	TEST_ASSERT_EQUAL(DTYPE_Device, Descriptor[1]);
+	TEST_ASSERT_EQUAL(0x03EB, Descriptor[8] | (Descriptor[9] << 8));
+	TEST_ASSERT_EQUAL(0x206C, Descriptor[10] | (Descriptor[11] << 8));
+	TEST_ASSERT_EQUAL(0x0201, Descriptor[2] | (Descriptor[3] << 8));
+}
+
+// The serial is built from the signature row at startup, has the digits of
+// the LUFA internal serial and does not read the signature row again.
+static void test_SerialNumber(void)
+{
+	static const char Expected[] = "A5B7C9DBEDFF01132537";
+	uint8_t Device[18];
+	uint8_t Serial[64];
+	uint8_t InternalSerial[64];
+
+	TEST_ASSERT_EQUAL(sizeof(Device), Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+													   REQ_GetDescriptor, (DTYPE_Device << 8), 0, Device, sizeof(Device)));
+	TEST_ASSERT_EQUAL(STRING_ID_Serial, Device[16]);
+
+	TEST_ASSERT_EQUAL(2 + (SERIAL_NUMBER_LENGTH * 2),
+					  Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE, REQ_GetDescriptor,
+									   (DTYPE_String << 8) | Device[16], 0x0409, Serial, sizeof(Serial)));
+	TEST_ASSERT_EQUAL(2 + (SERIAL_NUMBER_LENGTH * 2), Serial[0]);
+	TEST_ASSERT_EQUAL(DTYPE_String, Serial[1]);
+	for (uint8_t i = 0; i < SERIAL_NUMBER_LENGTH; i++)
+	{
+		TEST_ASSERT_EQUAL(Expected[i], Serial[2 + (i * 2)]);
+		TEST_ASSERT_EQUAL(0, Serial[3 + (i * 2)]);
+	}
+
+	TEST_ASSERT_EQUAL(Serial[0], Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+												  REQ_GetDescriptor, (DTYPE_String << 8) | USE_INTERNAL_SERIAL, 0x0409,
+												  InternalSerial, sizeof(InternalSerial)));
+	TEST_ASSERT(memcmp(Serial, InternalSerial, Serial[0]) == 0);
+
+	// Only the copy made at startup is sent
+	uint8_t SavedByte = Mock_SignatureRow[INTERNAL_SERIAL_START_ADDRESS];
+	Mock_SignatureRow[INTERNAL_SERIAL_START_ADDRESS] = 0x00;
+	TEST_ASSERT_EQUAL(Serial[0], Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+												  REQ_GetDescriptor, (DTYPE_String << 8) | Device[16], 0x0409,
+												  InternalSerial, sizeof(InternalSerial)));
+	Mock_SignatureRow[INTERNAL_SERIAL_START_ADDRESS] = SavedByte;
+	TEST_ASSERT(memcmp(Serial, InternalSerial, Serial[0]) == 0);
+}
+
+// Windows reads the BOS descriptor, then the MS OS 2.0 descriptor set with the
+// vendor code and length given in its platform capability.
+static void test_MSOSDescriptors(void)
+{
+	static const uint8_t MSOS20PlatformUUID[16] = {0xDF, 0x60, 0xDD, 0xD8, 0x89, 0x45, 0xC7, 0x4C,
+												  0x9C, 0xD2, 0x65, 0x9D, 0x9E, 0x64, 0x8A, 0x9F};
+	uint8_t BOS[64];
+	uint8_t Set[256];
+
+	// Header first, then the whole BOS as the host does
+	TEST_ASSERT_EQUAL(5, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE, REQ_GetDescriptor,
+										  (DTYPE_BOS << 8), 0, BOS, 5));
+	uint16_t TotalLength = BOS[2] | (BOS[3] << 8);
+	TEST_ASSERT_EQUAL(5, BOS[0]);
+	TEST_ASSERT_EQUAL(DTYPE_BOS, BOS[1]);
+	TEST_ASSERT_EQUAL(1, BOS[4]);
+	TEST_ASSERT_EQUAL(5 + 28, TotalLength);
+	TEST_ASSERT_EQUAL(TotalLength, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+													REQ_GetDescriptor, (DTYPE_BOS << 8), 0, BOS, sizeof(BOS)));
+
+	uint8_t* Platform = &BOS[5];
+	TEST_ASSERT_EQUAL(28, Platform[0]);
+	TEST_ASSERT_EQUAL(DTYPE_DeviceCapability, Platform[1]);
+	TEST_ASSERT_EQUAL(DCTYPE_Platform, Platform[2]);
+	TEST_ASSERT(memcmp(MSOS20PlatformUUID, &Platform[4], sizeof(MSOS20PlatformUUID)) == 0);
+	uint16_t SetLength = Platform[24] | (Platform[25] << 8);
+	uint8_t VendorCode = Platform[26];
+
+	TEST_ASSERT_EQUAL(SetLength, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE, VendorCode,
+												  0, MS_OS_20_DESCRIPTOR_INDEX, Set, sizeof(Set)));
+	TEST_ASSERT_EQUAL(10 + 20 + 132, SetLength);
+
+	// Set header, then the compatible ID and the registry property
+	TEST_ASSERT_EQUAL(10, Set[0] | (Set[1] << 8));
+	TEST_ASSERT_EQUAL(MS_OS_20_SET_HEADER_DESCRIPTOR, Set[2] | (Set[3] << 8));
+	TEST_ASSERT_EQUAL(SetLength, Set[8] | (Set[9] << 8));
+	TEST_ASSERT_EQUAL(MS_OS_20_FEATURE_COMPATIBLE_ID, Set[12] | (Set[13] << 8));
+	TEST_ASSERT(memcmp("WINUSB\0\0", &Set[14], 8) == 0);
+
+	uint8_t* Property = &Set[30];
+	TEST_ASSERT_EQUAL(132, Property[0] | (Property[1] << 8));
+	TEST_ASSERT_EQUAL(MS_OS_20_FEATURE_REG_PROPERTY, Property[2] | (Property[3] << 8));
+	TEST_ASSERT_EQUAL(MS_OS_20_REG_MULTI_SZ, Property[4] | (Property[5] << 8));
+	TEST_ASSERT_EQUAL(42, Property[6] | (Property[7] << 8));
+	TEST_ASSERT_EQUAL('D', Property[8]);
+	TEST_ASSERT_EQUAL(80, Property[50] | (Property[51] << 8));
+	TEST_ASSERT_EQUAL('{', Property[52]);
+	TEST_ASSERT_EQUAL(0, Property[130] | Property[131]);
+
+	// Only descriptor index 7 is served
+	TEST_ASSERT_EQUAL(-1, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE, VendorCode,
+										   0, 0x08, Set, sizeof(Set)));
+}
+
+int main(void)
+{
+	Mock_Reset();
+	Mock_RunFirmware(Firmware_Main, 1);
+
+	RUN_TEST(test_NoEchoBeforeConfiguration);
+	RUN_TEST(test_EchoShortPacket);
+	#ifdef VENDOR_FRAMED_ECHO
+	RUN_TEST(test_MessageEndsWithZeroLengthPacket);
+	RUN_TEST(test_MessageEndsWithShortPacket);
+	RUN_TEST(test_LongMessageIsTruncated);
+	#else
+	RUN_TEST(test_EchoKeepsPacketBoundaries);
+	RUN_TEST(test_EchoFullPackets);
+	RUN_TEST(test_EchoWithSlowHost);
+	#endif
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	RUN_TEST(test_EchoWithinFrame);
+	#endif
+	RUN_TEST(test_Statistics);
+	RUN_TEST(test_Modes);
+	RUN_TEST(test_Flush);
+	RUN_TEST(test_UnknownVendorRequest);
+	RUN_TEST(test_Suspend);
+	#ifdef IDLE_SLEEP
+	RUN_TEST(test_IdleSleep);
+	#endif
+	#ifdef EVENT_LOG_ENABLED
+	RUN_TEST(test_EventLog);
+	RUN_TEST(test_LogLevels);
+	#endif
+	RUN_TEST(test_DeviceDescriptor);
+	RUN_TEST(test_MSOSDescriptors);
+	RUN_TEST(test_SerialNumber);
+
+	return 0;
+}
@@ -0,0 +1,293 @@
+// Tests for the Composite firmware on the mock endpoint layer: the
+// configuration descriptor and endpoint budget, and each of the vendor bulk,
+// CDC console and HID status functions running from the one main loop.
+#include "MockUSB.h"
+#include "MockTest.h"
+#include "Composite.h"
+#include <avr/sleep.h>
+
+// Macros:
+#define HOST_BUFFER_SIZE	1024
+
+// Global Variables:
+// Everything the firmware sent on the vendor and the console IN endpoints.
+static uint8_t VendorReceived[HOST_BUFFER_SIZE];
+static uint16_t VendorReceivedLength;
+static uint8_t ConsoleReceived[HOST_BUFFER_SIZE];
+static uint16_t ConsoleReceivedLength;
+
+int Firmware_Main(void);
+
+static void DrainIN(const uint8_t Address, uint8_t* const Buffer, uint16_t* const Length)
+{
+	int16_t Received;
+
+	while ((Received = Mock_HostReadPacket(Address, &Buffer[*Length], HOST_BUFFER_SIZE - *Length)) >= 0)
+		*Length += Received;
+}
+
+static void ClearReceived(void)
+{
+	VendorReceivedLength = 0;
+	ConsoleReceivedLength = 0;
+}
+
+// Drains the bulk endpoints every frame, the HID endpoint is left to the test.
+static void RunFrames(const uint16_t Frames)
+{
+	for (uint16_t i = 0; i < Frames; i++)
+	{
+		Mock_StartOfFrame();
+		Mock_RunFirmware(Firmware_Main, 64);
+		DrainIN(VENDOR_IN_EPADDR, VendorReceived, &VendorReceivedLength);
+		DrainIN(CDC_TX_EPADDR, ConsoleReceived, &ConsoleReceivedLength);
+	}
+}
+
+// Returns the length of the newest HID status report, or -1 if none was sent.
+static int16_t ReadLastStatus(Composite_StatusReport_t* const Report)
+{
+	int16_t Length = -1;
+	int16_t Received;
+
+	while ((Received = Mock_HostReadPacket(HID_IN_EPADDR, Report, sizeof(Composite_StatusReport_t))) >= 0)
+		Length = Received;
+
+	return Length;
+}
+
+static void SendConsoleLine(const char* const Line)
+{
+	TEST_ASSERT(Mock_HostSendPacket(CDC_RX_EPADDR, Line, strlen(Line)));
+	RunFrames(4);
+}
+
+// The configuration descriptor lists the four interfaces, the two CDC
+// interfaces behind their association, and six distinct data endpoints.
+static void test_ConfigurationDescriptor(void)
+{
+	uint8_t Descriptor[sizeof(USB_Descriptor_Configuration_t)];
+	uint8_t DeviceDescriptor[sizeof(USB_Descriptor_Device_t)];
+	uint8_t EndpointsSeen = 0;
+	uint8_t Interfaces = 0;
+	bool IADBeforeCDC = false;
+
+	TEST_ASSERT_EQUAL(sizeof(DeviceDescriptor), Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+																 REQ_GetDescriptor, (DTYPE_Device << 8), 0,
+																 DeviceDescriptor, sizeof(DeviceDescriptor)));
+	TEST_ASSERT_EQUAL(USB_CSCP_IADDeviceClass, DeviceDescriptor[4]);
+
+	TEST_ASSERT_EQUAL(sizeof(Descriptor), Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+														   REQ_GetDescriptor, (DTYPE_Configuration << 8), 0,
+														   Descriptor, sizeof(Descriptor)));
+	TEST_ASSERT_EQUAL(INTERFACE_COUNT, Descriptor[4]);
+
+	for (uint16_t Offset = Descriptor[0]; Offset < sizeof(Descriptor); Offset += Descriptor[Offset])
+	{
+		const uint8_t* Header = &Descriptor[Offset];
+
+		TEST_ASSERT(Header[0] >= 2);
+		if (Header[1] == DTYPE_InterfaceAssociation)
+		{
+			TEST_ASSERT_EQUAL(INTERFACE_ID_CDC_CCI, Header[2]);
+			TEST_ASSERT_EQUAL(2, Header[3]);
+			IADBeforeCDC = (Header[Header[0] + 1] == DTYPE_Interface) && (Header[Header[0] + 2] == INTERFACE_ID_CDC_CCI);
+		}
+		else if (Header[1] == DTYPE_Interface)
+		{
+			TEST_ASSERT_EQUAL(Interfaces, Header[2]);
+			Interfaces++;
+		}
+		else if (Header[1] == DTYPE_Endpoint)
+		{
+			uint8_t Number = (Header[2] & ENDPOINT_EPNUM_MASK);
+
+			TEST_ASSERT(Number > 0);
+			TEST_ASSERT(!(EndpointsSeen & (1 << Number)));
+			EndpointsSeen |= (1 << Number);
+		}
+	}
+
+	TEST_ASSERT(IADBeforeCDC);
+	TEST_ASSERT_EQUAL(INTERFACE_COUNT, Interfaces);
+	TEST_ASSERT_EQUAL(0x7E, EndpointsSeen);
+
+	// String descriptors are sized by their own header, past the last one
+	// the request stalls
+	TEST_ASSERT_EQUAL(2 + 2 * strlen("LUFA Composite Console"),
+					  Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+									   REQ_GetDescriptor, (DTYPE_String << 8) | STRING_ID_Console, 0x0409,
+									   Descriptor, sizeof(Descriptor)));
+	TEST_ASSERT_EQUAL(DTYPE_String, Descriptor[1]);
+	TEST_ASSERT_EQUAL(2 + (SERIAL_NUMBER_LENGTH * 2),
+					  Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+									   REQ_GetDescriptor, (DTYPE_String << 8) | STRING_ID_Serial, 0x0409,
+									   Descriptor, sizeof(Descriptor)));
+	TEST_ASSERT_EQUAL(-1, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+										   REQ_GetDescriptor, (DTYPE_String << 8) | (STRING_ID_Serial + 1), 0x0409,
+										   Descriptor, sizeof(Descriptor)));
+
+	// The HID class descriptors belong to the HID interface only
+	TEST_ASSERT(Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_INTERFACE,
+								 REQ_GetDescriptor, (HID_DTYPE_Report << 8), INTERFACE_ID_HID,
+								 Descriptor, sizeof(Descriptor)) > 0);
+	TEST_ASSERT_EQUAL(-1, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_INTERFACE,
+										   REQ_GetDescriptor, (HID_DTYPE_Report << 8), INTERFACE_ID_Vendor,
+										   Descriptor, sizeof(Descriptor)));
+}
+
+// Every endpoint of every function is configured, the first status report
+// goes out right away.
+static void test_Configuration(void)
+{
+	Composite_StatusReport_t Report;
+
+	Mock_Configure();
+	TEST_ASSERT_EQUAL(LEDMASK_USB_READY, Mock_LEDs);
+	RunFrames(2);
+
+	TEST_ASSERT_EQUAL(sizeof(Report), ReadLastStatus(&Report));
+	TEST_ASSERT_EQUAL(VENDOR_MODE_Echo, Report.VendorMode);
+	TEST_ASSERT_EQUAL(0, Report.ConsoleLineState);
+}
+
+static void test_VendorEcho(void)
+{
+	uint8_t Data[VENDOR_IO_EPSIZE];
+
+	for (uint8_t i = 0; i < sizeof(Data); i++)
+		Data[i] = (uint8_t)(i * 7);
+
+	ClearReceived();
+	TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, sizeof(Data)));
+	TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, Data, 10));
+	RunFrames(4);
+
+	TEST_ASSERT_EQUAL(sizeof(Data) + 10, VendorReceivedLength);
+	TEST_ASSERT(memcmp(Data, VendorReceived, sizeof(Data)) == 0);
+	TEST_ASSERT(memcmp(Data, &VendorReceived[sizeof(Data)], 10) == 0);
+	TEST_ASSERT_EQUAL(0, ConsoleReceivedLength);
+}
+
+// The console echoes its input and switches the vendor pipe mode, which the
+// status report and the vendor request both show.
+static void test_ConsoleMode(void)
+{
+	static const char Expected[] = "mode 1\r\nmode 1\r\n";
+	uint8_t LineEncoding[7] = {0x00, 0xC2, 0x01, 0x00, 0, 0, 8};
+	Composite_StatusReport_t Report;
+	uint8_t Mode = 0xFF;
+
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  CDC_REQ_SetLineEncoding, 0, INTERFACE_ID_CDC_CCI,
+										  LineEncoding, sizeof(LineEncoding)));
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  CDC_REQ_SetControlLineState, 0x03, INTERFACE_ID_CDC_CCI, NULL, 0));
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(sizeof(Report), ReadLastStatus(&Report));
+	TEST_ASSERT_EQUAL(0x03, Report.ConsoleLineState);
+
+	ClearReceived();
+	SendConsoleLine("mode 1\r");
+	TEST_ASSERT_EQUAL(strlen(Expected), ConsoleReceivedLength);
+	TEST_ASSERT(memcmp(Expected, ConsoleReceived, strlen(Expected)) == 0);
+
+	TEST_ASSERT_EQUAL(1, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE,
+										  VENDOR_REQ_GetMode, 0, 0, &Mode, sizeof(Mode)));
+	TEST_ASSERT_EQUAL(VENDOR_MODE_Sink, Mode);
+	TEST_ASSERT_EQUAL(sizeof(Report), ReadLastStatus(&Report));
+	TEST_ASSERT_EQUAL(VENDOR_MODE_Sink, Report.VendorMode);
+
+	// Sink: nothing comes back on the vendor pipe
+	TEST_ASSERT(Mock_HostSendPacket(VENDOR_OUT_EPADDR, "sink", 4));
+	RunFrames(4);
+	TEST_ASSERT_EQUAL(0, Mock_PendingPackets(VENDOR_OUT_EPADDR));
+	TEST_ASSERT_EQUAL(0, VendorReceivedLength);
+
+	ClearReceived();
+	SendConsoleLine("bogus\r");
+	TEST_ASSERT(memcmp("bogus\r\n?\r\n", ConsoleReceived, ConsoleReceivedLength) == 0);
+	TEST_ASSERT_EQUAL(10, ConsoleReceivedLength);
+}
+
+#ifdef IDLE_SLEEP
+static uint8_t EndpointInterrupts(const uint8_t Address)
+{
+	Endpoint_SelectEndpoint(Address);
+	return UEIENX;
+}
+
+// With all three functions idle the main loop sleeps in IDLE, armed to wake on
+// the OUT endpoints of the vendor pipe and the console, and a console line
+// ends the sleep.
+static void test_IdleSleep(void)
+{
+	static const char Expected[] = "mode\r\nmode 1\r\n";
+
+	uint32_t Sleeps = Mock_Stats.Sleeps;
+	RunFrames(2);
+	TEST_ASSERT(Mock_Stats.Sleeps > Sleeps);
+	TEST_ASSERT_EQUAL(SLEEP_MODE_IDLE, Mock_SleepMode);
+
+	// Sink mode, left by test_ConsoleMode: the vendor pipe only waits for data
+	TEST_ASSERT_EQUAL((1 << RXOUTE), EndpointInterrupts(VENDOR_OUT_EPADDR));
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(VENDOR_IN_EPADDR));
+	TEST_ASSERT_EQUAL((1 << RXOUTE), EndpointInterrupts(CDC_RX_EPADDR));
+	TEST_ASSERT_EQUAL((1 << RXSTPE), EndpointInterrupts(ENDPOINT_CONTROLEP));
+
+	uint32_t Interrupts = Mock_Stats.EndpointInterrupts;
+	ClearReceived();
+	SendConsoleLine("mode\r");
+	TEST_ASSERT_EQUAL(Interrupts + 1, Mock_Stats.EndpointInterrupts);
+	TEST_ASSERT_EQUAL(strlen(Expected), ConsoleReceivedLength);
+	TEST_ASSERT(memcmp(Expected, ConsoleReceived, strlen(Expected)) == 0);
+}
+#endif
+
+// A mode change with the vendor request and the LEDs set by the host each
+// show up in the next status report, an unchanged status sends nothing.
+static void test_StatusReport(void)
+{
+	Composite_StatusReport_t Report;
+	uint8_t LEDReport[COMPOSITE_HID_REPORT_SIZE] = {0x05};
+
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetIdle, 0, INTERFACE_ID_HID, NULL, 0));
+	RunFrames(20);
+	TEST_ASSERT_EQUAL(-1, ReadLastStatus(&Report));
+
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE,
+										  VENDOR_REQ_SetMode, VENDOR_MODE_Source, 0, NULL, 0));
+	RunFrames(1);
+	TEST_ASSERT_EQUAL(sizeof(Report), ReadLastStatus(&Report));
+	TEST_ASSERT_EQUAL(VENDOR_MODE_Source, Report.VendorMode);
+	TEST_ASSERT(VendorReceivedLength > 0);
+
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetReport, ((HID_REPORT_ITEM_Out + 1) << 8), INTERFACE_ID_HID,
+										  LEDReport, sizeof(LEDReport)));
+	TEST_ASSERT_EQUAL(LEDS_LED1 | LEDS_LED3, Mock_LEDs);
+	RunFrames(1);
+	TEST_ASSERT_EQUAL(sizeof(Report), ReadLastStatus(&Report));
+	TEST_ASSERT_EQUAL(0x05, Report.LEDs);
+
+	TEST_ASSERT_EQUAL(-1, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE,
+										   VENDOR_REQ_SetMode, VENDOR_MODE_Source + 1, 0, NULL, 0));
+}
+
+int main(void)
+{
+	Mock_Reset();
+	Mock_RunFirmware(Firmware_Main, 1);
+
+	RUN_TEST(test_ConfigurationDescriptor);
+	RUN_TEST(test_Configuration);
+	RUN_TEST(test_VendorEcho);
+	RUN_TEST(test_ConsoleMode);
+	#ifdef IDLE_SLEEP
+	RUN_TEST(test_IdleSleep);
+	#endif
+	RUN_TEST(test_StatusReport);
+
+	return 0;
+}
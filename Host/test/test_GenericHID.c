@@ -0,0 +1,737 @@
+// Report tests for the GenericHID firmware on the mock endpoint layer, built
+// for the polled and interrupt driven variants, the high-rate reports and the
+// multi-report mode.
+#include "MockUSB.h"
+#include "MockTest.h"
+#include "GenericHID.h"
+#include <avr/sleep.h>
+
+// Global Variables:
+extern USB_ClassInfo_HID_Device_t Generic_HID_Interface;
+extern Generic_Config_t GenericConfigEEPROM;
+
+int Firmware_Main(void);
+#ifdef GENERIC_WAKE_BUTTON
+void INT6_vect(void);
+#endif
+
+static void RunFrames(const uint16_t Frames)
+{
+	for (uint16_t i = 0; i < Frames; i++)
+	{
+		Mock_StartOfFrame();
+		#ifndef INTERRUPT_DATA_ENDPOINT
+		Mock_RunFirmware(Firmware_Main, 8);
+		#endif
+	}
+}
+
+#ifndef GENERIC_REPORT_IDS
+// Returns the length of the newest IN report, or -1 if none was sent.
+static int16_t ReadLastReport(uint8_t* const Report)
+{
+	int16_t Length = -1;
+	int16_t Received;
+
+	while ((Received = Mock_HostReadPacket(GENERIC_IN_EPADDR, Report, GENERIC_EPSIZE)) >= 0)
+		Length = Received;
+
+	return Length;
+}
+#endif
+
+// The LED report tests, the high-rate reports carry queued samples and the
+// multi-report mode has one report per report ID instead.
+#if !defined(GENERIC_HIGH_RATE) && !defined(GENERIC_REPORT_IDS)
+static void test_ReportOnConfiguration(void)
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	Mock_Configure();
+	TEST_ASSERT_EQUAL(LEDMASK_USB_READY, Mock_LEDs);
+	RunFrames(2);
+
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	TEST_ASSERT_EQUAL(0, Report[0]);
+	TEST_ASSERT_EQUAL(1, Report[1]);
+	TEST_ASSERT_EQUAL(0, Report[2]);
+	TEST_ASSERT_EQUAL(1, Report[3]);
+}
+
+// An unchanged report is only repeated once the idle period has elapsed.
+static void test_IdleRate(void)
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	RunFrames(100);
+	TEST_ASSERT_EQUAL(-1, ReadLastReport(Report));
+
+	// Idle rate of 20ms, in units of 4ms
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetIdle, (5 << 8), INTERFACE_ID_GenericHID, NULL, 0));
+	RunFrames(500);
+	ReadLastReport(Report);
+	RunFrames(25);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+
+	// Idle rate 0, only report changes
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetIdle, 0, INTERFACE_ID_GenericHID, NULL, 0));
+	RunFrames(100);
+	TEST_ASSERT_EQUAL(-1, ReadLastReport(Report));
+}
+
+static void test_SetReport(void)
+{
+	uint8_t Report[GENERIC_REPORT_SIZE] = {1, 0, 1, 0};
+
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetReport, ((HID_REPORT_ITEM_Out + 1) << 8),
+										  INTERFACE_ID_GenericHID, Report, sizeof(Report)));
+	TEST_ASSERT_EQUAL(LEDS_LED1 | LEDS_LED3, Mock_LEDs);
+
+	// The changed LEDs are reported on the interrupt endpoint.
+	RunFrames(2);
+	memset(Report, 0xFF, sizeof(Report));
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	TEST_ASSERT_EQUAL(1, Report[0]);
+	TEST_ASSERT_EQUAL(0, Report[1]);
+	TEST_ASSERT_EQUAL(1, Report[2]);
+	TEST_ASSERT_EQUAL(0, Report[3]);
+}
+
+static void test_GetReport(void)
+{
+	uint8_t Report[GENERIC_REPORT_SIZE];
+
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE,
+					  Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE,
+									   HID_REQ_GetReport, ((HID_REPORT_ITEM_In + 1) << 8),
+									   INTERFACE_ID_GenericHID, Report, sizeof(Report)));
+	TEST_ASSERT_EQUAL(1, Report[0]);
+	TEST_ASSERT_EQUAL(1, Report[2]);
+}
+
+#ifdef GENERIC_DIRTY_REPORT
+// The report is only rebuilt once the application marks its data changed.
+static void test_ReportOnMark(void)
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	RunFrames(2);
+	ReadLastReport(Report);
+
+	Mock_LEDs = LEDS_LED4;
+	RunFrames(10);
+	TEST_ASSERT_EQUAL(-1, ReadLastReport(Report));
+
+	Generic_MarkReportDirty();
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	TEST_ASSERT_EQUAL(0, Report[0]);
+	TEST_ASSERT_EQUAL(1, Report[3]);
+
+	// Marked without a change, nothing is sent
+	Generic_MarkReportDirty();
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(-1, ReadLastReport(Report));
+}
+#else
+// Every poll rebuilds the report, a change is sent without a mark.
+static void test_ReportOnChange(void)
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	RunFrames(2);
+	ReadLastReport(Report);
+
+	Mock_LEDs = LEDS_LED4;
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	TEST_ASSERT_EQUAL(0, Report[0]);
+	TEST_ASSERT_EQUAL(1, Report[3]);
+
+	RunFrames(10);
+	TEST_ASSERT_EQUAL(-1, ReadLastReport(Report));
+}
+#endif
+
+#ifdef INTERRUPT_DATA_ENDPOINT
+// A report due while the host has not taken the last one is sent from the
+// endpoint interrupt as soon as the bank is free, not on the next frame.
+static void test_ReportWhenBankFree(void)
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	RunFrames(2);
+	ReadLastReport(Report);
+
+	Mock_LEDs = LEDS_LED1;
+	Generic_MarkReportDirty();
+	RunFrames(1);
+	Mock_LEDs = LEDS_LED2;
+	Generic_MarkReportDirty();
+	RunFrames(1);
+	Endpoint_SelectEndpoint(GENERIC_IN_EPADDR);
+	TEST_ASSERT(UEIENX & (1 << TXINE));
+
+	uint32_t Interrupts = Mock_Stats.EndpointInterrupts;
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, Mock_HostReadPacket(GENERIC_IN_EPADDR, Report, sizeof(Report)));
+	TEST_ASSERT_EQUAL(1, Report[0]);
+	TEST_ASSERT_EQUAL(Interrupts + 1, Mock_Stats.EndpointInterrupts);
+	Endpoint_SelectEndpoint(GENERIC_IN_EPADDR);
+	TEST_ASSERT(!(UEIENX & (1 << TXINE)));
+
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, Mock_HostReadPacket(GENERIC_IN_EPADDR, Report, sizeof(Report)));
+	TEST_ASSERT_EQUAL(0, Report[0]);
+	TEST_ASSERT_EQUAL(1, Report[1]);
+	TEST_ASSERT_EQUAL(-1, ReadLastReport(Report));
+}
+#endif
+
+#if defined(GENERIC_WAKE_BUTTON) && !defined(INTERRUPT_DATA_ENDPOINT)
+// Drives the wake button pin, the button pulls it low, and fires the pin
+// change interrupt.
+static void SetWakeButton(const bool Pressed)
+{
+	if (Pressed)
+		PINE &= ~(1 << PE6);
+	else
+		PINE |= (1 << PE6);
+
+	Mock_EnterInterrupt();
+	INT6_vect();
+	Mock_LeaveInterrupt();
+}
+
+static void SetRemoteWakeup(const bool Enable)
+{
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_STANDARD | REQREC_DEVICE,
+										  Enable ? REQ_SetFeature : REQ_ClearFeature,
+										  FEATURE_SEL_DeviceRemoteWakeup, 0, NULL, 0));
+}
+
+// The wake button pressed or released while the bus is suspended resumes it,
+// once the host enabled remote wakeup, and is reported right after the wakeup.
+static void test_RemoteWakeup(void)
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	RunFrames(2);
+	ReadLastReport(Report);
+
+	// Not enabled: the main loop sleeps, the report waits for the host
+	SetRemoteWakeup(false);
+	Mock_LEDs = LEDS_LED2;
+	Mock_Suspend();
+	SetWakeButton(true);
+	uint32_t Sleeps = Mock_Stats.Sleeps;
+	RunFrames(8);
+	TEST_ASSERT(Mock_Stats.Sleeps > Sleeps);
+	TEST_ASSERT_EQUAL(SLEEP_MODE_PWR_DOWN, Mock_SleepMode);
+	TEST_ASSERT_EQUAL(0, Mock_Stats.RemoteWakeups);
+	TEST_ASSERT_EQUAL(LEDS_NO_LEDS, Mock_LEDs);
+	TEST_ASSERT_EQUAL(-1, ReadLastReport(Report));
+
+	Mock_WakeUp();
+	TEST_ASSERT_EQUAL(LEDS_LED2, Mock_LEDs);
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	TEST_ASSERT_EQUAL(1, Report[1]);
+	TEST_ASSERT_EQUAL(1, Report[GENERIC_WAKE_BUTTON_INDEX]);
+
+	// Enabled: nothing pending, the main loop sleeps until the button is released
+	SetRemoteWakeup(true);
+	Mock_LEDs = LEDS_LED3;
+	Mock_Suspend();
+	RunFrames(8);
+	TEST_ASSERT_EQUAL(0, Mock_Stats.RemoteWakeups);
+
+	SetWakeButton(false);
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(1, Mock_Stats.RemoteWakeups);
+	TEST_ASSERT_EQUAL(LEDS_LED3, Mock_LEDs);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	TEST_ASSERT_EQUAL(1, Report[2]);
+	TEST_ASSERT_EQUAL(0, Report[GENERIC_WAKE_BUTTON_INDEX]);
+
+	// The resume is signalled once per suspend, the device then sleeps until
+	// the host resumes the bus
+	Mock_DeferResume = true;
+	Mock_LEDs = LEDS_LED4;
+	Mock_Suspend();
+	SetWakeButton(true);
+	Sleeps = Mock_Stats.Sleeps;
+	RunFrames(8);
+	TEST_ASSERT_EQUAL(2, Mock_Stats.RemoteWakeups);
+	TEST_ASSERT(Mock_Stats.Sleeps > Sleeps);
+	TEST_ASSERT_EQUAL(-1, ReadLastReport(Report));
+
+	Mock_WakeUp();
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	TEST_ASSERT_EQUAL(1, Report[3]);
+	TEST_ASSERT_EQUAL(1, Report[GENERIC_WAKE_BUTTON_INDEX]);
+
+	Mock_Suspend();
+	SetWakeButton(false);
+	RunFrames(8);
+	TEST_ASSERT_EQUAL(3, Mock_Stats.RemoteWakeups);
+	Mock_WakeUp();
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	TEST_ASSERT_EQUAL(0, Report[GENERIC_WAKE_BUTTON_INDEX]);
+
+	Mock_DeferResume = false;
+	SetRemoteWakeup(false);
+}
+#endif
+#endif
+
+// Remote wakeup is only declared by the builds with a wake source.
+static void test_RemoteWakeupAttribute(void)
+{
+	uint8_t Configuration[sizeof(USB_Descriptor_Configuration_Header_t)];
+
+	TEST_ASSERT_EQUAL(sizeof(Configuration), Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE,
+															  REQ_GetDescriptor, (DTYPE_Configuration << 8), 0,
+															  Configuration, sizeof(Configuration)));
+	#ifdef GENERIC_WAKE_BUTTON
+	TEST_ASSERT(Configuration[7] & USB_CONFIG_ATTR_REMOTEWAKEUP);
+	#else
+	TEST_ASSERT(!(Configuration[7] & USB_CONFIG_ATTR_REMOTEWAKEUP));
+	#endif
+}
+
+#if defined(IDLE_SLEEP) && !defined(INTERRUPT_DATA_ENDPOINT)
+static uint8_t EndpointInterrupts(const uint8_t Address)
+{
+	Endpoint_SelectEndpoint(Address);
+	return UEIENX;
+}
+
+// Once the report of the frame is sent the main loop sleeps in IDLE until the
+// next Start Of Frame, or a control request.
+static void test_IdleSleep(void)
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	// The configuration block is written back first
+	RunFrames(16);
+
+	uint32_t Sleeps = Mock_Stats.Sleeps;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		RunFrames(1);
+		while (Mock_HostReadPacket(GENERIC_IN_EPADDR, Report, sizeof(Report)) >= 0)
+			;
+	}
+	TEST_ASSERT(Mock_Stats.Sleeps > Sleeps);
+	TEST_ASSERT_EQUAL(SLEEP_MODE_IDLE, Mock_SleepMode);
+
+	// Stop the firmware in its next sleep, the frame may have ended it
+	// elsewhere in the main loop.
+	Sleeps = Mock_Stats.Sleeps;
+	for (uint8_t i = 0; (i < 16) && (Mock_Stats.Sleeps == Sleeps); i++)
+		Mock_RunFirmware(Firmware_Main, 1);
+	TEST_ASSERT(Mock_Stats.Sleeps > Sleeps);
+
+	TEST_ASSERT_EQUAL((1 << RXSTPE), EndpointInterrupts(ENDPOINT_CONTROLEP));
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(GENERIC_IN_EPADDR));
+	#ifdef GENERIC_HIGH_RATE
+	TEST_ASSERT_EQUAL((1 << RXOUTE), EndpointInterrupts(GENERIC_OUT_EPADDR));
+	#endif
+}
+#endif
+
+// Reads the configuration block with GET_REPORT of type Feature.
+static void GetConfig(Generic_Config_t* const Config)
+{
+	uint8_t Report[1 + sizeof(Generic_Config_t)];
+	uint8_t Offset = (GENERIC_CONFIG_REPORT_ID ? 1 : 0);
+
+	TEST_ASSERT_EQUAL(Offset + sizeof(Generic_Config_t),
+					  Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE,
+									   HID_REQ_GetReport, ((HID_REPORT_ITEM_Feature + 1) << 8) | GENERIC_CONFIG_REPORT_ID,
+									   INTERFACE_ID_GenericHID, Report, Offset + sizeof(Generic_Config_t)));
+	memcpy(Config, &Report[Offset], sizeof(Generic_Config_t));
+}
+
+// Writes the configuration block with SET_REPORT of type Feature.
+static void SetConfig(const Generic_Config_t* const Config)
+{
+	uint8_t Report[1 + sizeof(Generic_Config_t)] = {GENERIC_CONFIG_REPORT_ID};
+	uint8_t Offset = (GENERIC_CONFIG_REPORT_ID ? 1 : 0);
+
+	memcpy(&Report[Offset], Config, sizeof(Generic_Config_t));
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetReport, ((HID_REPORT_ITEM_Feature + 1) << 8) | GENERIC_CONFIG_REPORT_ID,
+										  INTERFACE_ID_GenericHID, Report, Offset + sizeof(Generic_Config_t)));
+}
+
+// The configuration block is read and written in one feature report and
+// written back to EEPROM from the main loop; invalid blocks are ignored.
+static void test_ConfigFeature(void)
+{
+	Generic_Config_t Config;
+	Generic_Config_t NewConfig = {GENERIC_CONFIG_VERSION, 10, 0x05, 3, {0}};
+
+	// The interrupt driven builds only enter the main loop here, after
+	// SetupHardware has loaded the block
+	Mock_RunFirmware(Firmware_Main, 1);
+
+	// The zeroed mock EEPROM holds no valid block
+	GetConfig(&Config);
+	TEST_ASSERT_EQUAL(GENERIC_CONFIG_VERSION, Config.Version);
+	TEST_ASSERT_EQUAL(4, Config.SamplePeriodMS);
+	TEST_ASSERT_EQUAL(0xFF, Config.ReportMask);
+	TEST_ASSERT_EQUAL(0, Config.SensorThreshold);
+
+	SetConfig(&NewConfig);
+	GetConfig(&Config);
+	TEST_ASSERT(memcmp(&Config, &NewConfig, sizeof(Config)) == 0);
+
+	// One byte per pass of the main loop, which yields up to four times
+	Mock_RunFirmware(Firmware_Main, 4 * sizeof(Generic_Config_t));
+	TEST_ASSERT(memcmp(&GenericConfigEEPROM, &NewConfig, sizeof(NewConfig)) == 0);
+
+	Config.Version = GENERIC_CONFIG_VERSION + 1;
+	SetConfig(&Config);
+	Config = NewConfig;
+	Config.SamplePeriodMS = 0;
+	SetConfig(&Config);
+	GetConfig(&Config);
+	TEST_ASSERT(memcmp(&Config, &NewConfig, sizeof(Config)) == 0);
+
+	// The class driver copies every GET_REPORT into its previous report
+	// buffer, the next IN report then counts as changed.
+	RunFrames(2);
+	while (Mock_HostReadPacket(GENERIC_IN_EPADDR, &Config, sizeof(Config)) >= 0);
+}
+
+// Every report from the host is counted in the performance counters.
+static void test_PerfCounters(void)
+{
+	uint8_t Report[GENERIC_REPORT_SIZE] = {0, 1, 0, 1};
+	PerfCounters_t Counters;
+
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE,
+										  PERF_REQ_ResetCounters, 0, 0, NULL, 0));
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetReport, ((HID_REPORT_ITEM_Out + 1) << 8),
+										  INTERFACE_ID_GenericHID, Report, sizeof(Report)));
+	TEST_ASSERT_EQUAL(sizeof(Counters), Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE,
+														 PERF_REQ_GetCounters, 0, 0, &Counters, sizeof(Counters)));
+	TEST_ASSERT_EQUAL(1, Counters.OUTPackets);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, Counters.OUTBytes);
+}
+
+#ifdef CYCLE_PROBES
+// Every report created since the reset is measured.
+static void test_CycleProbes(void)
+{
+	CycleProbe_Stats_t Stats;
+	uint32_t BucketTotal = 0;
+
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE,
+										  CYCLE_REQ_ResetProbes, 0, 0, NULL, 0));
+	RunFrames(10);
+	TEST_ASSERT_EQUAL(sizeof(Stats), Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE,
+													  CYCLE_REQ_GetProbe, 0, CYCLE_PROBE_CreateHIDReport,
+													  &Stats, sizeof(Stats)));
+	TEST_ASSERT(Stats.Count > 0);
+	TEST_ASSERT(Stats.MinCycles <= Stats.MaxCycles);
+	for (uint8_t i = 0; i < CYCLE_PROBE_BUCKETS; i++)
+		BucketTotal += Stats.Buckets[i];
+	TEST_ASSERT_EQUAL(Stats.Count, BucketTotal);
+
+	TEST_ASSERT_EQUAL(-1, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE,
+										   CYCLE_REQ_GetProbe, 0, CYCLE_PROBE_COUNT, &Stats, sizeof(Stats)));
+}
+#endif
+
+#ifdef GENERIC_HIGH_RATE
+// Every frame carries the next queued sample, none is lost or repeated.
+static void test_SampleEveryFrame(void)
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	Mock_Configure();
+	TEST_ASSERT_EQUAL(LEDMASK_USB_READY, Mock_LEDs);
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	uint16_t Sequence = Report[GENERIC_SAMPLE_SEQUENCE] | (Report[GENERIC_SAMPLE_SEQUENCE + 1] << 8);
+
+	for (uint16_t i = 0; i < 100; i++)
+	{
+		RunFrames(1);
+		TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, Mock_HostReadPacket(GENERIC_IN_EPADDR, Report, sizeof(Report)));
+		TEST_ASSERT_EQUAL(-1, Mock_HostReadPacket(GENERIC_IN_EPADDR, Report, sizeof(Report)));
+
+		Sequence++;
+		TEST_ASSERT_EQUAL(Sequence, Report[GENERIC_SAMPLE_SEQUENCE] | (Report[GENERIC_SAMPLE_SEQUENCE + 1] << 8));
+		for (uint8_t j = GENERIC_SAMPLE_PAYLOAD; j < GENERIC_REPORT_SIZE; j++)
+			TEST_ASSERT_EQUAL((uint8_t)(Sequence + j), Report[j]);
+	}
+}
+
+// GET_REPORT returns the newest sample and leaves the queue to the IN
+// endpoint, no sample is lost from the IN reports.
+static void test_GetReportKeepsQueue(void)
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	RunFrames(1);
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	uint16_t Sequence = Report[GENERIC_SAMPLE_SEQUENCE] | (Report[GENERIC_SAMPLE_SEQUENCE + 1] << 8);
+
+	for (uint8_t i = 0; i < (GENERIC_SAMPLE_QUEUE_DEPTH + 2); i++)
+	{
+		TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE,
+						  Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE,
+										   HID_REQ_GetReport, ((HID_REPORT_ITEM_In + 1) << 8),
+										   INTERFACE_ID_GenericHID, Report, GENERIC_REPORT_SIZE));
+		TEST_ASSERT((uint16_t)((Report[GENERIC_SAMPLE_SEQUENCE] | (Report[GENERIC_SAMPLE_SEQUENCE + 1] << 8)) -
+							   Sequence) <= GENERIC_SAMPLE_QUEUE_DEPTH);
+	}
+
+	for (uint8_t i = 0; i < (GENERIC_SAMPLE_QUEUE_DEPTH + 2); i++)
+	{
+		RunFrames(1);
+		TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+		Sequence++;
+		TEST_ASSERT_EQUAL(Sequence, Report[GENERIC_SAMPLE_SEQUENCE] | (Report[GENERIC_SAMPLE_SEQUENCE + 1] << 8));
+	}
+}
+
+// Reports from the host arrive on the interrupt OUT endpoint, and the samples
+// queued afterwards carry the new LED state.
+static void test_OUTEndpointReport(void)
+{
+	uint8_t Report[GENERIC_EPSIZE] = {0, 1, 1, 0};
+
+	TEST_ASSERT(Mock_HostSendPacket(GENERIC_OUT_EPADDR, Report, GENERIC_REPORT_SIZE));
+	RunFrames(1);
+	TEST_ASSERT_EQUAL(LEDS_LED2 | LEDS_LED3, Mock_LEDs);
+	TEST_ASSERT_EQUAL(0, Mock_PendingPackets(GENERIC_OUT_EPADDR));
+
+	// The endpoint holds one report, read every frame to get past the
+	// samples queued before the change.
+	for (uint8_t i = 0; i < (GENERIC_SAMPLE_QUEUE_DEPTH + 2); i++)
+	{
+		RunFrames(1);
+		TEST_ASSERT_EQUAL(GENERIC_REPORT_SIZE, ReadLastReport(Report));
+	}
+	TEST_ASSERT_EQUAL(0, Report[0]);
+	TEST_ASSERT_EQUAL(1, Report[1]);
+	TEST_ASSERT_EQUAL(1, Report[2]);
+	TEST_ASSERT_EQUAL(0, Report[3]);
+}
+#endif
+
+#ifdef GENERIC_REPORT_IDS
+// Runs the firmware for a number of frames, reading the IN endpoint after
+// every frame. Counts the reports per report ID in Counts and keeps the
+// newest of each in Reports.
+static void RunFramesReading(const uint16_t Frames, uint16_t Counts[4], uint8_t Reports[4][GENERIC_EPSIZE])
+{
+	uint8_t Report[GENERIC_EPSIZE];
+
+	memset(Counts, 0, 4 * sizeof(Counts[0]));
+
+	for (uint16_t i = 0; i < Frames; i++)
+	{
+		RunFrames(1);
+
+		while (Mock_HostReadPacket(GENERIC_IN_EPADDR, Report, sizeof(Report)) > 0)
+		{
+			TEST_ASSERT(Report[0] && (Report[0] < 4));
+			Counts[Report[0]]++;
+			memcpy(Reports[Report[0]], Report, sizeof(Report));
+		}
+	}
+}
+
+// Every report is sent once after the configuration.
+static void test_ReportsOnConfiguration(void)
+{
+	uint16_t Counts[4];
+	uint8_t Reports[4][GENERIC_EPSIZE];
+
+	Mock_Configure();
+	RunFramesReading(3, Counts, Reports);
+
+	TEST_ASSERT_EQUAL(1, Counts[GENERIC_REPORT_ID_Status]);
+	TEST_ASSERT_EQUAL(1, Counts[GENERIC_REPORT_ID_Sensor]);
+	TEST_ASSERT_EQUAL(1, Counts[GENERIC_REPORT_ID_Counters]);
+	TEST_ASSERT_EQUAL(0, Reports[GENERIC_REPORT_ID_Status][1]);
+	TEST_ASSERT_EQUAL(1, Reports[GENERIC_REPORT_ID_Status][2]);
+	TEST_ASSERT_EQUAL(0, Reports[GENERIC_REPORT_ID_Status][3]);
+	TEST_ASSERT_EQUAL(1, Reports[GENERIC_REPORT_ID_Status][4]);
+}
+
+// Each report is only sent when its own content changes: the sensor block
+// every 4ms, the uptime in the counters every second, the status not at all
+// within its idle period.
+static void test_OnlyChangesSent(void)
+{
+	uint16_t Counts[4];
+	uint8_t Reports[4][GENERIC_EPSIZE];
+
+	RunFramesReading(400, Counts, Reports);
+	TEST_ASSERT_EQUAL(0, Counts[GENERIC_REPORT_ID_Status]);
+	TEST_ASSERT_EQUAL(100, Counts[GENERIC_REPORT_ID_Sensor]);
+	TEST_ASSERT_EQUAL(0, Counts[GENERIC_REPORT_ID_Counters]);
+
+	RunFramesReading(600, Counts, Reports);
+	TEST_ASSERT_EQUAL(1, Counts[GENERIC_REPORT_ID_Counters]);
+	TEST_ASSERT_EQUAL(1, Reports[GENERIC_REPORT_ID_Counters][5]);
+}
+
+// A status report from the host sets the LEDs, and the changed status and
+// host report count are sent once.
+static void test_StatusReport(void)
+{
+	uint8_t Report[1 + GENERIC_STATUS_REPORT_SIZE] = {GENERIC_REPORT_ID_Status, 1, 0, 1, 0};
+	uint16_t Counts[4];
+	uint8_t Reports[4][GENERIC_EPSIZE];
+
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetReport, ((HID_REPORT_ITEM_Out + 1) << 8) | GENERIC_REPORT_ID_Status,
+										  INTERFACE_ID_GenericHID, Report, sizeof(Report)));
+	TEST_ASSERT_EQUAL(LEDS_LED1 | LEDS_LED3, Mock_LEDs);
+
+	RunFramesReading(8, Counts, Reports);
+	TEST_ASSERT_EQUAL(1, Counts[GENERIC_REPORT_ID_Status]);
+	TEST_ASSERT_EQUAL(1, Reports[GENERIC_REPORT_ID_Status][1]);
+	TEST_ASSERT_EQUAL(0, Reports[GENERIC_REPORT_ID_Status][2]);
+	TEST_ASSERT_EQUAL(1, Reports[GENERIC_REPORT_ID_Status][3]);
+	TEST_ASSERT_EQUAL(0, Reports[GENERIC_REPORT_ID_Status][4]);
+	TEST_ASSERT_EQUAL(1, Counts[GENERIC_REPORT_ID_Counters]);
+	TEST_ASSERT_EQUAL(1, Reports[GENERIC_REPORT_ID_Counters][1]);
+
+	// GET_REPORT names the report and gets it whether it changed or not
+	memset(Report, 0, sizeof(Report));
+	TEST_ASSERT_EQUAL(sizeof(Report), Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE,
+													   HID_REQ_GetReport, ((HID_REPORT_ITEM_In + 1) << 8) | GENERIC_REPORT_ID_Status,
+													   INTERFACE_ID_GenericHID, Report, sizeof(Report)));
+	TEST_ASSERT_EQUAL(GENERIC_REPORT_ID_Status, Report[0]);
+	TEST_ASSERT_EQUAL(1, Report[1]);
+	TEST_ASSERT_EQUAL(1, Report[3]);
+}
+
+// SET_IDLE with a report ID only changes the idle period of that report.
+static void test_IdlePerReport(void)
+{
+	uint16_t Counts[4];
+	uint8_t Reports[4][GENERIC_EPSIZE];
+	uint8_t IdleRate;
+
+	// Counters every 8ms, in units of 4ms
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetIdle, (2 << 8) | GENERIC_REPORT_ID_Counters,
+										  INTERFACE_ID_GenericHID, NULL, 0));
+	TEST_ASSERT_EQUAL(1, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_GetIdle, GENERIC_REPORT_ID_Counters,
+										  INTERFACE_ID_GenericHID, &IdleRate, 1));
+	TEST_ASSERT_EQUAL(2, IdleRate);
+	TEST_ASSERT_EQUAL(1, Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_GetIdle, GENERIC_REPORT_ID_Status,
+										  INTERFACE_ID_GenericHID, &IdleRate, 1));
+	TEST_ASSERT_EQUAL(125, IdleRate);
+
+	RunFramesReading(80, Counts, Reports);
+	TEST_ASSERT_EQUAL(0, Counts[GENERIC_REPORT_ID_Status]);
+	TEST_ASSERT(Counts[GENERIC_REPORT_ID_Counters] >= 9);
+
+	// Unknown report IDs are stalled
+	TEST_ASSERT_EQUAL(-1, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										   HID_REQ_SetIdle, (2 << 8) | 9, INTERFACE_ID_GenericHID, NULL, 0));
+
+	// Report ID 0 sets every report back to only sending changes
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  HID_REQ_SetIdle, 0, INTERFACE_ID_GenericHID, NULL, 0));
+	RunFramesReading(80, Counts, Reports);
+	TEST_ASSERT_EQUAL(0, Counts[GENERIC_REPORT_ID_Counters]);
+}
+
+// The multi-report mode applies the report mask and the sensor threshold.
+static void test_ConfigApplied(void)
+{
+	Generic_Config_t Config = {GENERIC_CONFIG_VERSION, 4, 0x07, 0, {0}};
+	uint16_t Counts[4];
+	uint8_t Reports[4][GENERIC_EPSIZE];
+
+	// Sensor block disabled
+	Config.ReportMask = 0x05;
+	SetConfig(&Config);
+	RunFramesReading(100, Counts, Reports);
+	TEST_ASSERT_EQUAL(0, Counts[GENERIC_REPORT_ID_Sensor]);
+
+	// Sensor block only when a byte moved by more than one step
+	Config.ReportMask = 0x07;
+	Config.SensorThreshold = 1;
+	SetConfig(&Config);
+	RunFramesReading(400, Counts, Reports);
+	TEST_ASSERT(Counts[GENERIC_REPORT_ID_Sensor] >= 49);
+	TEST_ASSERT(Counts[GENERIC_REPORT_ID_Sensor] <= 51);
+
+	// Back to the defaults
+	Config.SensorThreshold = 0;
+	Config.ReportMask = 0xFF;
+	SetConfig(&Config);
+}
+#endif
+
+int main(void)
+{
+	Mock_Reset();
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	// The main loop is idle, everything runs from the USB interrupts.
+	SetupHardware();
+	GlobalInterruptEnable();
+	#else
+	Mock_RunFirmware(Firmware_Main, 1);
+	#endif
+
+	#ifdef GENERIC_HIGH_RATE
+	RUN_TEST(test_SampleEveryFrame);
+	RUN_TEST(test_GetReportKeepsQueue);
+	RUN_TEST(test_OUTEndpointReport);
+	RUN_TEST(test_ConfigFeature);
+	#elif defined(GENERIC_REPORT_IDS)
+	RUN_TEST(test_ReportsOnConfiguration);
+	RUN_TEST(test_OnlyChangesSent);
+	RUN_TEST(test_StatusReport);
+	RUN_TEST(test_IdlePerReport);
+	RUN_TEST(test_ConfigFeature);
+	RUN_TEST(test_ConfigApplied);
+	#else
+	RUN_TEST(test_ReportOnConfiguration);
+	RUN_TEST(test_IdleRate);
+	RUN_TEST(test_SetReport);
+	RUN_TEST(test_GetReport);
+	#ifdef GENERIC_DIRTY_REPORT
+	RUN_TEST(test_ReportOnMark);
+	#else
+	RUN_TEST(test_ReportOnChange);
+	#endif
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	RUN_TEST(test_ReportWhenBankFree);
+	#endif
+	#if defined(GENERIC_WAKE_BUTTON) && !defined(INTERRUPT_DATA_ENDPOINT)
+	RUN_TEST(test_RemoteWakeup);
+	#endif
+	RUN_TEST(test_ConfigFeature);
+	#endif
+	RUN_TEST(test_RemoteWakeupAttribute);
+	#if defined(IDLE_SLEEP) && !defined(INTERRUPT_DATA_ENDPOINT)
+	RUN_TEST(test_IdleSleep);
+	#endif
+	RUN_TEST(test_PerfCounters);
+	#ifdef CYCLE_PROBES
+	RUN_TEST(test_CycleProbes);
+	#endif
+
+	return 0;
+}
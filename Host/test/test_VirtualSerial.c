@@ -0,0 +1,199 @@
+// Echo tests for the VirtualSerial firmware on the mock endpoint layer, built
+// for the stream, interrupt driven and zero-copy echo variants.
+#include "MockUSB.h"
+#include "MockTest.h"
+#include "VirtualSerial.h"
+#include <avr/sleep.h>
+
+// Macros:
+#define HOST_BUFFER_SIZE	4096
+
+// Global Variables:
+static uint8_t HostReceived[HOST_BUFFER_SIZE];
+static uint16_t HostReceivedLength;
+static uint16_t HostReceivedPackets;
+static uint16_t HostReceivedZLPs;
+
+extern USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface;
+
+int Firmware_Main(void);
+
+static void DrainIN(void)
+{
+	int16_t Length;
+
+	while ((Length = Mock_HostReadPacket(CDC_TX_EPADDR, &HostReceived[HostReceivedLength],
+										 HOST_BUFFER_SIZE - HostReceivedLength)) >= 0)
+	{
+		HostReceivedLength += Length;
+		HostReceivedPackets++;
+		if (!(Length))
+			HostReceivedZLPs++;
+	}
+}
+
+static void ClearReceived(void)
+{
+	HostReceivedLength = 0;
+	HostReceivedPackets = 0;
+	HostReceivedZLPs = 0;
+}
+
+static void RunFrames(const uint16_t Frames)
+{
+	for (uint16_t i = 0; i < Frames; i++)
+	{
+		Mock_StartOfFrame();
+		Mock_RunFirmware(Firmware_Main, 64);
+		DrainIN();
+	}
+}
+
+static void FillPattern(uint8_t* const Data, const uint16_t Length, const uint8_t Seed)
+{
+	for (uint16_t i = 0; i < Length; i++)
+		Data[i] = (uint8_t)(Seed + i * 3);
+}
+
+static void SetLineEncoding(const uint32_t BaudRateBPS)
+{
+	uint8_t LineEncoding[7] = {BaudRateBPS & 0xFF, (BaudRateBPS >> 8) & 0xFF, (BaudRateBPS >> 16) & 0xFF,
+							   BaudRateBPS >> 24, 0, 0, 8};
+
+	TEST_ASSERT_EQUAL(0, Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+										  CDC_REQ_SetLineEncoding, 0, 0, LineEncoding, sizeof(LineEncoding)));
+}
+
+// Nothing is echoed until the host has opened the port.
+static void test_NoEchoBeforeLineEncoding(void)
+{
+	uint8_t Data[4] = "abc";
+
+	Mock_Configure();
+	TEST_ASSERT(Mock_HostSendPacket(CDC_RX_EPADDR, Data, sizeof(Data)));
+	RunFrames(8);
+
+	TEST_ASSERT_EQUAL(0, HostReceivedLength);
+	TEST_ASSERT_EQUAL(1, Mock_PendingPackets(CDC_RX_EPADDR));
+
+	SetLineEncoding(115200);
+	TEST_ASSERT_EQUAL(115200, VirtualSerial_CDC_Interface.State.LineEncoding.BaudRateBPS);
+	RunFrames(8);
+
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+}
+
+static void test_GetLineEncoding(void)
+{
+	uint8_t LineEncoding[7];
+
+	TEST_ASSERT_EQUAL(sizeof(LineEncoding),
+					  Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE,
+									   CDC_REQ_GetLineEncoding, 0, 0, LineEncoding, sizeof(LineEncoding)));
+	TEST_ASSERT_EQUAL(115200, LineEncoding[0] | (LineEncoding[1] << 8) | (LineEncoding[2] << 16));
+	TEST_ASSERT_EQUAL(8, LineEncoding[6]);
+}
+
+static void test_EchoStream(void)
+{
+	uint8_t Data[CDC_TXRX_EPSIZE * 20 + 5];
+
+	ClearReceived();
+	FillPattern(Data, sizeof(Data), 0x20);
+	TEST_ASSERT_EQUAL(sizeof(Data), Mock_HostWrite(CDC_RX_EPADDR, Data, sizeof(Data)));
+	RunFrames(256);
+
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+	TEST_ASSERT_EQUAL(0, Mock_PendingPackets(CDC_RX_EPADDR));
+}
+
+// A transfer ending with a full packet must be terminated with a zero length
+// packet, or the host read does not complete.
+static void test_ZeroLengthPacketAfterFullPacket(void)
+{
+	uint8_t Data[CDC_TXRX_EPSIZE];
+
+	ClearReceived();
+	FillPattern(Data, sizeof(Data), 0x40);
+	Mock_HostSendPacket(CDC_RX_EPADDR, Data, sizeof(Data));
+	RunFrames(16);
+
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+	TEST_ASSERT_EQUAL(1, HostReceivedZLPs);
+	TEST_ASSERT_EQUAL(2, HostReceivedPackets);
+}
+
+#ifdef IDLE_SLEEP
+static uint8_t EndpointInterrupts(const uint8_t Address)
+{
+	Endpoint_SelectEndpoint(Address);
+	return UEIENX;
+}
+
+// With nothing to echo the main loop sleeps in IDLE, armed to wake on the
+// endpoint it waits on, and still echoes in the same frames as without sleep.
+static void test_IdleSleep(void)
+{
+	uint8_t Data[CDC_TXRX_EPSIZE - 1]; // Short, no zero length packet follows
+
+	ClearReceived();
+	uint32_t Sleeps = Mock_Stats.Sleeps;
+	RunFrames(2);
+	TEST_ASSERT(Mock_Stats.Sleeps > Sleeps);
+	TEST_ASSERT_EQUAL(SLEEP_MODE_IDLE, Mock_SleepMode);
+
+	FillPattern(Data, sizeof(Data), 0x60);
+	// Waiting for a packet or a control request, the packet ends the sleep
+	TEST_ASSERT_EQUAL((1 << RXOUTE), EndpointInterrupts(CDC_RX_EPADDR));
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(CDC_TX_EPADDR));
+	TEST_ASSERT_EQUAL((1 << RXSTPE), EndpointInterrupts(ENDPOINT_CONTROLEP));
+
+	uint32_t Interrupts = Mock_Stats.EndpointInterrupts;
+	TEST_ASSERT(Mock_HostSendPacket(CDC_RX_EPADDR, Data, sizeof(Data)));
+	TEST_ASSERT_EQUAL(Interrupts + 1, Mock_Stats.EndpointInterrupts);
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	// The interrupt took the packet and stays armed for the next one
+	TEST_ASSERT_EQUAL((1 << RXOUTE), EndpointInterrupts(CDC_RX_EPADDR));
+	#else
+	TEST_ASSERT_EQUAL(0, EndpointInterrupts(CDC_RX_EPADDR));
+	#endif
+
+	RunFrames(2);
+	TEST_ASSERT_EQUAL(sizeof(Data), HostReceivedLength);
+	TEST_ASSERT(memcmp(Data, HostReceived, sizeof(Data)) == 0);
+}
+#endif
+
+static void test_DeviceDescriptor(void)
+{
+	uint8_t Descriptor[18];
+
+	TEST_ASSERT_EQUAL(sizeof(Descriptor),
+					  Mock_HostControl(REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE, REQ_GetDescriptor,
+									   (DTYPE_Device << 8), 0, Descriptor, sizeof(Descriptor)));
+	TEST_ASSERT_EQUAL(0x03EB, Descriptor[8] | (Descriptor[9] << 8));
+	TEST_ASSERT_EQUAL(0x2044, Descriptor[10] | (Descriptor[11] << 8));
+}
+
+int main(void)
+{
+	Mock_Reset();
+	Mock_RunFirmware(Firmware_Main, 1);
+
+	// The host reads the IN endpoint whenever the firmware waits for it.
+	Mock_SetHostHook(DrainIN);
+
+	RUN_TEST(test_NoEchoBeforeLineEncoding);
+	RUN_TEST(test_GetLineEncoding);
+	RUN_TEST(test_EchoStream);
+	RUN_TEST(test_ZeroLengthPacketAfterFullPacket);
+	#ifdef IDLE_SLEEP
+	RUN_TEST(test_IdleSleep);
+	#endif
+	RUN_TEST(test_DeviceDescriptor);
+
+	return 0;
+}
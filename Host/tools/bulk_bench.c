@@ -0,0 +1,397 @@
+// Bulk throughput and latency benchmark of the BulkVendor echo, replacing the
+// one-packet-per-second BulkVendor/test/test_builk_vendor.py. Keeps several
+// transfers in flight on both endpoints like a real streaming host:
+//	throughput: moves the given number of bytes per transfer size, reports the
+//		sustained OUT rate, the IN rate from the first echoed byte on and the
+//		round-trip echo rate
+//	latency: one round trip at a time per transfer size, reports the
+//		min/p50/p99/p999/max time from submitting the OUT transfer to the
+//		completion of its echo, and with -H the log2 histogram
+// Every echoed byte is verified, the exit status is non-zero on a mismatch,
+// an error or a timeout.
+//	bulk_bench [-m throughput|latency] [-q depth] [-b bytes] [-n count] [-s size,...] [-H]
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bulk_bench.h"
+
+// Macros:
+#define BENCH_MAX_SIZES			16
+#define BENCH_MAX_SAMPLES		100000
+#define BENCH_HISTOGRAM_BUCKETS	32
+
+#define BENCH_MODE_THROUGHPUT	(1 << 0)
+#define BENCH_MODE_LATENCY		(1 << 1)
+
+// IN transfers are whole packets: the echo is a byte stream, and a firmware
+// that buffers it may merge the bytes of several OUT transfers into one
+// packet, which would overflow a shorter transfer.
+#define BENCH_IN_LENGTH(Length)	((((Length) + BENCH_EPSIZE - 1) / BENCH_EPSIZE) * BENCH_EPSIZE)
+
+// Type Defines:
+// State of one throughput or latency run over the echoed byte stream.
+typedef struct
+{
+	uint32_t Size; // Transfer size
+	uint32_t Total; // Bytes to echo
+	uint32_t OutSubmitted;
+	uint32_t OutCompleted;
+	uint32_t InRequested;
+	uint32_t InCompleted;
+	uint64_t StartNS;
+	uint64_t OutDoneNS;
+	uint64_t FirstInNS;
+	uint64_t InDoneNS;
+	uint32_t Mismatches;
+	uint32_t Errors;
+} Bench_Stream_t;
+
+// Global Variables:
+static Bench_Stream_t Stream;
+static Bench_Transfer_t OutTransfers[BENCH_MAX_DEPTH];
+static Bench_Transfer_t InTransfers[BENCH_MAX_DEPTH];
+static uint64_t Samples[BENCH_MAX_SAMPLES];
+static bool Failed;
+
+uint64_t Bench_NowNS(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return ((uint64_t)Now.tv_sec * 1000000000ULL) + Now.tv_nsec;
+}
+
+// Byte at Offset of the echoed stream, not periodic in the packet size.
+static uint8_t Bench_Pattern(const uint32_t Offset)
+{
+	return (uint8_t)((Offset * 7) + (Offset >> 8));
+}
+
+static void Bench_StartStream(const uint32_t Size, const uint32_t Total)
+{
+	memset(&Stream, 0, sizeof(Stream));
+	Stream.Size = Size;
+	Stream.Total = Total;
+	Stream.StartNS = Bench_NowNS();
+}
+
+// Fills the next OUT transfer of the stream, false once everything is sent.
+static bool Bench_NextOUT(Bench_Transfer_t* const Transfer)
+{
+	uint32_t Length = (Stream.Total - Stream.OutSubmitted);
+
+	if (!(Length))
+		return false;
+	if (Length > Stream.Size)
+		Length = Stream.Size;
+
+	for (uint32_t i = 0; i < Length; i++)
+		Transfer->Buffer[i] = Bench_Pattern(Stream.OutSubmitted + i);
+
+	Transfer->Length = Length;
+	Stream.OutSubmitted += Length;
+	return true;
+}
+
+// Requests the next IN transfer of the stream, false once the outstanding
+// transfers cover everything still to be echoed.
+static bool Bench_NextIN(Bench_Transfer_t* const Transfer)
+{
+	if (Stream.InRequested >= Stream.Total)
+		return false;
+
+	uint32_t Length = (Stream.Total - Stream.InRequested);
+
+	if (Length > Stream.Size)
+		Length = Stream.Size;
+	Length = BENCH_IN_LENGTH(Length);
+
+	Transfer->Length = Length;
+	Stream.InRequested += Length;
+	return true;
+}
+
+static void Bench_Submit(Bench_Transfer_t* const Transfer)
+{
+	Transfer->Status = BENCH_TRANSFER_Pending;
+	Transfer->ActualLength = 0;
+	Transfer->SubmitTimeNS = Bench_NowNS();
+
+	if (!(Bench_Transport.Submit(Transfer)))
+	{
+		Transfer->Status = BENCH_TRANSFER_Error;
+		Stream.Errors++;
+	}
+}
+
+static void Bench_OUTComplete(Bench_Transfer_t* const Transfer)
+{
+	if (Transfer->Status != BENCH_TRANSFER_Completed)
+	{
+		Stream.Errors++;
+		return;
+	}
+
+	Stream.OutCompleted += Transfer->ActualLength;
+	if (Stream.OutCompleted == Stream.Total)
+		Stream.OutDoneNS = Bench_NowNS();
+
+	if (Bench_NextOUT(Transfer))
+		Bench_Submit(Transfer);
+}
+
+static void Bench_INComplete(Bench_Transfer_t* const Transfer)
+{
+	uint64_t Now = Bench_NowNS();
+
+	if (Transfer->Status != BENCH_TRANSFER_Completed)
+	{
+		Stream.Errors++;
+		return;
+	}
+
+	for (uint32_t i = 0; i < Transfer->ActualLength; i++)
+	{
+		if (Transfer->Buffer[i] != Bench_Pattern(Stream.InCompleted + i))
+			Stream.Mismatches++;
+	}
+
+	// A short packet ended the transfer early, the rest is requested again.
+	Stream.InRequested -= (Transfer->Length - Transfer->ActualLength);
+
+	if (!(Stream.InCompleted) && Transfer->ActualLength)
+		Stream.FirstInNS = Now;
+	Stream.InCompleted += Transfer->ActualLength;
+	if (Stream.InCompleted >= Stream.Total)
+		Stream.InDoneNS = Now;
+
+	if (Bench_NextIN(Transfer))
+		Bench_Submit(Transfer);
+}
+
+// Runs the transport until the stream is echoed, false on an error.
+static bool Bench_WaitStream(void)
+{
+	while ((Stream.InCompleted < Stream.Total) && !(Stream.Errors) && !(Stream.Mismatches))
+	{
+		if (!(Bench_Transport.HandleEvents()))
+			Stream.Errors++;
+	}
+
+	if (Stream.Errors || Stream.Mismatches || (Stream.InCompleted != Stream.Total))
+	{
+		fprintf(stderr, "bulk_bench: %u byte transfers: %u of %u bytes echoed, %u mismatches, %u errors\n",
+				Stream.Size, Stream.InCompleted, Stream.Total, Stream.Mismatches, Stream.Errors);
+		Failed = true;
+		return false;
+	}
+
+	return true;
+}
+
+static void Bench_AllocTransfers(const uint32_t Depth, const uint32_t Size)
+{
+	for (uint32_t i = 0; i < Depth; i++)
+	{
+		OutTransfers[i] = (Bench_Transfer_t){.Endpoint = BENCH_OUT_EPADDR, .Callback = Bench_OUTComplete};
+		InTransfers[i] = (Bench_Transfer_t){.Endpoint = BENCH_IN_EPADDR, .Callback = Bench_INComplete};
+		OutTransfers[i].Buffer = malloc(Size);
+		InTransfers[i].Buffer = malloc(BENCH_IN_LENGTH(Size));
+	}
+}
+
+static void Bench_FreeTransfers(const uint32_t Depth)
+{
+	for (uint32_t i = 0; i < Depth; i++)
+	{
+		Bench_Transport.Release(&OutTransfers[i]);
+		Bench_Transport.Release(&InTransfers[i]);
+		free(OutTransfers[i].Buffer);
+		free(InTransfers[i].Buffer);
+	}
+}
+
+static double Bench_Rate(const uint32_t Bytes, const uint64_t StartNS, const uint64_t EndNS)
+{
+	return (EndNS > StartNS) ? ((double)Bytes * 1000.0 / (EndNS - StartNS)) : 0.0;
+}
+
+static void Bench_Throughput(const uint32_t Size, const uint32_t Bytes, const uint32_t Depth)
+{
+	Bench_AllocTransfers(Depth, Size);
+	Bench_StartStream(Size, Bytes);
+
+	// The IN transfers go first, the host reads while it writes.
+	for (uint32_t i = 0; i < Depth; i++)
+	{
+		if (Bench_NextIN(&InTransfers[i]))
+			Bench_Submit(&InTransfers[i]);
+	}
+	for (uint32_t i = 0; i < Depth; i++)
+	{
+		if (Bench_NextOUT(&OutTransfers[i]))
+			Bench_Submit(&OutTransfers[i]);
+	}
+
+	if (Bench_WaitStream())
+	{
+		printf("%8u %10.3f %10.3f %10.3f\n", Size,
+			   Bench_Rate(Stream.Total, Stream.StartNS, Stream.OutDoneNS),
+			   Bench_Rate(Stream.Total, Stream.FirstInNS, Stream.InDoneNS),
+			   Bench_Rate(Stream.Total, Stream.StartNS, Stream.InDoneNS));
+	}
+
+	Bench_FreeTransfers(Depth);
+}
+
+static int Bench_CompareSamples(const void* const A, const void* const B)
+{
+	uint64_t SampleA = *(const uint64_t*)A;
+	uint64_t SampleB = *(const uint64_t*)B;
+
+	return (SampleA > SampleB) - (SampleA < SampleB);
+}
+
+static double Bench_Percentile(const uint32_t Count, const double Percent)
+{
+	uint32_t Index = (uint32_t)(((Count - 1) * Percent / 100.0) + 0.5);
+
+	return Samples[Index] / 1000.0;
+}
+
+static void Bench_Latency(const uint32_t Size, const uint32_t Count, const bool Histogram)
+{
+	uint32_t Buckets[BENCH_HISTOGRAM_BUCKETS] = {0};
+	uint32_t SamplesTaken = 0;
+
+	Bench_AllocTransfers(1, Size);
+
+	for (uint32_t i = 0; i < Count; i++)
+	{
+		Bench_StartStream(Size, Size);
+
+		Bench_NextIN(&InTransfers[0]);
+		Bench_Submit(&InTransfers[0]);
+		Bench_NextOUT(&OutTransfers[0]);
+		Bench_Submit(&OutTransfers[0]);
+
+		if (!(Bench_WaitStream()))
+			break;
+
+		uint64_t Sample = (Stream.InDoneNS - OutTransfers[0].SubmitTimeNS);
+		Samples[SamplesTaken++] = Sample;
+
+		uint8_t Bucket = 0;
+		while ((Bucket < (BENCH_HISTOGRAM_BUCKETS - 1)) && ((Sample / 1000) >> (Bucket + 1)))
+			Bucket++;
+		Buckets[Bucket]++;
+	}
+
+	Bench_FreeTransfers(1);
+
+	if (!(SamplesTaken))
+		return;
+
+	qsort(Samples, SamplesTaken, sizeof(Samples[0]), Bench_CompareSamples);
+	printf("%8u %10.1f %10.1f %10.1f %10.1f %10.1f\n", Size, Samples[0] / 1000.0,
+		   Bench_Percentile(SamplesTaken, 50), Bench_Percentile(SamplesTaken, 99),
+		   Bench_Percentile(SamplesTaken, 99.9), Samples[SamplesTaken - 1] / 1000.0);
+
+	if (Histogram)
+	{
+		for (uint8_t Bucket = 0; Bucket < BENCH_HISTOGRAM_BUCKETS; Bucket++)
+		{
+			if (Buckets[Bucket])
+				printf("%19s%8lu-%-8lu us: %u\n", "", (Bucket ? (1UL << Bucket) : 0UL), (1UL << (Bucket + 1)) - 1,
+					   Buckets[Bucket]);
+		}
+	}
+}
+
+static void Bench_Usage(const char* const Program)
+{
+	fprintf(stderr, "usage: %s [-m throughput|latency] [-q depth] [-b bytes] [-n count] [-s size,...] [-H]\n", Program);
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t Sizes[BENCH_MAX_SIZES] = {1, 16, 63, 64, 65, 512, 1024, 4096};
+	uint8_t SizeCount = 8;
+	uint8_t Modes = (BENCH_MODE_THROUGHPUT | BENCH_MODE_LATENCY);
+	uint32_t Depth = 8;
+	uint32_t Bytes = (1UL << 20);
+	uint32_t Count = 1000;
+	bool Histogram = false;
+	int Option;
+
+	while ((Option = getopt(argc, argv, "m:q:b:n:s:H")) != -1)
+	{
+		switch (Option)
+		{
+			case 'm':
+				if (!(strcmp(optarg, "throughput")))
+					Modes = BENCH_MODE_THROUGHPUT;
+				else if (!(strcmp(optarg, "latency")))
+					Modes = BENCH_MODE_LATENCY;
+				else
+					Bench_Usage(argv[0]);
+				break;
+			case 'q':
+				Depth = strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+				Bytes = strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				Count = strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				SizeCount = 0;
+				for (char* Size = strtok(optarg, ","); Size && (SizeCount < BENCH_MAX_SIZES); Size = strtok(NULL, ","))
+					Sizes[SizeCount++] = strtoul(Size, NULL, 0);
+				break;
+			case 'H':
+				Histogram = true;
+				break;
+			default:
+				Bench_Usage(argv[0]);
+		}
+	}
+
+	if (!(Depth) || (Depth > BENCH_MAX_DEPTH) || !(Bytes) || !(Count) || (Count > BENCH_MAX_SAMPLES) || !(SizeCount))
+		Bench_Usage(argv[0]);
+
+	for (uint8_t i = 0; i < SizeCount; i++)
+	{
+		if (!(Sizes[i]))
+			Bench_Usage(argv[0]);
+	}
+
+	if (!(Bench_Transport.Open()))
+		return EXIT_FAILURE;
+
+	if (Modes & BENCH_MODE_THROUGHPUT)
+	{
+		printf("%s: throughput, %u bytes per size, %u transfers in flight, MB/s\n", Bench_Transport.Name, Bytes, Depth);
+		printf("%8s %10s %10s %10s\n", "size", "out", "in", "echo");
+		for (uint8_t i = 0; (i < SizeCount) && !(Failed); i++)
+			Bench_Throughput(Sizes[i], Bytes, Depth);
+	}
+
+	if (Modes & BENCH_MODE_LATENCY)
+	{
+		printf("%s: round-trip latency, %u round trips per size, us\n", Bench_Transport.Name, Count);
+		printf("%8s %10s %10s %10s %10s %10s\n", "size", "min", "p50", "p99", "p999", "max");
+		for (uint8_t i = 0; (i < SizeCount) && !(Failed); i++)
+			Bench_Latency(Sizes[i], Count, Histogram);
+	}
+
+	Bench_Transport.Close();
+
+	return (Failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,66 @@
+// Transport interface of the bulk benchmark (bulk_bench.c). It follows the
+// libusb asynchronous API: transfers are submitted, complete later from
+// HandleEvents and call their callback, which may submit them again. One
+// transport is linked into each benchmark executable:
+//	bulk_bench_libusb.c: the BulkVendor board through libusb-1.0
+//	bulk_bench_mock.c: the BulkVendor firmware on the mock endpoint layer
+#ifndef BULK_BENCH_H
+#define BULK_BENCH_H
+
+// Includes:
+#include <stdint.h>
+#include <stdbool.h>
+
+// Macros:
+// Bulk Vendor device, see BulkVendor/Descriptors.c.
+#define BENCH_VENDOR_ID			0x03EB
+#define BENCH_PRODUCT_ID		0x206C
+#define BENCH_INTERFACE			0
+#define BENCH_IN_EPADDR			0x83
+#define BENCH_OUT_EPADDR		0x04
+#define BENCH_EPSIZE			64
+
+// Largest number of transfers in flight per direction.
+#define BENCH_MAX_DEPTH			64
+
+// Timeout of every transfer.
+#define BENCH_TIMEOUT_MS		1000
+
+// Type Defines:
+enum Bench_TransferStatus_t
+{
+	BENCH_TRANSFER_Completed = 0,
+	BENCH_TRANSFER_Pending = 1,
+	BENCH_TRANSFER_TimedOut = 2,
+	BENCH_TRANSFER_Error = 3,
+};
+
+typedef struct Bench_Transfer
+{
+	uint8_t Endpoint; // Endpoint address including the direction bit
+	uint8_t* Buffer;
+	uint32_t Length; // Requested length, an IN transfer also ends on a short packet
+	uint32_t ActualLength;
+	uint8_t Status; // Bench_TransferStatus_t
+	uint64_t SubmitTimeNS;
+	void (*Callback)(struct Bench_Transfer* const Transfer);
+	void* Backend; // Owned by the transport
+} Bench_Transfer_t;
+
+typedef struct
+{
+	const char* Name;
+	bool (*Open)(void);
+	void (*Close)(void);
+	bool (*Submit)(Bench_Transfer_t* const Transfer);
+	void (*Release)(Bench_Transfer_t* const Transfer); // Frees the backend state of an idle transfer
+	bool (*HandleEvents)(void); // Completes finished transfers, false on a fatal error
+} Bench_Transport_t;
+
+// Global Variables:
+extern const Bench_Transport_t Bench_Transport;
+
+// Function Prototypes:
+uint64_t Bench_NowNS(void);
+
+#endif
@@ -0,0 +1,102 @@
+// libusb-1.0 transport of the bulk benchmark, for the BulkVendor board.
+#include <stdio.h>
+#include <stdlib.h>
+#include <libusb.h>
+
+#include "bulk_bench.h"
+
+// Global Variables:
+static libusb_context* Context;
+static libusb_device_handle* Handle;
+
+static void LIBUSB_CALL LibusbBench_Callback(struct libusb_transfer* const Backend)
+{
+	Bench_Transfer_t* Transfer = (Bench_Transfer_t*)Backend->user_data;
+
+	Transfer->ActualLength = Backend->actual_length;
+	switch (Backend->status)
+	{
+		case LIBUSB_TRANSFER_COMPLETED:
+			Transfer->Status = BENCH_TRANSFER_Completed;
+			break;
+		case LIBUSB_TRANSFER_TIMED_OUT:
+			Transfer->Status = BENCH_TRANSFER_TimedOut;
+			break;
+		default:
+			Transfer->Status = BENCH_TRANSFER_Error;
+			break;
+	}
+
+	Transfer->Callback(Transfer);
+}
+
+static bool LibusbBench_Open(void)
+{
+	int Error;
+
+	if ((Error = libusb_init(&Context)))
+	{
+		fprintf(stderr, "bulk_bench: libusb_init: %s\n", libusb_error_name(Error));
+		return false;
+	}
+
+	if (!(Handle = libusb_open_device_with_vid_pid(Context, BENCH_VENDOR_ID, BENCH_PRODUCT_ID)))
+	{
+		fprintf(stderr, "bulk_bench: no Bulk Vendor device %04X:%04X found\n", BENCH_VENDOR_ID, BENCH_PRODUCT_ID);
+		libusb_exit(Context);
+		return false;
+	}
+
+	if ((Error = libusb_claim_interface(Handle, BENCH_INTERFACE)))
+	{
+		fprintf(stderr, "bulk_bench: libusb_claim_interface: %s\n", libusb_error_name(Error));
+		libusb_close(Handle);
+		libusb_exit(Context);
+		return false;
+	}
+
+	return true;
+}
+
+static void LibusbBench_Close(void)
+{
+	libusb_release_interface(Handle, BENCH_INTERFACE);
+	libusb_close(Handle);
+	libusb_exit(Context);
+}
+
+static bool LibusbBench_Submit(Bench_Transfer_t* const Transfer)
+{
+	struct libusb_transfer* Backend = (struct libusb_transfer*)Transfer->Backend;
+
+	if (!(Backend) && !(Backend = libusb_alloc_transfer(0)))
+		return false;
+
+	Transfer->Backend = Backend;
+	libusb_fill_bulk_transfer(Backend, Handle, Transfer->Endpoint, Transfer->Buffer, Transfer->Length,
+							  LibusbBench_Callback, Transfer, BENCH_TIMEOUT_MS);
+	return (libusb_submit_transfer(Backend) == LIBUSB_SUCCESS);
+}
+
+static void LibusbBench_Release(Bench_Transfer_t* const Transfer)
+{
+	libusb_free_transfer((struct libusb_transfer*)Transfer->Backend);
+	Transfer->Backend = NULL;
+}
+
+static bool LibusbBench_HandleEvents(void)
+{
+	struct timeval Timeout = {.tv_sec = 1, .tv_usec = 0};
+
+	return (libusb_handle_events_timeout_completed(Context, &Timeout, NULL) == LIBUSB_SUCCESS);
+}
+
+const Bench_Transport_t Bench_Transport =
+{
+	.Name = "libusb",
+	.Open = LibusbBench_Open,
+	.Close = LibusbBench_Close,
+	.Submit = LibusbBench_Submit,
+	.Release = LibusbBench_Release,
+	.HandleEvents = LibusbBench_HandleEvents,
+};
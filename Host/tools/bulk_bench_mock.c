@@ -0,0 +1,168 @@
+// Loopback transport of the bulk benchmark: the BulkVendor firmware on the
+// mock endpoint layer plays the device, and transfers are split into packets
+// the way the host controller does it. Runs without a board, so the
+// benchmark also runs as a test. The times are host CPU time of the
+// simulation: good for checking the benchmark and comparing firmware variants,
+// not for predicting the board.
+#include "MockUSB.h"
+#include "BulkVendor.h"
+#include "bulk_bench.h"
+
+// Macros:
+#define MOCK_BENCH_QUEUE_SIZE	(BENCH_MAX_DEPTH * 2)
+
+// Firmware main loop passes per frame.
+#define MOCK_BENCH_PASSES		256
+
+// Type Defines:
+typedef struct
+{
+	Bench_Transfer_t* Transfers[MOCK_BENCH_QUEUE_SIZE];
+	uint8_t Head;
+	uint8_t Count;
+	uint32_t Offset; // Bytes of the head transfer already moved
+} MockBench_Queue_t;
+
+// Global Variables:
+static MockBench_Queue_t OUTQueue;
+static MockBench_Queue_t INQueue;
+static MockBench_Queue_t DoneQueue;
+static uint16_t IdleFrames;
+static bool Moved;
+
+int Firmware_Main(void);
+
+static bool MockBench_Push(MockBench_Queue_t* const Queue, Bench_Transfer_t* const Transfer)
+{
+	if (Queue->Count == MOCK_BENCH_QUEUE_SIZE)
+		return false;
+
+	Queue->Transfers[(Queue->Head + Queue->Count++) % MOCK_BENCH_QUEUE_SIZE] = Transfer;
+	return true;
+}
+
+static Bench_Transfer_t* MockBench_Pop(MockBench_Queue_t* const Queue)
+{
+	Bench_Transfer_t* Transfer = Queue->Transfers[Queue->Head];
+
+	Queue->Head = (Queue->Head + 1) % MOCK_BENCH_QUEUE_SIZE;
+	Queue->Count--;
+	Queue->Offset = 0;
+	return Transfer;
+}
+
+static void MockBench_Complete(MockBench_Queue_t* const Queue, const uint8_t Status)
+{
+	Bench_Transfer_t* Transfer = MockBench_Pop(Queue);
+
+	Transfer->Status = Status;
+	MockBench_Push(&DoneQueue, Transfer);
+}
+
+// Host controller side, also the host hook of the mock: sends the pending
+// OUT transfers as banks become free and fills the pending IN transfers.
+static void MockBench_Service(void)
+{
+	uint8_t Packet[BENCH_EPSIZE];
+	int16_t Length;
+
+	while (OUTQueue.Count && (Mock_PendingPackets(BENCH_OUT_EPADDR) < VENDOR_EP_BANKS))
+	{
+		Bench_Transfer_t* Transfer = OUTQueue.Transfers[OUTQueue.Head];
+		uint32_t PacketLength = MIN(BENCH_EPSIZE, Transfer->Length - OUTQueue.Offset);
+
+		if (!(Mock_HostSendPacket(BENCH_OUT_EPADDR, &Transfer->Buffer[OUTQueue.Offset], PacketLength)))
+			break;
+
+		Moved = true;
+		OUTQueue.Offset += PacketLength;
+		Transfer->ActualLength = OUTQueue.Offset;
+		if (OUTQueue.Offset == Transfer->Length)
+			MockBench_Complete(&OUTQueue, BENCH_TRANSFER_Completed);
+	}
+
+	while (INQueue.Count && ((Length = Mock_HostReadPacket(BENCH_IN_EPADDR, Packet, sizeof(Packet))) >= 0))
+	{
+		Bench_Transfer_t* Transfer = INQueue.Transfers[INQueue.Head];
+
+		Moved = true;
+		if ((INQueue.Offset + Length) > Transfer->Length)
+		{
+			// Babble, the packet does not fit the rest of the transfer.
+			MockBench_Complete(&INQueue, BENCH_TRANSFER_Error);
+			continue;
+		}
+
+		memcpy(&Transfer->Buffer[INQueue.Offset], Packet, Length);
+		INQueue.Offset += Length;
+		Transfer->ActualLength = INQueue.Offset;
+		if ((Length < BENCH_EPSIZE) || (INQueue.Offset == Transfer->Length))
+			MockBench_Complete(&INQueue, BENCH_TRANSFER_Completed);
+	}
+}
+
+static bool MockBench_Open(void)
+{
+	Mock_Reset();
+	Mock_RunFirmware(Firmware_Main, 1);
+	Mock_Configure();
+	Mock_SetHostHook(MockBench_Service);
+	return true;
+}
+
+static void MockBench_Close(void)
+{
+	Mock_SetHostHook(NULL);
+	Mock_Disconnect();
+}
+
+static bool MockBench_Submit(Bench_Transfer_t* const Transfer)
+{
+	if (!(Transfer->Length))
+		return false;
+
+	return MockBench_Push((Transfer->Endpoint & ENDPOINT_DIR_IN) ? &INQueue : &OUTQueue, Transfer);
+}
+
+static void MockBench_Release(Bench_Transfer_t* const Transfer)
+{
+}
+
+// One frame of the firmware, then the completion callbacks. The pending
+// transfers time out after BENCH_TIMEOUT_MS frames without any packet.
+static bool MockBench_HandleEvents(void)
+{
+	Moved = false;
+	MockBench_Service();
+	Mock_StartOfFrame();
+	Mock_RunFirmware(Firmware_Main, MOCK_BENCH_PASSES);
+	MockBench_Service();
+
+	IdleFrames = (Moved ? 0 : (IdleFrames + 1));
+	if (IdleFrames >= BENCH_TIMEOUT_MS)
+	{
+		while (OUTQueue.Count)
+			MockBench_Complete(&OUTQueue, BENCH_TRANSFER_TimedOut);
+		while (INQueue.Count)
+			MockBench_Complete(&INQueue, BENCH_TRANSFER_TimedOut);
+		IdleFrames = 0;
+	}
+
+	while (DoneQueue.Count)
+	{
+		Bench_Transfer_t* Transfer = MockBench_Pop(&DoneQueue);
+		Transfer->Callback(Transfer);
+	}
+
+	return true;
+}
+
+const Bench_Transport_t Bench_Transport =
+{
+	.Name = "mock loopback",
+	.Open = MockBench_Open,
+	.Close = MockBench_Close,
+	.Submit = MockBench_Submit,
+	.Release = MockBench_Release,
+	.HandleEvents = MockBench_HandleEvents,
+};
@@ -0,0 +1,80 @@
+#!/usr/bin/env python
+
+import struct
+import sys
+import usb.core
+
+# Reads the Timer1 cycle probes of a CYCLE_PROBES build (Common/CycleProbe.h)
+# and prints count, min, mean and max cycles and the histogram of each probe
+# that ran.
+#
+#	python cycle_probes.py [bulk|serial|hid] [reset]
+#
+# With reset the probes are cleared after they are read.
+
+devices = {
+	"bulk": (0x03EB, 0x206C),
+	"serial": (0x03EB, 0x2044),
+	"hid": (0x03EB, 0x204F),
+}
+
+CYCLE_REQ_GetProbe = 0x06
+CYCLE_REQ_ResetProbes = 0x07
+
+# bmRequestType: vendor request to the device
+REQTYPE_VENDOR_IN = 0xC0
+REQTYPE_VENDOR_OUT = 0x40
+
+F_CPU = 16000000
+
+# CycleProbe_Probes_t
+probe_names = ["Device_SendByte", "Device_ReceiveByte", "Device_Write_Block", "Device_Read_Block",
+	"MainTask", "CreateHIDReport", "ResumeToFirstPacket", "IdleSleep", "IdleWakeup"]
+
+# CycleProbe_Stats_t, packed little endian
+CYCLE_PROBE_BUCKETS = 8
+stats_format = "<IQHH%dH" % CYCLE_PROBE_BUCKETS
+
+def read_probe(device, probe):
+	data = device.ctrl_transfer(REQTYPE_VENDOR_IN, CYCLE_REQ_GetProbe, 0, probe,
+		struct.calcsize(stats_format))
+	values = struct.unpack(stats_format, bytes(bytearray(data)))
+	return values[0], values[1], values[2], values[3], values[4:]
+
+def bucket_label(bucket):
+	if bucket == CYCLE_PROBE_BUCKETS - 1:
+		return ">=%d" % (16 << (bucket - 1))
+	return "<%d" % (16 << bucket)
+
+def main():
+	name = sys.argv[1] if len(sys.argv) > 1 else "bulk"
+	reset = (len(sys.argv) > 2) and (sys.argv[2] == "reset")
+
+	if name not in devices:
+		sys.exit("Unknown device %s, one of %s." % (name, ", ".join(sorted(devices))))
+
+	device = usb.core.find(idVendor=devices[name][0], idProduct=devices[name][1])
+	if device is None:
+		sys.exit("Could not find USB device.")
+
+	try:
+		read_probe(device, 0)
+	except usb.core.USBError:
+		sys.exit("The firmware was not built with CYCLE_PROBES.")
+
+	for probe in range(len(probe_names)):
+		count, total, minimum, maximum, buckets = read_probe(device, probe)
+		if count == 0:
+			continue
+
+		mean = float(total) / count
+		print("%-20s %10d calls  min %5d  mean %8.1f  max %5d cycles  (mean %.2f us)" %
+			(probe_names[probe], count, minimum, mean, maximum, mean * 1e6 / F_CPU))
+		print("%-20s " % "" + "  ".join("%s:%d" % (bucket_label(b), buckets[b])
+			for b in range(CYCLE_PROBE_BUCKETS) if buckets[b]))
+
+	if reset:
+		device.ctrl_transfer(REQTYPE_VENDOR_OUT, CYCLE_REQ_ResetProbes, 0, 0)
+
+if __name__ == "__main__":
+	main()
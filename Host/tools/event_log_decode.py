@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+
+import os
+import re
+import struct
+import sys
+import time
+
+# Decodes the binary event log a debug firmware sends on USART1
+# (Common/EventLog.h) into one line of text per record. Records read from a
+# serial port are prefixed with the host time in seconds since the first one.
+#
+#	python event_log_decode.py /dev/ttyUSB0 [baud]
+#	python event_log_decode.py capture.bin
+#
+# A serial port is read with pyserial, anything else is read as a file of raw
+# UART bytes. The event names and formats come from Common/EventLogEvents.h,
+# so the decoder must match the sources the firmware was built from.
+
+EVENTS_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "Common", "EventLogEvents.h")
+
+EVENT_LOG_BAUD = 250000
+EVENT_LOG_SYNC = 0xA5
+
+# Record after the sync byte: event ID, two little endian 16-bit arguments
+record_format = "<BHH"
+RECORD_SIZE = 1 + struct.calcsize(record_format)
+
+def read_events(path):
+	events = []
+	with open(path) as f:
+		for line in f:
+			match = re.match(r'\s*EVENT_LOG_EVENT\((\w+),\s*"(.*)"\)', line)
+			if match:
+				events.append((match.group(1), match.group(2)))
+	return events
+
+def format_record(events, event, arg0, arg1):
+	if event >= len(events):
+		return "unknown event %d (%#06x, %#06x)" % (event, arg0, arg1)
+	name, text = events[event]
+	return "%-20s %s" % (name, text.format(arg0, arg1))
+
+def open_port(name, baud):
+	import serial
+	port = serial.Serial(name, baud, timeout=0.1)
+	port.reset_input_buffer()
+	return port
+
+def main():
+	if len(sys.argv) < 2:
+		sys.exit("Usage: %s port|file [baud]" % sys.argv[0])
+
+	baud = int(sys.argv[2]) if len(sys.argv) > 2 else EVENT_LOG_BAUD
+	events = read_events(EVENTS_FILE)
+	is_file = os.path.isfile(sys.argv[1])
+	source = open(sys.argv[1], "rb") if is_file else open_port(sys.argv[1], baud)
+
+	data = bytearray()
+	start = None
+	while True:
+		chunk = source.read(256)
+		if not chunk:
+			if is_file:
+				break
+			continue
+		data += chunk
+
+		# Resynchronize on the sync byte, a record is only taken once it is
+		# complete and the byte after it is a sync byte or not yet received.
+		while len(data) >= RECORD_SIZE:
+			if data[0] != EVENT_LOG_SYNC:
+				del data[0]
+				continue
+			if (len(data) > RECORD_SIZE) and (data[RECORD_SIZE] != EVENT_LOG_SYNC):
+				del data[0]
+				continue
+
+			event, arg0, arg1 = struct.unpack(record_format, bytes(data[1:RECORD_SIZE]))
+			del data[:RECORD_SIZE]
+
+			line = format_record(events, event, arg0, arg1)
+			if not is_file:
+				now = time.time()
+				if start is None:
+					start = now
+				line = "%10.4f  %s" % (now - start, line)
+			print(line)
+			sys.stdout.flush()
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,84 @@
+#!/usr/bin/env python
+
+import struct
+import sys
+import time
+import usb.core
+
+# Samples the performance counters of a firmware (Common/PerfCounters.h) with
+# the vendor control request and prints the rate of each counter, plus the
+# main loop passes per USB frame.
+#
+#	python perf_counters.py [bulk|serial|hid] [interval seconds] [count]
+#
+# The interval must stay below 2 seconds, the 11-bit frame number wraps after
+# 2048 frames.
+
+devices = {
+	"bulk": (0x03EB, 0x206C),
+	"serial": (0x03EB, 0x2044),
+	"hid": (0x03EB, 0x204F),
+}
+
+PERF_REQ_GetCounters = 0x03
+PERF_REQ_ResetCounters = 0x04
+
+# bmRequestType: vendor request to the device
+REQTYPE_VENDOR_IN = 0xC0
+REQTYPE_VENDOR_OUT = 0x40
+
+# PerfCounters_t, packed little endian: the counters before and after the
+# frame number
+counter_names = ["MainLoopPasses", "OUTPackets", "OUTBytes", "INPackets", "INBytes",
+	"EndpointWaits", "WaitTimeouts", "DisconnectedErrors", "Suspends", "SuspendedSleeps",
+	"IdleSleeps"]
+counter_format = "<8IH3I"
+
+def read_counters(device):
+	data = device.ctrl_transfer(REQTYPE_VENDOR_IN, PERF_REQ_GetCounters, 0, 0,
+		struct.calcsize(counter_format))
+	values = struct.unpack(counter_format, bytes(bytearray(data)))
+	return dict(zip(counter_names, values[:8] + values[9:])), values[8]
+
+def delta32(new, old):
+	return (new - old) & 0xFFFFFFFF
+
+def main():
+	name = sys.argv[1] if len(sys.argv) > 1 else "bulk"
+	interval = float(sys.argv[2]) if len(sys.argv) > 2 else 1.0
+	count = int(sys.argv[3]) if len(sys.argv) > 3 else 0
+
+	if name not in devices:
+		sys.exit("Unknown device %s, one of %s." % (name, ", ".join(sorted(devices))))
+
+	device = usb.core.find(idVendor=devices[name][0], idProduct=devices[name][1])
+	if device is None:
+		sys.exit("Could not find USB device.")
+
+	device.ctrl_transfer(REQTYPE_VENDOR_OUT, PERF_REQ_ResetCounters, 0, 0)
+	counters, frame = read_counters(device)
+	when = time.time()
+
+	print("%-10s" % "frames" + "".join("%20s" % n for n in counter_names) + "%14s" % "passes/SOF")
+
+	sample = 0
+	while (count == 0) or (sample < count):
+		time.sleep(interval)
+
+		new_counters, new_frame = read_counters(device)
+		new_when = time.time()
+
+		frames = (new_frame - frame) & 0x7FF
+		seconds = new_when - when
+		line = "%-10d" % frames
+		for n in counter_names:
+			line += "%18.0f/s" % (delta32(new_counters[n], counters[n]) / seconds)
+		if frames:
+			line += "%14.1f" % (float(delta32(new_counters["MainLoopPasses"], counters["MainLoopPasses"])) / frames)
+		print(line)
+
+		counters, frame, when = new_counters, new_frame, new_when
+		sample += 1
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,174 @@
+// Simulator shim for the LUFA USB controller and endpoint driver, used in place
+// of the host mock's Core/USBController.h when the firmware is built for simavr.
+// The endpoint primitives are inline single register accesses on the shim
+// registers like the UEDATX/UEINTX accesses of LUFA's Endpoint_AVR8.h, the rest
+// is implemented by ShimUSB.c.
+#ifndef SHIM_LUFA_USBCONTROLLER_H
+#define SHIM_LUFA_USBCONTROLLER_H
+
+// Includes:
+#include <avr/io.h>
+#include "ShimRegisters.h"
+
+// Macros:
+#define SHIM_REG(Address)	_SFR_MEM8(Address)
+
+// External Variables:
+extern volatile uint8_t USB_DeviceState;
+
+// Function Prototypes:
+void USB_Init(void);
+void USB_USBTask(void);
+void USB_Device_EnableSOFEvents(void);
+void USB_Device_DisableSOFEvents(void);
+uint16_t USB_Device_GetFrameNumber(void);
+void USB_Device_SendRemoteWakeup(void);
+
+bool Endpoint_ConfigureEndpoint(const uint8_t Address, const uint8_t Type, const uint16_t Size, const uint8_t Banks);
+bool Endpoint_ConfigureEndpointTable(const USB_Endpoint_Table_t* const Table, const uint8_t Entries);
+void Endpoint_ResetEndpoint(const uint8_t Address);
+uint8_t Endpoint_WaitUntilReady(void);
+uint8_t Endpoint_Write_Stream_LE(const void* const Buffer, uint16_t Length, uint16_t* const BytesProcessed);
+uint8_t Endpoint_Read_Stream_LE(void* const Buffer, uint16_t Length, uint16_t* const BytesProcessed);
+uint8_t Endpoint_Write_Control_Stream_LE(const void* const Buffer, uint16_t Length);
+uint8_t Endpoint_Write_Control_PStream_LE(const void* const Buffer, uint16_t Length);
+uint8_t Endpoint_Read_Control_Stream_LE(void* const Buffer, uint16_t Length);
+void Endpoint_ClearStatusStage(void);
+
+// Inline Functions:
+static inline void Endpoint_SelectEndpoint(const uint8_t Address) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_SelectEndpoint(const uint8_t Address)
+{
+	SHIM_REG(SHIM_UENUM) = (Address & ENDPOINT_EPNUM_MASK);
+}
+
+static inline uint8_t Endpoint_GetCurrentEndpoint(void) ATTR_ALWAYS_INLINE;
+static inline uint8_t Endpoint_GetCurrentEndpoint(void)
+{
+	return SHIM_REG(SHIM_UENUM);
+}
+
+static inline bool Endpoint_IsConfigured(void) ATTR_ALWAYS_INLINE;
+static inline bool Endpoint_IsConfigured(void)
+{
+	return ((SHIM_REG(SHIM_UESTA) & SHIM_STATUS_CONFIGURED) ? true : false);
+}
+
+static inline bool Endpoint_IsReadWriteAllowed(void) ATTR_ALWAYS_INLINE;
+static inline bool Endpoint_IsReadWriteAllowed(void)
+{
+	return ((SHIM_REG(SHIM_UESTA) & SHIM_STATUS_RW_ALLOWED) ? true : false);
+}
+
+static inline bool Endpoint_IsINReady(void) ATTR_ALWAYS_INLINE;
+static inline bool Endpoint_IsINReady(void)
+{
+	return ((SHIM_REG(SHIM_UESTA) & SHIM_STATUS_IN_READY) ? true : false);
+}
+
+static inline bool Endpoint_IsOUTReceived(void) ATTR_ALWAYS_INLINE;
+static inline bool Endpoint_IsOUTReceived(void)
+{
+	return ((SHIM_REG(SHIM_UESTA) & SHIM_STATUS_OUT_RECEIVED) ? true : false);
+}
+
+static inline bool Endpoint_IsSETUPReceived(void) ATTR_ALWAYS_INLINE;
+static inline bool Endpoint_IsSETUPReceived(void)
+{
+	return ((SHIM_REG(SHIM_UESTA) & SHIM_STATUS_SETUP_RECEIVED) ? true : false);
+}
+
+static inline bool Endpoint_IsStalled(void) ATTR_ALWAYS_INLINE;
+static inline bool Endpoint_IsStalled(void)
+{
+	return ((SHIM_REG(SHIM_UESTA) & SHIM_STATUS_STALLED) ? true : false);
+}
+
+static inline uint16_t Endpoint_BytesInEndpoint(void) ATTR_ALWAYS_INLINE;
+static inline uint16_t Endpoint_BytesInEndpoint(void)
+{
+	return SHIM_REG(SHIM_UEBCX);
+}
+
+static inline void Endpoint_ClearIN(void) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_ClearIN(void)
+{
+	SHIM_REG(SHIM_UECMD) = SHIM_CMD_CLEAR_IN;
+}
+
+static inline void Endpoint_ClearOUT(void) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_ClearOUT(void)
+{
+	SHIM_REG(SHIM_UECMD) = SHIM_CMD_CLEAR_OUT;
+}
+
+static inline void Endpoint_ClearSETUP(void) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_ClearSETUP(void)
+{
+	SHIM_REG(SHIM_UECMD) = SHIM_CMD_CLEAR_SETUP;
+}
+
+static inline void Endpoint_StallTransaction(void) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_StallTransaction(void)
+{
+	SHIM_REG(SHIM_UECMD) = SHIM_CMD_STALL;
+}
+
+static inline void Endpoint_ClearStall(void) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_ClearStall(void)
+{
+	SHIM_REG(SHIM_UECMD) = SHIM_CMD_CLEAR_STALL;
+}
+
+static inline uint8_t Endpoint_Read_8(void) ATTR_ALWAYS_INLINE;
+static inline uint8_t Endpoint_Read_8(void)
+{
+	return SHIM_REG(SHIM_UEDATX);
+}
+
+static inline void Endpoint_Write_8(const uint8_t Data) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_Write_8(const uint8_t Data)
+{
+	SHIM_REG(SHIM_UEDATX) = Data;
+}
+
+static inline void Endpoint_Discard_8(void) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_Discard_8(void)
+{
+	volatile uint8_t Dummy;
+
+	Dummy = SHIM_REG(SHIM_UEDATX);
+	(void)Dummy;
+}
+
+static inline uint16_t Endpoint_Read_16_LE(void) ATTR_ALWAYS_INLINE;
+static inline uint16_t Endpoint_Read_16_LE(void)
+{
+	uint16_t Data = SHIM_REG(SHIM_UEDATX);
+
+	return (Data | ((uint16_t)SHIM_REG(SHIM_UEDATX) << 8));
+}
+
+static inline void Endpoint_Write_16_LE(const uint16_t Data) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_Write_16_LE(const uint16_t Data)
+{
+	SHIM_REG(SHIM_UEDATX) = (Data & 0xFF);
+	SHIM_REG(SHIM_UEDATX) = (Data >> 8);
+}
+
+static inline uint32_t Endpoint_Read_32_LE(void) ATTR_ALWAYS_INLINE;
+static inline uint32_t Endpoint_Read_32_LE(void)
+{
+	uint32_t Data = Endpoint_Read_16_LE();
+
+	return (Data | ((uint32_t)Endpoint_Read_16_LE() << 16));
+}
+
+static inline void Endpoint_Write_32_LE(const uint32_t Data) ATTR_ALWAYS_INLINE;
+static inline void Endpoint_Write_32_LE(const uint32_t Data)
+{
+	Endpoint_Write_16_LE(Data & 0xFFFF);
+	Endpoint_Write_16_LE(Data >> 16);
+}
+
+#endif
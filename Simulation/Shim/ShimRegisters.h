@@ -0,0 +1,75 @@
+// Register interface between the firmware built for the simulator and the
+// simavr benchmark harness. simavr has no usable model of the ATmega32U4 USB
+// controller, so the endpoint access of the LUFA driver is replaced by a shim
+// on reserved extended I/O addresses, which the harness serves from the
+// endpoint FIFOs of the host mock (Host/Mock/MockUSB.c). Every endpoint access
+// is a single LDS/STS like the UEDATX/UEINTX accesses of the real driver, so
+// the measured cycles of the code around them stay representative.
+//
+// Shared by the AVR side (ShimUSB.c) and the harness (usb_bench.c), the
+// addresses are data space addresses.
+#ifndef SHIMREGISTERS_H
+#define SHIMREGISTERS_H
+
+// Macros:
+// Endpoint number select (W), current endpoint address with direction (R).
+#define SHIM_UENUM		0xF5
+
+// Endpoint data, reads the OUT or control data bank and writes the IN bank.
+#define SHIM_UEDATX		0xF6
+
+// Number of bytes in the selected endpoint bank.
+#define SHIM_UEBCX		0xF7
+
+// Status of the selected endpoint, SHIM_STATUS_* bits.
+#define SHIM_UESTA		0xF8
+
+// Endpoint command (W), SHIM_CMD_*. The result of the last command (R).
+#define SHIM_UECMD		0xF9
+
+// Argument bytes of the next command, in the order documented per command.
+#define SHIM_UEARG		0xFA
+
+// Pending device event (R, SHIM_EVENT_*), written back when it is handled.
+#define SHIM_EVENT		0xFB
+
+// Next byte of the pending SETUP packet.
+#define SHIM_SETUP		0xFC
+
+// Benchmark probe marker, a general purpose I/O register: writing a probe
+// number starts the probe and writing 0 stops it. The harness accumulates the
+// cycles between the two writes per probe.
+#define SHIM_PROBE		0x3E
+
+#define SHIM_STATUS_IN_READY		(1 << 0)
+#define SHIM_STATUS_OUT_RECEIVED	(1 << 1)
+#define SHIM_STATUS_SETUP_RECEIVED	(1 << 2)
+#define SHIM_STATUS_RW_ALLOWED		(1 << 3)
+#define SHIM_STATUS_CONFIGURED		(1 << 4)
+#define SHIM_STATUS_STALLED			(1 << 5)
+
+#define SHIM_CMD_CLEAR_IN			1
+#define SHIM_CMD_CLEAR_OUT			2
+#define SHIM_CMD_CLEAR_SETUP		3
+#define SHIM_CMD_STALL				4
+#define SHIM_CMD_CLEAR_STALL		5
+#define SHIM_CMD_CONFIGURE			6 // Arguments: address, type, size low, size high, banks; result 1 on success
+#define SHIM_CMD_RESET				7 // Arguments: address
+#define SHIM_CMD_WAIT_READY			8 // Result: ENDPOINT_READYWAIT_* code
+
+#define SHIM_EVENT_NONE				0
+#define SHIM_EVENT_CONNECT			1
+#define SHIM_EVENT_DISCONNECT		2
+#define SHIM_EVENT_CONFIGURED		3
+#define SHIM_EVENT_CONTROL_REQUEST	4
+#define SHIM_EVENT_START_OF_FRAME	5
+
+// Probe numbers of the benchmarks.
+#define SHIM_PROBE_RECEIVE			1
+#define SHIM_PROBE_SEND				2
+#define SHIM_PROBE_STREAM_READ		3
+#define SHIM_PROBE_STREAM_WRITE		4
+#define SHIM_PROBE_BLOCK_READ		5
+#define SHIM_PROBE_BLOCK_WRITE		6
+
+#endif
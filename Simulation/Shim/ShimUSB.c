@@ -0,0 +1,261 @@
+// AVR side of the simulator shim: the parts of the LUFA device driver that are
+// not single register accesses (see LUFA/Drivers/USB/Core/USBController.h).
+// Device events and control requests are delivered by the harness through
+// SHIM_EVENT and dispatched from USB_USBTask, like the polled LUFA build does
+// from the controller flags. The stream functions follow Endpoint_RW.c.
+#include <avr/pgmspace.h>
+#include <LUFA/Drivers/USB/USB.h>
+#include <LUFA/Drivers/Board/LEDs.h>
+
+// Global Variables:
+volatile uint8_t USB_DeviceState;
+USB_Request_Header_t USB_ControlRequest;
+bool USB_Device_RemoteWakeupEnabled;
+uint8_t USB_Device_ConfigurationNumber;
+uint8_t Mock_LEDs;
+
+static bool Shim_SOFEvents;
+static uint16_t Shim_FrameNumber;
+
+// Default event handlers, the firmware overrides the ones it handles.
+ATTR_WEAK void EVENT_USB_Device_Connect(void) {}
+ATTR_WEAK void EVENT_USB_Device_Disconnect(void) {}
+ATTR_WEAK void EVENT_USB_Device_ConfigurationChanged(void) {}
+ATTR_WEAK void EVENT_USB_Device_ControlRequest(void) {}
+ATTR_WEAK void EVENT_USB_Device_StartOfFrame(void) {}
+
+// The firmware runs on its own, there is no test to hand control back to.
+void Mock_Yield(void)
+{
+}
+
+// The harness events are polled from USB_USBTask, the firmware runs without
+// interrupts.
+void GlobalInterruptEnable(void)
+{
+}
+
+void GlobalInterruptDisable(void)
+{
+}
+
+uint_reg_t GetGlobalInterruptMask(void)
+{
+	return 0;
+}
+
+void SetGlobalInterruptMask(const uint_reg_t GlobalIntState)
+{
+}
+
+static uint8_t Shim_Command(const uint8_t Command)
+{
+	SHIM_REG(SHIM_UECMD) = Command;
+	return SHIM_REG(SHIM_UECMD);
+}
+
+void USB_Init(void)
+{
+	USB_DeviceState = DEVICE_STATE_Unattached;
+}
+
+void USB_USBTask(void)
+{
+	uint8_t Event = SHIM_REG(SHIM_EVENT);
+
+	if (Event == SHIM_EVENT_NONE)
+		return;
+
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+
+	switch (Event)
+	{
+		case SHIM_EVENT_CONNECT:
+			USB_DeviceState = DEVICE_STATE_Powered;
+			EVENT_USB_Device_Connect();
+			USB_DeviceState = DEVICE_STATE_Addressed;
+			break;
+		case SHIM_EVENT_DISCONNECT:
+			USB_DeviceState = DEVICE_STATE_Unattached;
+			USB_Device_ConfigurationNumber = 0;
+			EVENT_USB_Device_Disconnect();
+			break;
+		case SHIM_EVENT_CONFIGURED:
+			USB_Device_ConfigurationNumber = 1;
+			USB_DeviceState = DEVICE_STATE_Configured;
+			EVENT_USB_Device_ConfigurationChanged();
+			break;
+		case SHIM_EVENT_CONTROL_REQUEST:
+		{
+			uint8_t* RequestHeader = (uint8_t*)&USB_ControlRequest;
+
+			for (uint8_t i = 0; i < sizeof(USB_Request_Header_t); i++)
+				*(RequestHeader++) = SHIM_REG(SHIM_SETUP);
+
+			Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+			EVENT_USB_Device_ControlRequest();
+			break;
+		}
+		case SHIM_EVENT_START_OF_FRAME:
+			Shim_FrameNumber = (Shim_FrameNumber + 1) & 0x07FF;
+			if (Shim_SOFEvents)
+				EVENT_USB_Device_StartOfFrame();
+			break;
+	}
+
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+
+	// Acknowledge, the harness waits for this before it goes on.
+	SHIM_REG(SHIM_EVENT) = Event;
+}
+
+void USB_Device_EnableSOFEvents(void)
+{
+	Shim_SOFEvents = true;
+}
+
+void USB_Device_DisableSOFEvents(void)
+{
+	Shim_SOFEvents = false;
+}
+
+uint16_t USB_Device_GetFrameNumber(void)
+{
+	return Shim_FrameNumber;
+}
+
+void USB_Device_SendRemoteWakeup(void)
+{
+}
+
+bool Endpoint_ConfigureEndpoint(const uint8_t Address, const uint8_t Type, const uint16_t Size, const uint8_t Banks)
+{
+	SHIM_REG(SHIM_UEARG) = Address;
+	SHIM_REG(SHIM_UEARG) = Type;
+	SHIM_REG(SHIM_UEARG) = (Size & 0xFF);
+	SHIM_REG(SHIM_UEARG) = (Size >> 8);
+	SHIM_REG(SHIM_UEARG) = Banks;
+
+	return Shim_Command(SHIM_CMD_CONFIGURE);
+}
+
+bool Endpoint_ConfigureEndpointTable(const USB_Endpoint_Table_t* const Table, const uint8_t Entries)
+{
+	for (uint8_t i = 0; i < Entries; i++)
+	{
+		if (!(Table[i].Address))
+			continue;
+
+		if (!(Endpoint_ConfigureEndpoint(Table[i].Address, Table[i].Type, Table[i].Size, Table[i].Banks)))
+			return false;
+	}
+
+	return true;
+}
+
+void Endpoint_ResetEndpoint(const uint8_t Address)
+{
+	SHIM_REG(SHIM_UEARG) = Address;
+	Shim_Command(SHIM_CMD_RESET);
+}
+
+// The harness plays the host while the firmware waits, the cycles spent
+// waiting are not part of the measurement.
+uint8_t Endpoint_WaitUntilReady(void)
+{
+	return Shim_Command(SHIM_CMD_WAIT_READY);
+}
+
+uint8_t Endpoint_Write_Stream_LE(const void* const Buffer, uint16_t Length, uint16_t* const BytesProcessed)
+{
+	const uint8_t* Data = (const uint8_t*)Buffer;
+	uint8_t ErrorCode;
+
+	if ((ErrorCode = Endpoint_WaitUntilReady()))
+		return ErrorCode;
+
+	while (Length)
+	{
+		if (!(Endpoint_IsReadWriteAllowed()))
+		{
+			Endpoint_ClearIN();
+
+			if ((ErrorCode = Endpoint_WaitUntilReady()))
+				return ErrorCode;
+		}
+		else
+		{
+			Endpoint_Write_8(*Data++);
+			Length--;
+		}
+	}
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+uint8_t Endpoint_Read_Stream_LE(void* const Buffer, uint16_t Length, uint16_t* const BytesProcessed)
+{
+	uint8_t* Data = (uint8_t*)Buffer;
+	uint8_t ErrorCode;
+
+	if ((ErrorCode = Endpoint_WaitUntilReady()))
+		return ErrorCode;
+
+	while (Length)
+	{
+		if (!(Endpoint_IsReadWriteAllowed()))
+		{
+			Endpoint_ClearOUT();
+
+			if ((ErrorCode = Endpoint_WaitUntilReady()))
+				return ErrorCode;
+		}
+		else
+		{
+			*Data++ = Endpoint_Read_8();
+			Length--;
+		}
+	}
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+uint8_t Endpoint_Write_Control_Stream_LE(const void* const Buffer, uint16_t Length)
+{
+	const uint8_t* Data = (const uint8_t*)Buffer;
+
+	if (Length > USB_ControlRequest.wLength)
+		Length = USB_ControlRequest.wLength;
+
+	while (Length--)
+		Endpoint_Write_8(*Data++);
+
+	return ENDPOINT_RWCSTREAM_NoError;
+}
+
+uint8_t Endpoint_Write_Control_PStream_LE(const void* const Buffer, uint16_t Length)
+{
+	const uint8_t* Data = (const uint8_t*)Buffer;
+
+	if (Length > USB_ControlRequest.wLength)
+		Length = USB_ControlRequest.wLength;
+
+	while (Length--)
+		Endpoint_Write_8(pgm_read_byte(Data++));
+
+	return ENDPOINT_RWCSTREAM_NoError;
+}
+
+uint8_t Endpoint_Read_Control_Stream_LE(void* const Buffer, uint16_t Length)
+{
+	uint8_t* Data = (uint8_t*)Buffer;
+
+	while (Length--)
+		*Data++ = Endpoint_Read_8();
+
+	return ENDPOINT_RWCSTREAM_NoError;
+}
+
+void Endpoint_ClearStatusStage(void)
+{
+}
@@ -0,0 +1,125 @@
+// Echo loop over one of the LufaUtil transfer paths, built for the simulator
+// shim. Every LufaUtil call is bracketed with a probe marker, the harness
+// reports the mean cycles per call of each probe next to the cycles per packet
+// of the whole loop.
+//	BENCH_MODE_BYTE: Device_ReceiveByte/Device_SendByte per byte
+//	BENCH_MODE_STREAM: fread/fwrite on the Device_CreateStream stream
+//	BENCH_MODE_BLOCK: Device_Read_Block/Device_Write_Block per packet
+#include <avr/io.h>
+#include <stdio.h>
+
+#include "LufaUtil.h"
+#include "ShimRegisters.h"
+
+// Macros:
+#define BENCH_MODE_BYTE		0
+#define BENCH_MODE_STREAM	1
+#define BENCH_MODE_BLOCK	2
+
+#ifndef BENCH_MODE
+	#define BENCH_MODE		BENCH_MODE_BLOCK
+#endif
+
+#ifndef BENCH_EP_BANKS
+	#define BENCH_EP_BANKS	2
+#endif
+
+#define BENCH_IN_EPADDR		(ENDPOINT_DIR_IN | 3)
+#define BENCH_OUT_EPADDR	(ENDPOINT_DIR_OUT | 4)
+#define BENCH_EPSIZE		64
+
+// A single OUT instruction on GPIOR0, see SHIM_PROBE.
+#define BENCH_PROBE(Probe)	(GPIOR0 = (Probe))
+
+// Global Variables:
+static USB_EPInfo_Device_t Bench_EPs =
+{
+	.DataINEPAddress = BENCH_IN_EPADDR,
+	.DataOUTEPAddress = BENCH_OUT_EPADDR,
+	.DataEPSize = BENCH_EPSIZE
+};
+
+#if (BENCH_MODE == BENCH_MODE_STREAM)
+static FILE Bench_Stream;
+#endif
+
+// Sends the partly filled IN bank once the OUT packet has been echoed, the
+// byte and stream paths only send a bank when the next byte does not fit.
+static void Bench_FlushIN(void)
+{
+	Endpoint_SelectEndpoint(BENCH_IN_EPADDR);
+	if (Endpoint_BytesInEndpoint())
+		Endpoint_ClearIN();
+}
+
+int main(void)
+{
+	USB_Init();
+
+	#if (BENCH_MODE == BENCH_MODE_STREAM)
+	Device_CreateStream(&Bench_EPs, &Bench_Stream);
+	#endif
+
+	for (;;)
+	{
+		USB_USBTask();
+
+		#if (BENCH_MODE == BENCH_MODE_BYTE)
+		int16_t ReceivedByte;
+		bool Received = false;
+
+		for (;;)
+		{
+			BENCH_PROBE(SHIM_PROBE_RECEIVE);
+			ReceivedByte = Device_ReceiveByte(&Bench_EPs);
+			BENCH_PROBE(0);
+
+			if (ReceivedByte < 0)
+				break;
+
+			BENCH_PROBE(SHIM_PROBE_SEND);
+			Device_SendByte(&Bench_EPs, ReceivedByte);
+			BENCH_PROBE(0);
+			Received = true;
+		}
+
+		if (Received)
+			Bench_FlushIN();
+		#elif (BENCH_MODE == BENCH_MODE_STREAM)
+		uint8_t ReceivedData[BENCH_EPSIZE];
+		size_t Count;
+
+		BENCH_PROBE(SHIM_PROBE_STREAM_READ);
+		Count = fread(ReceivedData, 1, sizeof(ReceivedData), &Bench_Stream);
+		BENCH_PROBE(0);
+
+		if (Count)
+		{
+			BENCH_PROBE(SHIM_PROBE_STREAM_WRITE);
+			fwrite(ReceivedData, 1, Count, &Bench_Stream);
+			BENCH_PROBE(0);
+			Bench_FlushIN();
+		}
+		#else
+		uint8_t ReceivedData[BENCH_EPSIZE];
+		uint16_t Count;
+
+		BENCH_PROBE(SHIM_PROBE_BLOCK_READ);
+		Count = Device_Read_Block(&Bench_EPs, ReceivedData, sizeof(ReceivedData));
+		BENCH_PROBE(0);
+
+		if (Count)
+		{
+			BENCH_PROBE(SHIM_PROBE_BLOCK_WRITE);
+			Device_Write_Block(&Bench_EPs, ReceivedData, Count);
+			BENCH_PROBE(0);
+		}
+		#endif
+	}
+}
+
+void EVENT_USB_Device_ConfigurationChanged(void)
+{
+	Endpoint_ConfigureEndpoint(BENCH_IN_EPADDR, EP_TYPE_BULK, BENCH_EPSIZE, BENCH_EP_BANKS);
+	Endpoint_ConfigureEndpoint(BENCH_OUT_EPADDR, EP_TYPE_BULK, BENCH_EPSIZE, BENCH_EP_BANKS);
+}
@@ -0,0 +1,408 @@
+// simavr cycle benchmark of the echo firmware. Runs an ATmega32U4 build of
+// the firmware against the simulator shim (../Shim), serves the shim
+// registers from the endpoint FIFOs of the host mock and plays a host that
+// keeps the OUT endpoint full and reads every IN packet as soon as it is sent.
+// Reports the AVR cycles per echoed packet and byte, and the mean cycles of
+// every probe the firmware marks (see SHIM_PROBE).
+//	usb_bench [-c] [-n packets] [-s size] firmware.elf
+//	-c: CDC firmware, opens the port with SET_LINE_CODING after configuration
+//	-n: number of OUT packets, 10000 by default
+//	-s: OUT packet size, 64 by default
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+
+#include "MockUSB.h"
+#include "ShimRegisters.h"
+
+// Macros:
+#define BENCH_IN_EPADDR		(ENDPOINT_DIR_IN | 3)
+#define BENCH_OUT_EPADDR	(ENDPOINT_DIR_OUT | 4)
+#define BENCH_F_CPU			16000000
+
+// Cycles the firmware gets to acknowledge an event before the bench gives up.
+#define EVENT_TIMEOUT_CYCLES	(BENCH_F_CPU / 10)
+
+// The host is serviced every few instructions instead of after each one.
+#define HOST_SERVICE_INTERVAL	16
+
+// Type Defines:
+typedef struct
+{
+	uint32_t Calls;
+	avr_cycle_count_t Cycles;
+} Bench_Probe_t;
+
+// Global Variables:
+static avr_t* Bench_AVR;
+static bool Bench_Crashed;
+
+static uint8_t Shim_PendingEvent;
+static uint8_t Shim_SetupIndex;
+static uint8_t Shim_Args[8];
+static uint8_t Shim_ArgCount;
+static uint8_t Shim_CommandResult;
+
+static Bench_Probe_t Bench_Probes[256];
+static uint8_t Bench_ActiveProbe;
+static avr_cycle_count_t Bench_ProbeStart;
+
+static const char* const Bench_ProbeNames[] =
+{
+	[SHIM_PROBE_RECEIVE] = "Device_ReceiveByte",
+	[SHIM_PROBE_SEND] = "Device_SendByte",
+	[SHIM_PROBE_STREAM_READ] = "fread",
+	[SHIM_PROBE_STREAM_WRITE] = "fwrite",
+	[SHIM_PROBE_BLOCK_READ] = "Device_Read_Block",
+	[SHIM_PROBE_BLOCK_WRITE] = "Device_Write_Block",
+};
+
+static uint32_t PacketsToSend;
+static uint16_t PacketSize = 64;
+static uint32_t PacketsSent;
+static uint32_t BytesReceived;
+static uint32_t Mismatches;
+
+// Runs one instruction, false once the core has stopped.
+static bool Bench_Step(void)
+{
+	int State = avr_run(Bench_AVR);
+
+	if ((State == cpu_Done) || (State == cpu_Crashed))
+	{
+		Bench_Crashed = true;
+		return false;
+	}
+
+	return true;
+}
+
+// Hands an event to the firmware and runs it until USB_USBTask has handled it.
+static void Shim_DeliverEvent(const uint8_t Event)
+{
+	avr_cycle_count_t Timeout = Bench_AVR->cycle + EVENT_TIMEOUT_CYCLES;
+
+	Shim_PendingEvent = Event;
+	Shim_SetupIndex = 0;
+
+	while ((Shim_PendingEvent != SHIM_EVENT_NONE) && (Bench_AVR->cycle < Timeout))
+	{
+		if (!(Bench_Step()))
+			break;
+	}
+
+	if (Shim_PendingEvent != SHIM_EVENT_NONE)
+	{
+		fprintf(stderr, "usb_bench: event %u not handled by the firmware\n", Event);
+		Shim_PendingEvent = SHIM_EVENT_NONE;
+	}
+}
+
+// The mock fires the device events here, they are forwarded to the firmware.
+void EVENT_USB_Device_Connect(void)
+{
+	Shim_DeliverEvent(SHIM_EVENT_CONNECT);
+}
+
+void EVENT_USB_Device_Disconnect(void)
+{
+	Shim_DeliverEvent(SHIM_EVENT_DISCONNECT);
+}
+
+void EVENT_USB_Device_ConfigurationChanged(void)
+{
+	Shim_DeliverEvent(SHIM_EVENT_CONFIGURED);
+}
+
+void EVENT_USB_Device_ControlRequest(void)
+{
+	Shim_DeliverEvent(SHIM_EVENT_CONTROL_REQUEST);
+}
+
+// The descriptors stay in the firmware, the bench does not enumerate.
+uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
+									const uint8_t wIndex,
+									const void** const DescriptorAddress)
+{
+	return NO_DESCRIPTOR;
+}
+
+void Mock_Yield(void)
+{
+}
+
+void Mock_EnterInterrupt(void)
+{
+}
+
+void Mock_LeaveInterrupt(void)
+{
+}
+
+static uint8_t Shim_Status(void)
+{
+	uint8_t Status = 0;
+
+	if (Endpoint_IsINReady())
+		Status |= SHIM_STATUS_IN_READY;
+	if (Endpoint_IsOUTReceived())
+		Status |= SHIM_STATUS_OUT_RECEIVED;
+	if (Endpoint_IsSETUPReceived())
+		Status |= SHIM_STATUS_SETUP_RECEIVED;
+	if (Endpoint_IsReadWriteAllowed())
+		Status |= SHIM_STATUS_RW_ALLOWED;
+	if (Endpoint_IsConfigured())
+		Status |= SHIM_STATUS_CONFIGURED;
+	if (Endpoint_IsStalled())
+		Status |= SHIM_STATUS_STALLED;
+
+	return Status;
+}
+
+static void Shim_Command(const uint8_t Command)
+{
+	Shim_CommandResult = 0;
+
+	switch (Command)
+	{
+		case SHIM_CMD_CLEAR_IN:
+			Endpoint_ClearIN();
+			break;
+		case SHIM_CMD_CLEAR_OUT:
+			Endpoint_ClearOUT();
+			break;
+		case SHIM_CMD_CLEAR_SETUP:
+			Endpoint_ClearSETUP();
+			break;
+		case SHIM_CMD_STALL:
+			Endpoint_StallTransaction();
+			break;
+		case SHIM_CMD_CLEAR_STALL:
+			Endpoint_ClearStall();
+			break;
+		case SHIM_CMD_CONFIGURE:
+			Shim_CommandResult = Endpoint_ConfigureEndpoint(Shim_Args[0], Shim_Args[1],
+															(Shim_Args[2] | (Shim_Args[3] << 8)), Shim_Args[4]);
+			break;
+		case SHIM_CMD_RESET:
+			Endpoint_ResetEndpoint(Shim_Args[0]);
+			break;
+		case SHIM_CMD_WAIT_READY:
+			Shim_CommandResult = Endpoint_WaitUntilReady();
+			break;
+	}
+
+	Shim_ArgCount = 0;
+}
+
+static uint8_t Shim_Read(struct avr_t* avr, avr_io_addr_t Address, void* Param)
+{
+	switch (Address)
+	{
+		case SHIM_UENUM:
+			return Endpoint_GetCurrentEndpoint();
+		case SHIM_UEDATX:
+			return Endpoint_Read_8();
+		case SHIM_UEBCX:
+			return Endpoint_BytesInEndpoint();
+		case SHIM_UESTA:
+			return Shim_Status();
+		case SHIM_UECMD:
+			return Shim_CommandResult;
+		case SHIM_EVENT:
+			return Shim_PendingEvent;
+		case SHIM_SETUP:
+			if (Shim_SetupIndex >= sizeof(USB_Request_Header_t))
+				return 0;
+			return ((uint8_t*)&USB_ControlRequest)[Shim_SetupIndex++];
+	}
+
+	return 0;
+}
+
+static void Shim_Write(struct avr_t* avr, avr_io_addr_t Address, uint8_t Value, void* Param)
+{
+	switch (Address)
+	{
+		case SHIM_UENUM:
+			Endpoint_SelectEndpoint(Value);
+			break;
+		case SHIM_UEDATX:
+			Endpoint_Write_8(Value);
+			break;
+		case SHIM_UECMD:
+			Shim_Command(Value);
+			break;
+		case SHIM_UEARG:
+			if (Shim_ArgCount < sizeof(Shim_Args))
+				Shim_Args[Shim_ArgCount++] = Value;
+			break;
+		case SHIM_EVENT:
+			Shim_PendingEvent = SHIM_EVENT_NONE;
+			break;
+	}
+}
+
+static void Bench_ProbeWrite(struct avr_t* avr, avr_io_addr_t Address, uint8_t Value, void* Param)
+{
+	avr->data[Address] = Value;
+
+	if (Value)
+	{
+		Bench_ActiveProbe = Value;
+		Bench_ProbeStart = avr->cycle;
+	}
+	else if (Bench_ActiveProbe)
+	{
+		Bench_Probes[Bench_ActiveProbe].Calls++;
+		Bench_Probes[Bench_ActiveProbe].Cycles += (avr->cycle - Bench_ProbeStart);
+		Bench_ActiveProbe = 0;
+	}
+}
+
+// Reads every IN packet and keeps the OUT banks filled, called from the
+// bench loop and by the mock whenever the firmware waits for the host.
+static void BenchHostHook(void)
+{
+	uint8_t Data[MOCK_MAX_EPSIZE];
+	int16_t Length;
+
+	while ((Length = Mock_HostReadPacket(BENCH_IN_EPADDR, Data, sizeof(Data))) >= 0)
+	{
+		for (int16_t i = 0; i < Length; i++)
+		{
+			if (Data[i] != (uint8_t)(BytesReceived / PacketSize))
+				Mismatches++;
+			BytesReceived++;
+		}
+	}
+
+	while ((PacketsSent < PacketsToSend) && (Mock_PendingPackets(BENCH_OUT_EPADDR) < 2))
+	{
+		memset(Data, (uint8_t)PacketsSent, PacketSize);
+		if (!(Mock_HostSendPacket(BENCH_OUT_EPADDR, Data, PacketSize)))
+			break;
+		PacketsSent++;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bool CDC = false;
+	int Option;
+	elf_firmware_t Firmware = {{0}};
+
+	PacketsToSend = 10000;
+	while ((Option = getopt(argc, argv, "cn:s:")) != -1)
+	{
+		switch (Option)
+		{
+			case 'c':
+				CDC = true;
+				break;
+			case 'n':
+				PacketsToSend = strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				PacketSize = strtoul(optarg, NULL, 0);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-c] [-n packets] [-s size] firmware.elf\n", argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+
+	if ((optind >= argc) || !(PacketSize) || (PacketSize > 64))
+	{
+		fprintf(stderr, "usage: %s [-c] [-n packets] [-s size] firmware.elf\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (elf_read_firmware(argv[optind], &Firmware))
+	{
+		fprintf(stderr, "usb_bench: cannot read %s\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+
+	if (!(Bench_AVR = avr_make_mcu_by_name("atmega32u4")))
+	{
+		fprintf(stderr, "usb_bench: no atmega32u4 core in simavr\n");
+		return EXIT_FAILURE;
+	}
+
+	Firmware.frequency = BENCH_F_CPU;
+	avr_init(Bench_AVR);
+	avr_load_firmware(Bench_AVR, &Firmware);
+
+	for (avr_io_addr_t Address = SHIM_UENUM; Address <= SHIM_SETUP; Address++)
+	{
+		avr_register_io_read(Bench_AVR, Address, Shim_Read, NULL);
+		avr_register_io_write(Bench_AVR, Address, Shim_Write, NULL);
+	}
+	avr_register_io_write(Bench_AVR, SHIM_PROBE, Bench_ProbeWrite, NULL);
+
+	// Let the firmware reach its main loop before the host attaches.
+	Mock_Reset();
+	while (!(Bench_Crashed) && (Bench_AVR->cycle < EVENT_TIMEOUT_CYCLES))
+		Bench_Step();
+
+	Mock_SetHostHook(BenchHostHook);
+	Mock_Configure();
+
+	if (CDC)
+	{
+		uint8_t LineEncoding[7] = {0x00, 0xC2, 0x01, 0x00, 0, 0, 8};
+
+		Mock_HostControl(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE,
+						 CDC_REQ_SetLineEncoding, 0, 0, LineEncoding, sizeof(LineEncoding));
+	}
+
+	memset(Bench_Probes, 0, sizeof(Bench_Probes));
+	Mock_Stats.WaitTimeouts = 0;
+
+	uint32_t BytesToReceive = (PacketsToSend * PacketSize);
+	avr_cycle_count_t Start = Bench_AVR->cycle;
+	avr_cycle_count_t Timeout = Start + ((avr_cycle_count_t)BytesToReceive * 10000);
+
+	BenchHostHook();
+	for (uint32_t Steps = 0; (BytesReceived < BytesToReceive) && (Bench_AVR->cycle < Timeout); Steps++)
+	{
+		if (!(Bench_Step()))
+			break;
+
+		if (!(Steps % HOST_SERVICE_INTERVAL))
+			BenchHostHook();
+	}
+
+	avr_cycle_count_t Cycles = (Bench_AVR->cycle - Start);
+
+	printf("%s: %lu packets of %u bytes\n", argv[optind], (unsigned long)PacketsToSend, PacketSize);
+	printf("  %.1f cycles/packet, %.2f cycles/byte, %.1f us/packet at %u MHz\n",
+		   (double)Cycles / PacketsToSend, (double)Cycles / BytesToReceive,
+		   (double)Cycles / PacketsToSend / (BENCH_F_CPU / 1000000), (BENCH_F_CPU / 1000000));
+	printf("  %lu wait timeouts\n", (unsigned long)Mock_Stats.WaitTimeouts);
+
+	for (uint16_t Probe = 1; Probe < 256; Probe++)
+	{
+		if (!(Bench_Probes[Probe].Calls))
+			continue;
+
+		const char* Name = ((Probe < (sizeof(Bench_ProbeNames) / sizeof(Bench_ProbeNames[0]))) && Bench_ProbeNames[Probe]) ?
+		                   Bench_ProbeNames[Probe] : "probe";
+		printf("  %-20s %3u: %lu calls, %.1f cycles/call\n", Name, Probe, (unsigned long)Bench_Probes[Probe].Calls,
+			   (double)Bench_Probes[Probe].Cycles / Bench_Probes[Probe].Calls);
+	}
+
+	if (Bench_Crashed || (BytesReceived != BytesToReceive) || Mismatches)
+	{
+		fprintf(stderr, "usb_bench: %lu of %lu bytes echoed, %lu mismatches%s\n", (unsigned long)BytesReceived,
+				(unsigned long)BytesToReceive, (unsigned long)Mismatches, Bench_Crashed ? ", core stopped" : "");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -3,9 +3,7 @@
 // device enumeration, tho determine the device's capabilities and functions.
 #include "Descriptors.h"
 #include "global.h"
-#ifdef MY_DEBUG
-#include "rprintf.h"
-#endif
+#include "DescriptorTable.h"
 
 // Device descriptor structure. This descriptor, located in FLASH memory,
 // describes the overall device characters, including the supported USB version,
@@ -160,6 +158,24 @@ const USB_Descriptor_String_t PROGMEM ManufacturerString = USB_STRING_DESCRIPTOR
 // when the appropriate string ID is requested, listed in the Device Descriptor.
 const USB_Descriptor_String_t PROGMEM ProductString = USB_STRING_DESCRIPTOR(L"LUFA CDC Demo");
 
+// Descriptor table searched by CALLBACK_USB_GetDescriptor (DescriptorTable.h),
+// each entry array indexed by the descriptor index of its type.
+static const DescriptorTable_Entry_t PROGMEM DeviceDescriptors[] = {DESCRIPTOR_ENTRY(DeviceDescriptor)};
+static const DescriptorTable_Entry_t PROGMEM ConfigurationDescriptors[] = {DESCRIPTOR_ENTRY(ConfigurationDescriptor)};
+static const DescriptorTable_Entry_t PROGMEM StringDescriptors[] =
+{
+	[STRING_ID_Language] = DESCRIPTOR_STRING_ENTRY(LanguageString),
+	[STRING_ID_Manufacturer] = DESCRIPTOR_STRING_ENTRY(ManufacturerString),
+	[STRING_ID_Product] = DESCRIPTOR_STRING_ENTRY(ProductString),
+};
+
+static const DescriptorTable_Row_t PROGMEM Descriptors[] =
+{
+	DESCRIPTOR_ROW(DTYPE_Device, DESCRIPTOR_ANY_INTERFACE, DeviceDescriptors),
+	DESCRIPTOR_ROW(DTYPE_Configuration, DESCRIPTOR_ANY_INTERFACE, ConfigurationDescriptors),
+	DESCRIPTOR_ROW(DTYPE_String, DESCRIPTOR_ANY_INTERFACE, StringDescriptors),
+};
+
 // This function is called by the library when in device mode, and must be
 // overridden (see library "USB Descriptors" documentation) by the application
 // code so that the address and size of a requested descriptor can be given
@@ -170,44 +186,5 @@ uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
 									const uint8_t wIndex,
 									const void** const DescriptorAddress)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB getdescriptor : 0x%x\n", wValue);
-	#endif
-	const uint8_t DescriptorType = (wValue >> 8);
-	const uint8_t DescriptorNumber = (wValue & 0xFF);
-
-	const void* Address = NULL;
-	uint16_t Size = NO_DESCRIPTOR;
-
-	switch (DescriptorType)
-	{
-		case DTYPE_Device:
-			Address = &DeviceDescriptor;
-			Size = sizeof(USB_Descriptor_Device_t);
-			break;
-		case DTYPE_Configuration:
-			Address = &ConfigurationDescriptor;
-			Size = sizeof(USB_Descriptor_Configuration_t);
-			break;
-		case DTYPE_String:
-			switch (DescriptorNumber)
-			{
-				case STRING_ID_Language:
-					Address = &LanguageString;
-					Size = pgm_read_byte(&LanguageString.Header.Size);
-					break;
-				case STRING_ID_Manufacturer:
-					Address = &ManufacturerString;
-					Size = pgm_read_byte(&ManufacturerString.Header.Size);
-					break;
-				case STRING_ID_Product:
-					Address = &ProductString;
-					Size = pgm_read_byte(&ProductString.Header.Size);
-					break;
-			}
-			break;
-	}
-
-	*DescriptorAddress = Address;
-	return Size;
+	return DESCRIPTOR_TABLE_LOOKUP(Descriptors, wValue, wIndex, DescriptorAddress);
 }
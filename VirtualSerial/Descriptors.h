@@ -19,8 +19,10 @@
 // Size in bytes of the CDC device-to-host notification IN endpoint.
 #define CDC_NOTIFICATION_EPSIZE			8
 
-// Size in bytes of the CDC data IN and OUT endpoints.
-#define CDC_TXRX_EPSIZE					16
+// Size in bytes of the CDC data IN and OUT endpoints, set in CMakeLists.txt.
+#ifndef CDC_TXRX_EPSIZE
+	#define CDC_TXRX_EPSIZE				16
+#endif
 
 // Type Defines:
 // Type define for the device configuration descriptor structure. This must be
@@ -1,12 +1,14 @@
 #include "VirtualSerial.h"
 #include "global.h"
-#ifdef MY_DEBUG
-#include "uart.h"
-#include "rprintf.h"
+
+#if defined(CDC_ZERO_COPY_ECHO) && defined(INTERRUPT_DATA_ENDPOINT)
+	#error CDC_ZERO_COPY_ECHO echoes from the main loop and cannot be used with INTERRUPT_DATA_ENDPOINT
 #endif
 
+#ifndef CDC_ZERO_COPY_ECHO
 // Global buffer for use with STDIO functions
-volatile char buffer[CDC_TXRX_EPSIZE];
+char buffer[CDC_TXRX_EPSIZE];
+#endif
 
 // LUFA CDC Class driver interface configuration and state information. This
 // structure is passed to all CDC Class driver functions, so that multiple
@@ -38,36 +40,152 @@ USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface =
 		},
 };
 
+#ifndef CDC_ZERO_COPY_ECHO
 // Standard file stream for the CDC interface when set up, so that the virtual
 // CDC COM port can be used like any regular character stream in the C APIs
 static FILE USBSerialStream;
 
-int main(void)
+// Ring buffers between the CDC data endpoints and the character stream used by
+// MainTask. The endpoints side is the only producer of the receive ring and
+// the only consumer of the transmit ring, it runs from the main loop or, with
+// INTERRUPT_DATA_ENDPOINT, from the USB endpoint interrupt.
+static SPSCRingBuffer_t SerialRxBuffer;
+static uint8_t SerialRxBufferData[CDC_RX_RING_SIZE];
+static SPSCRingBuffer_t SerialTxBuffer;
+static uint8_t SerialTxBufferData[CDC_TX_RING_SIZE];
+#endif
+
+// Set when the last IN packet was full, so that a zero length packet must follow
+// to terminate the transfer on the host side.
+static bool SerialZLPPending;
+
+#ifdef INTERRUPT_DATA_ENDPOINT
+// Runs Serial_USBTask, then arms the interrupts of what is left
+// (EndpointInterrupt.h): RXOUTE unless a packet waits for room in the receive
+// ring, TXINE while the transmit ring or a zero length packet waits for the
+// IN bank. Runs from the endpoint interrupt, and from the main loop with the
+// interrupts disabled.
+static void Serial_ServiceEndpoints(void)
+{
+	Serial_USBTask();
+
+	Endpoint_SelectEndpoint(CDC_RX_EPADDR);
+	if (Endpoint_IsOUTReceived())
+		UEIENX &= ~(1 << RXOUTE);
+	else
+		UEIENX |= (1 << RXOUTE);
+
+	Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+	if (SPSCRingBuffer_GetCount(&SerialTxBuffer) || SerialZLPPending)
+		UEIENX |= (1 << TXINE);
+	else
+		UEIENX &= ~(1 << TXINE);
+}
+
+// Serial_ServiceEndpoints for the main loop. The interrupts only fire for a
+// new packet or a bank the host took, this sends what MainTask wrote and takes
+// the packet the receive ring had no room for.
+static void Serial_KickEndpoints(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+	Serial_ServiceEndpoints();
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+#endif
+
+// Idle check of the main loop, run by PowerSave_IdleTask with the interrupts
+// disabled: true if the next pass has data to move. Otherwise arms the
+// interrupts of the endpoints the data path waits on.
+static bool Serial_IsWorkPending(void)
 {
-	#ifdef MY_DEBUG
-	uartInit();
-	uartSetBaudRate(9600);
-	rprintfInit(uartSendByte);
-	rprintf("test start....\n");
+	// Nothing is echoed before the line encoding, which comes with a SETUP.
+	if (!(VirtualSerial_CDC_Interface.State.LineEncoding.BaudRateBPS))
+		return false;
+
+	#ifdef CDC_ZERO_COPY_ECHO
+	// A received packet waits in its bank for a free IN bank.
+	Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+	bool INReady = Endpoint_IsINReady();
+	Endpoint_SelectEndpoint(CDC_RX_EPADDR);
+	bool OUTReceived = Endpoint_IsOUTReceived();
+
+	if (INReady && (OUTReceived || SerialZLPPending))
+		return true;
+
+	PowerSave_WakeOnEndpoint(INReady ? CDC_RX_EPADDR : CDC_TX_EPADDR);
+	return false;
+	#else
+	if (!(SPSCRingBuffer_IsEmpty(&SerialRxBuffer)))
+		return true;
+
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	// The endpoint interrupt moves the packets and ends the sleep.
+	return false;
+	#else
+	// The receive ring is empty, a received packet always fits.
+	Endpoint_SelectEndpoint(CDC_RX_EPADDR);
+	if (Endpoint_IsOUTReceived())
+		return true;
+
+	PowerSave_WakeOnEndpoint(CDC_RX_EPADDR);
+
+	if (SPSCRingBuffer_GetCount(&SerialTxBuffer) || SerialZLPPending)
+	{
+		Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+		if (Endpoint_IsINReady())
+			return true;
+
+		PowerSave_WakeOnEndpoint(CDC_TX_EPADDR);
+	}
+
+	return false;
+	#endif
 	#endif
+}
+
+int main(void)
+{
+	EventLog_Init();
+	LOG_INFO(USB, Start, MCUSR, 0);
 
 	SetupHardware();
 
-	// Create a regular character stream for the interface so that it can be used with stdio.h functions.
-	CDC_Device_CreateStream(&VirtualSerial_CDC_Interface, &USBSerialStream);
+	#ifndef CDC_ZERO_COPY_ECHO
+	SPSCRingBuffer_InitBuffer(&SerialRxBuffer, SerialRxBufferData, sizeof(SerialRxBufferData));
+	SPSCRingBuffer_InitBuffer(&SerialTxBuffer, SerialTxBufferData, sizeof(SerialTxBufferData));
+
+	// Create a character stream over the ring buffers so that it can be used
+	// with stdio.h functions, the endpoints are only accessed by Serial_USBTask.
+	USBSerialStream = (FILE)FDEV_SETUP_STREAM(Serial_putchar, Serial_getchar, _FDEV_SETUP_RW);
+	#endif
 
 	GlobalInterruptEnable();
 
+	LOG_INFO(USB, LoopStart, 0, 0);
 	for (;;)
 	{
+		PERF_COUNT(MainLoopPasses);
+		PowerSave_Task(false);
 		MainTask();
 
-		// Must throw away unused bytes from the host, or it will lock up while
-		// waiting for the device
-		//CDC_Device_ReceiveByte(&VirtualSerial_CDC_Interface);
-
-		CDC_Device_USBTask(&VirtualSerial_CDC_Interface);
+		#ifdef INTERRUPT_DATA_ENDPOINT
+		if (USB_DeviceState == DEVICE_STATE_Configured)
+			Serial_KickEndpoints();
+		#else
+		#ifndef CDC_ZERO_COPY_ECHO
+		// Unused bytes from the host are absorbed by the receive ring, the host
+		// is only NAKed once the ring is full.
+		Serial_USBTask();
+		#endif
 		USB_USBTask();
+		#endif
+
+		PowerSave_IdleTask(Serial_IsWorkPending);
 	}
 }
 
@@ -84,68 +202,223 @@ void SetupHardware(void)
 	// Hardware Initialization
 	LEDs_Init();
 	LEDs_TurnOnLEDs(LEDS_LED1);
-	#ifdef MY_DEBUG
-	rprintf("before USB_Init...\n");
-	#endif
+	CycleProbe_Init();
 	USB_Init();
-	#ifdef MY_DEBUG
-	rprintf("before USB_Init...\n");
-	#endif
+	LOG_INFO(USB, USBInit, 0, 0);
 }
 
 // Event handler for the library USB Connection event.
 void EVENT_USB_Device_Connect(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB connect...\n");
-	#endif
+	LOG_INFO(USB, Connect, 0, 0);
 	LEDs_SetAllLEDs(LEDMASK_USB_ENUMERATING);
 }
 
 // Event handler for the library USB Disconnect event.
 void EVENT_USB_Device_Disconnect(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB disconnect...\n");
-	#endif
+	LOG_INFO(USB, Disconnect, 0, 0);
 	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
 }
 
+// Event handler for the library USB Suspend event.
+void EVENT_USB_Device_Suspend(void)
+{
+	PowerSave_Suspend();
+}
+
+// Event handler for the library USB Wake Up event.
+void EVENT_USB_Device_WakeUp(void)
+{
+	PowerSave_WakeUp();
+}
+
 // Event handler for the library USB Configuration Changed event.
 void EVENT_USB_Device_ConfigurationChanged(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB configuration...\n");
-	#endif
 	bool ConfigSuccess = true;
 
 	ConfigSuccess &= CDC_Device_ConfigureEndpoints(&VirtualSerial_CDC_Interface);
 
+	#ifdef INTERRUPT_DATA_ENDPOINT
+	Serial_KickEndpoints();
+	#endif
+
+	LOG_INFO(USB, ConfigurationChanged, ConfigSuccess, 0);
 	LEDs_SetAllLEDs(ConfigSuccess ? LEDMASK_USB_READY : LEDMASK_USB_ERROR);
 }
 
 // Event handler for the library USB Control Request reception event
 void EVENT_USB_Device_ControlRequest(void)
 {
-	#ifdef MY_DEBUG
-	rprintf("USB control request...0x%x\n", USB_ControlRequest.bRequest);
-	#endif
+	LOG_DEBUG(USB, ControlRequest, USB_ControlRequest.bRequest, USB_ControlRequest.bmRequestType);
+	PerfCounters_ProcessControlRequest();
+	CycleProbe_ProcessControlRequest();
 	CDC_Device_ProcessControlRequest(&VirtualSerial_CDC_Interface);
 }
 
+#ifdef CDC_ZERO_COPY_ECHO
+// Echoes each received packet straight from the OUT endpoint bank into the IN
+// endpoint bank. No SRAM buffer and no stdio stream is involved, every byte is
+// only held in a register while the endpoints are switched, so throughput
+// approaches one CDC_TXRX_EPSIZE packet per frame.
+void MainTask(void)
+{
+	CYCLE_PROBE(CYCLE_PROBE_MainTask);
+
+	if ((USB_DeviceState != DEVICE_STATE_Configured) ||
+		!(VirtualSerial_CDC_Interface.State.LineEncoding.BaudRateBPS))
+		return;
+
+	// Leave the packet in the OUT bank (and the host NAKed) until there is a
+	// free IN bank to echo it into.
+	Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+	if (!(Endpoint_IsINReady()))
+		return;
+
+	Endpoint_SelectEndpoint(CDC_RX_EPADDR);
+	if (!(Endpoint_IsOUTReceived()))
+	{
+		// Terminate a transfer that ended with a full packet once the host
+		// has nothing more to send.
+		if (SerialZLPPending)
+		{
+			Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+			PERF_COUNT(INPackets);
+			CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+			Endpoint_ClearIN();
+			SerialZLPPending = false;
+		}
+		return;
+	}
+
+	uint8_t Count = Endpoint_BytesInEndpoint();
+	SerialZLPPending = (Count == CDC_TXRX_EPSIZE);
+
+	PERF_COUNT(OUTPackets);
+	PERF_ADD(OUTBytes, Count);
+	PERF_COUNT(INPackets);
+	CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+	PERF_ADD(INBytes, Count);
+
+	while (Count--)
+	{
+		uint8_t Data = Endpoint_Read_8();
+		Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+		Endpoint_Write_8(Data);
+		Endpoint_SelectEndpoint(CDC_RX_EPADDR);
+	}
+
+	Endpoint_ClearOUT();
+	Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+	Endpoint_ClearIN();
+}
+#else
 void MainTask(void)
 {
+	CYCLE_PROBE(CYCLE_PROBE_MainTask);
+
 	int count = 0;
 
 	// If the host has sent data then echo it back
 	// Throughput is maxmized if the full EP buffer is read and sent each time
 	// Throughput approaches CDC_TXRX_EPSIZE kbytes/second and depends on transfer size from host
 	if ((count = fread(&buffer, 1, CDC_TXRX_EPSIZE, &USBSerialStream)) > 0) {
-		#ifdef MY_DEBUG
-		for(uint8_t i=0; i<count; i++)
-			rprintfChar(buffer[i]);
-		rprintfCRLF();
-		#endif
+		LOG_DEBUG(DATA, EchoPacket, count, buffer[0]);
 		fwrite(&buffer, 1, count, &USBSerialStream);
 	}
 }
+#endif
+
+#ifdef INTERRUPT_DATA_ENDPOINT
+// Event handler for the library USB Reset event. The bus reset disarmed the
+// endpoint interrupts, the control requests are handled from it again.
+void EVENT_USB_Device_Reset(void)
+{
+	EndpointInterrupt_Reset();
+}
+
+// Event handler of the USB endpoint interrupt (EndpointInterrupt.h).
+void EVENT_EndpointInterrupt_Data(void)
+{
+	Serial_ServiceEndpoints();
+}
+#endif
+
+#ifndef CDC_ZERO_COPY_ECHO
+// Moves received bytes into the receive ring and the transmit ring into an IN
+// packet when a bank is free. Never waits for the host, so that it can run from
+// the USB endpoint interrupt.
+void Serial_USBTask(void)
+{
+	int16_t ReceivedByte;
+	while (!SPSCRingBuffer_IsFull(&SerialRxBuffer) &&
+		   ((ReceivedByte = CDC_Device_ReceiveByte(&VirtualSerial_CDC_Interface)) >= 0))
+	{
+		SPSCRingBuffer_Insert(&SerialRxBuffer, ReceivedByte);
+		PERF_COUNT(OUTBytes);
+	}
+
+	// Write at most one packet per call and only into a free bank, so that
+	// CDC_Device_SendByte never has to wait for the host.
+	Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+	if (Endpoint_IsINReady())
+	{
+		uint8_t Count = SPSCRingBuffer_GetCount(&SerialTxBuffer);
+		if (Count > CDC_TXRX_EPSIZE)
+			Count = CDC_TXRX_EPSIZE;
+
+		if (Count || SerialZLPPending)
+		{
+			uint8_t Sent = 0;
+			while ((Sent < Count) &&
+				   (CDC_Device_SendByte(&VirtualSerial_CDC_Interface, SPSCRingBuffer_Peek(&SerialTxBuffer)) == ENDPOINT_READYWAIT_NoError))
+			{
+				SPSCRingBuffer_Remove(&SerialTxBuffer);
+				Sent++;
+			}
+
+			if (Sent == Count)
+			{
+				SerialZLPPending = (Sent == CDC_TXRX_EPSIZE);
+				PERF_COUNT(INPackets);
+				CycleProbe_EndSpan(CYCLE_PROBE_ResumeToFirstPacket);
+				PERF_ADD(INBytes, Sent);
+				Endpoint_ClearIN();
+			}
+		}
+	}
+}
+
+// Character stream output function over the transmit ring. Waits for
+// Serial_USBTask to make room if the ring is full, and keeps answering control
+// requests meanwhile in the polled build. In the interrupt driven build the
+// wait arms the endpoint interrupt, which drains the ring.
+int Serial_putchar(char c, FILE* Stream)
+{
+	while (SPSCRingBuffer_IsFull(&SerialTxBuffer))
+	{
+		if (USB_DeviceState != DEVICE_STATE_Configured)
+			return _FDEV_ERR;
+
+		#ifdef INTERRUPT_DATA_ENDPOINT
+		Serial_KickEndpoints();
+		#else
+		Serial_USBTask();
+		USB_USBTask();
+		#endif
+	}
+
+	SPSCRingBuffer_Insert(&SerialTxBuffer, c);
+	return 0;
+}
+
+// Character stream input function over the receive ring.
+int Serial_getchar(FILE* Stream)
+{
+	if (SPSCRingBuffer_IsEmpty(&SerialRxBuffer))
+		return _FDEV_EOF;
+
+	return SPSCRingBuffer_Remove(&SerialRxBuffer);
+}
+#endif
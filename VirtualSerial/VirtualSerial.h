@@ -10,6 +10,12 @@
 #include <stdio.h>
 
 #include "Descriptors.h"
+#include "SPSCRingBuffer.h"
+#include "PerfCounters.h"
+#include "PowerSave.h"
+#include "CycleProbe.h"
+#include "EventLog.h"
+#include "EndpointInterrupt.h"
 
 #include <LUFA/Drivers/USB/USB.h>
 #include <LUFA/Drivers/Board/LEDs.h>
@@ -27,13 +33,36 @@
 // LED mask for the library LED driver, to indicate the an error has occurred in the USB interface.
 #define LEDMASK_USB_ERROR			(LEDS_LED1 | LEDS_LED3)
 
+// Sizes in bytes of the receive and transmit rings between the CDC data
+// endpoints and MainTask, set in CMakeLists.txt. Both rings live in SRAM next
+// to the stack, so together they are kept within CDC_RING_SRAM_BUDGET of the
+// 2.5 KB of the ATmega32U4.
+#ifndef CDC_RX_RING_SIZE
+	#define CDC_RX_RING_SIZE		128
+#endif
+#ifndef CDC_TX_RING_SIZE
+	#define CDC_TX_RING_SIZE		64
+#endif
+#define CDC_RING_SRAM_BUDGET		512
+
+_Static_assert(SPSC_RING_BUFFER_SIZE_VALID(CDC_RX_RING_SIZE), "CDC_RX_RING_SIZE must be a power of two up to 128");
+_Static_assert(SPSC_RING_BUFFER_SIZE_VALID(CDC_TX_RING_SIZE), "CDC_TX_RING_SIZE must be a power of two up to 128");
+_Static_assert((CDC_RX_RING_SIZE + CDC_TX_RING_SIZE) <= CDC_RING_SRAM_BUDGET, "CDC rings exceed their SRAM budget");
+
 // Function Prototypes:
 void SetupHardware(void);
 void MainTask(void);
 
 void EVENT_USB_Device_Connect(void);
 void EVENT_USB_Device_Disconnect(void);
+void EVENT_USB_Device_Suspend(void);
+void EVENT_USB_Device_WakeUp(void);
 void EVENT_USE_Device_ConfigurationChanged(void);
 void EVENT_USB_Device_ControlRequest(void);
+void EVENT_USB_Device_Reset(void);
+
+void Serial_USBTask(void);
+int Serial_putchar(char c, FILE* Stream);
+int Serial_getchar(FILE* Stream);
 
 #endif